@@ -0,0 +1,555 @@
+#include "SDL3/SDL.h"
+#include "Simulation.hpp"
+#include "SpatialIndex.hpp"
+#include "SweepAndPrune.hpp"
+#include "ThreadPool.hpp"
+#include "RenderSnapshot.hpp"
+#include "WorldSnapshot.hpp"
+#include "NeuralNet.hpp"
+#include "NeuralBatch.hpp"
+#include "Genome.hpp"
+#include "SimRandom.hpp"
+#include "SimUtils.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions {
+    std::vector<uint32_t> sizes = {1000, 10000, 100000};
+    uint64_t simTicks = 10;
+    uint64_t warmupTicks = 3;
+    double minSeconds = 0.5;
+    std::string format = "json";
+    std::string outPath;
+    std::string filter;
+    uint64_t seed = 42;
+    SpatialIndexType spatialIndexType = SpatialIndexType::QUADTREE;
+    size_t workerCount = ThreadPool::getDefaultWorkerCount();
+};
+
+struct BenchmarkResult {
+    std::string name;
+    uint64_t size;
+    uint64_t iterations;
+    uint64_t itemsPerIteration;
+    double seconds;
+
+    [[nodiscard]] double nsPerIteration() const {
+        return iterations > 0 ? (seconds * 1e9) / static_cast<double>(iterations) : 0.0;
+    }
+    [[nodiscard]] double itemsPerSecond() const {
+        return seconds > 0.0 ? static_cast<double>(iterations * itemsPerIteration) / seconds : 0.0;
+    }
+};
+
+//written to by every benchmark body so the compiler can't drop the work being measured
+static volatile uint64_t benchmarkSink = 0;
+
+static constexpr uint16_t genomeSize = 50;
+static constexpr uint16_t genomePoolSize = 256;
+static constexpr float objectWidth = 8.0f;
+static constexpr float objectHeight = 8.0f;
+
+static void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl <<
+        "  --sizes N,N,...      object/organism counts to run the sized benchmarks at (default 1000,10000,100000)" << std::endl <<
+        "  --sim-ticks N        measured Simulation ticks per size (default 10)" << std::endl <<
+        "  --warmup-ticks N     unmeasured Simulation ticks run first (default 3)" << std::endl <<
+        "  --min-time SECONDS   minimum measured time for each micro benchmark (default 0.5)" << std::endl <<
+        "  --format json|csv    result format (default json)" << std::endl <<
+        "  --out PATH           write results to PATH instead of stdout" << std::endl <<
+        "  --filter TEXT        only run benchmarks whose name contains TEXT" << std::endl <<
+        "  --seed N             seed for the generated objects, genomes and simulations (default 42)" << std::endl <<
+        "  --spatial-index NAME quadtree, grid or linear, the backend the Simulation benchmarks run on (default quadtree)" << std::endl <<
+        "  --threads N          worker threads of the parallel benchmarks and the Simulations (default one less than the cpu's threads, at least 1)" << std::endl;
+}
+
+static bool parseSizes(const char* value, std::vector<uint32_t>* sizesPtr) {
+    sizesPtr->clear();
+    std::stringstream stream(value);
+    std::string size;
+    while(std::getline(stream, size, ',')) {
+        const unsigned long parsed = std::strtoul(size.c_str(), nullptr, 10);
+        if(parsed == 0) return false;
+        sizesPtr->push_back(static_cast<uint32_t>(parsed));
+    }
+    return !sizesPtr->empty();
+}
+
+static bool parseOptions(const int argc, char* argv[], BenchmarkOptions* optionsPtr) {
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if(strcmp(arg, "--sizes") == 0) {
+            if(!parseSizes(value, &optionsPtr->sizes)) {
+                std::cerr << "Invalid size list " << value << std::endl;
+                return false;
+            }
+        }
+        else if(strcmp(arg, "--sim-ticks") == 0) optionsPtr->simTicks = std::strtoull(value, nullptr, 10);
+        else if(strcmp(arg, "--warmup-ticks") == 0) optionsPtr->warmupTicks = std::strtoull(value, nullptr, 10);
+        else if(strcmp(arg, "--min-time") == 0) optionsPtr->minSeconds = std::strtod(value, nullptr);
+        else if(strcmp(arg, "--format") == 0) optionsPtr->format = value;
+        else if(strcmp(arg, "--out") == 0) optionsPtr->outPath = value;
+        else if(strcmp(arg, "--filter") == 0) optionsPtr->filter = value;
+        else if(strcmp(arg, "--seed") == 0) optionsPtr->seed = std::strtoull(value, nullptr, 10);
+        else if(strcmp(arg, "--spatial-index") == 0) {
+            optionsPtr->spatialIndexType = SpatialIndex::parseType(value);
+            if(optionsPtr->spatialIndexType == SpatialIndexType::SIZE) {
+                std::cerr << "Unknown spatial index " << value << std::endl;
+                return false;
+            }
+        }
+        else if(strcmp(arg, "--threads") == 0) optionsPtr->workerCount = std::strtoull(value, nullptr, 10);
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if(optionsPtr->format != "json" && optionsPtr->format != "csv") {
+        std::cerr << "Unknown format " << optionsPtr->format << std::endl;
+        return false;
+    }
+    if(optionsPtr->simTicks == 0 || optionsPtr->minSeconds < 0.0) {
+        std::cerr << "Invalid option value" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Keeps the object density of the default 1080x720 window with 1000 organisms at every size.
+ */
+static SDL_Rect getScaledBounds(const uint32_t size) {
+    const float scale = std::sqrt(static_cast<float>(size) / 1000.0f);
+    return SDL_Rect{0, 0, static_cast<int>(1080.0f * scale), static_cast<int>(720.0f * scale)};
+}
+
+static std::vector<SpatialIndex::Object> createObjects(const uint32_t size, const SDL_Rect& bounds, SimRandom::Stream& rng) {
+    std::uniform_real_distribution<float> distX(static_cast<float>(bounds.x), static_cast<float>(bounds.x + bounds.w) - objectWidth);
+    std::uniform_real_distribution<float> distY(static_cast<float>(bounds.y), static_cast<float>(bounds.y + bounds.h) - objectHeight);
+
+    std::vector<SpatialIndex::Object> objects;
+    objects.reserve(size);
+    for(uint32_t i = 0; i < size; i++) {
+        objects.emplace_back(i, EntityKind::ORGANISM, SDL_FRect{distX(rng), distY(rng), objectWidth, objectHeight}, true);
+    }
+    return objects;
+}
+
+static std::vector<Genome::Genome> createGenomes(SimRandom::Stream& rng) {
+    std::vector<Genome::Genome> genomes;
+    genomes.reserve(genomePoolSize);
+    for(int i = 0; i < genomePoolSize; i++) {
+        genomes.push_back(Genome::createRandomGenome(genomeSize, rng));
+    }
+    return genomes;
+}
+
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(const BenchmarkOptions& options) : options(options) {}
+
+    [[nodiscard]] bool shouldRun(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    /**
+     * Runs setup then body until at least the minimum time has been spent in body, only body is measured.
+     * @param itemsPerIteration how many objects/genomes/nets one call of body processes, used for items_per_second.
+     */
+    template<typename Setup, typename Body>
+    void run(const std::string& name, const uint64_t size, const uint64_t itemsPerIteration, Setup&& setup, Body&& body) {
+        if(!shouldRun(name)) return;
+
+        BenchmarkResult result{name, size, 0, itemsPerIteration, 0.0};
+        do {
+            setup();
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            result.seconds += elapsed.count();
+            result.iterations++;
+        }while(result.seconds < options.minSeconds);
+        add(result);
+    }
+
+    void add(const BenchmarkResult& result) {
+        std::cerr << std::left << std::setw(40) << result.name <<
+            " size " << std::setw(7) << result.size <<
+            " iterations " << std::setw(8) << result.iterations <<
+            std::fixed << std::setprecision(1) <<
+            " ns/iter " << std::setw(14) << result.nsPerIteration() <<
+            " items/s " << result.itemsPerSecond() << std::endl;
+        results.push_back(result);
+    }
+
+    void write(std::ostream& out) const {
+        if(options.format == "csv") {
+            out << "name,size,iterations,items_per_iteration,seconds,ns_per_iteration,items_per_second" << std::endl;
+            for(const auto& result : results) {
+                out << result.name << ',' << result.size << ',' << result.iterations << ',' << result.itemsPerIteration << ',' <<
+                    std::setprecision(9) << result.seconds << ',' << result.nsPerIteration() << ',' << result.itemsPerSecond() << std::endl;
+            }
+            return;
+        }
+
+        out << "{" << std::endl << "  \"seed\": " << options.seed << "," << std::endl << "  \"benchmarks\": [" << std::endl;
+        for(size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& result = results[i];
+            out << "    {\"name\": \"" << result.name << "\", \"size\": " << result.size <<
+                ", \"iterations\": " << result.iterations << ", \"items_per_iteration\": " << result.itemsPerIteration <<
+                std::setprecision(9) << ", \"seconds\": " << result.seconds << ", \"ns_per_iteration\": " << result.nsPerIteration() <<
+                ", \"items_per_second\": " << result.itemsPerSecond() << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+        }
+        out << "  ]" << std::endl << "}" << std::endl;
+    }
+
+private:
+    const BenchmarkOptions& options;
+    std::vector<BenchmarkResult> results;
+};
+
+/**
+ * Runs the same lookups on every spatial index backend, each backend's results are prefixed with its class name.
+ */
+static void benchmarkSpatialIndex(BenchmarkRunner& runner, const SpatialIndexType type, const uint32_t size, const uint64_t seed,
+    ThreadPool* threadPoolPtr) {
+    const std::string prefix = type == SpatialIndexType::GRID ? "UniformGrid/" :
+        type == SpatialIndexType::LINEAR_QUADTREE ? "LinearQuadTree/" : "QuadTree/";
+    SimRandom::Stream rng = SimRandom::Stream(seed).split(size);
+    const SDL_Rect bounds = getScaledBounds(size);
+    const SDL_FRect boundsF = SimUtils::rectToFRect(bounds);
+    const std::vector<SpatialIndex::Object> objects = createObjects(size, bounds, rng);
+
+    std::vector<Vec2> velocities;
+    velocities.reserve(size);
+    std::uniform_real_distribution<float> distVelocity(-1.0f, 1.0f);
+    for(uint32_t i = 0; i < size; i++) velocities.emplace_back(distVelocity(rng), distVelocity(rng));
+
+    const std::unique_ptr<SpatialIndex> filledIndexPtr = SpatialIndex::create(type, boundsF);
+    for(const auto& object : objects) filledIndexPtr->insert(object);
+    filledIndexPtr->compact();
+    const SpatialIndex& filledIndex = *filledIndexPtr;
+    std::unique_ptr<SpatialIndex> indexPtr;
+
+    runner.run(prefix + "insert", size, size,
+        [&] {indexPtr = SpatialIndex::create(type, boundsF);},
+        [&] {
+            for(const auto& object : objects) indexPtr->insert(object);
+            benchmarkSink = benchmarkSink + indexPtr->size();
+        });
+    runner.run(prefix + "remove", size, size,
+        [&] {indexPtr = filledIndex.clone();},
+        [&] {
+            for(const auto& object : objects) indexPtr->remove(object);
+            benchmarkSink = benchmarkSink + indexPtr->size();
+        });
+    //every object takes one step along its velocity, like organisms between two fixed updates
+    std::vector<SpatialIndex::Object> movedObjects = objects;
+    for(uint32_t i = 0; i < size; i++) {
+        movedObjects[i].boundingBox.x += velocities[i].x;
+        movedObjects[i].boundingBox.y += velocities[i].y;
+    }
+    runner.run(prefix + "move", size, size,
+        [&] {indexPtr = filledIndex.clone();},
+        [&] {
+            for(uint32_t i = 0; i < size; i++) indexPtr->move(movedObjects[i], objects[i].boundingBox);
+            benchmarkSink = benchmarkSink + indexPtr->size();
+        });
+    runner.run(prefix + "copy", size, size,
+        [] {},
+        [&] {
+            indexPtr = filledIndex.clone();
+            benchmarkSink = benchmarkSink + indexPtr->size();
+        });
+    //the grid never restructures, only the quadtree has nodes to collapse
+    if(type == SpatialIndexType::QUADTREE) {
+        runner.run(prefix + "undivide", size, size,
+            [&] {
+                //removing most objects leaves subdivided nodes behind for undivide to collapse, like organisms dying off
+                indexPtr = filledIndex.clone();
+                for(uint32_t i = 0; i < size; i++) {
+                    if(i % 10 != 0) indexPtr->remove(objects[i]);
+                }
+            },
+            [&] {
+                indexPtr->compact();
+                benchmarkSink = benchmarkSink + indexPtr->size();
+            });
+        //a regular fixed step, only the nodes the moves took objects out of are looked at
+        runner.run(prefix + "undivideAfterMove", size, size,
+            [&] {
+                indexPtr = filledIndex.clone();
+                for(uint32_t i = 0; i < size; i++) indexPtr->move(movedObjects[i], objects[i].boundingBox);
+            },
+            [&] {
+                indexPtr->compact();
+                benchmarkSink = benchmarkSink + indexPtr->size();
+            });
+    }
+    //the linear quadtree sorts everything again after every step
+    if(type == SpatialIndexType::LINEAR_QUADTREE) {
+        runner.run(prefix + "rebuild", size, size,
+            [&] {
+                indexPtr = filledIndex.clone();
+                for(uint32_t i = 0; i < size; i++) indexPtr->move(movedObjects[i], objects[i].boundingBox);
+            },
+            [&] {
+                indexPtr->compact();
+                benchmarkSink = benchmarkSink + indexPtr->size();
+            });
+        runner.run(prefix + "rebuild/parallel", size, size,
+            [&] {
+                indexPtr = filledIndex.clone();
+                for(uint32_t i = 0; i < size; i++) indexPtr->move(movedObjects[i], objects[i].boundingBox);
+            },
+            [&] {
+                indexPtr->compact(threadPoolPtr);
+                benchmarkSink = benchmarkSink + indexPtr->size();
+            });
+    }
+    //into one vector kept between lookups, like the simulation's pass over the static objects
+    std::vector<uint64_t> overlapScratch;
+    runner.run(prefix + "query", size, size,
+        [] {},
+        [&] {
+            for(const auto& object : objects) {
+                filledIndex.findOverlapping(object, &overlapScratch);
+                benchmarkSink = benchmarkSink + overlapScratch.size();
+            }
+        });
+    runner.run(prefix + "getIntersections", size, size,
+        [] {},
+        [&] {benchmarkSink = benchmarkSink + filledIndex.getIntersections().size();});
+    runner.run(prefix + "getNearestNeighbors", size, size,
+        [] {},
+        [&] {
+            for(const auto& object : objects) benchmarkSink = benchmarkSink + filledIndex.getNearestNeighbors(object).size();
+        });
+    runner.run(prefix + "raycast", size, size,
+        [] {},
+        [&] {
+            for(uint32_t i = 0; i < size; i++) benchmarkSink = benchmarkSink + filledIndex.raycast(objects[i], velocities[i]).size();
+        });
+    //the neighbor task's pass, both lookups for every object into buffers kept between iterations
+    NeighborResults results;
+    results.resize(size);
+    std::vector<uint64_t> orderScratch;
+    runner.run(prefix + "findAllNeighbors", size, size,
+        [] {},
+        [&] {
+            filledIndex.findAllNeighbors(objects, velocities, results.getRows(), &orderScratch);
+            benchmarkSink = benchmarkSink + results.neighborCounts[0] + results.raycastCounts[0];
+        });
+    runner.run(prefix + "findAllNeighbors/parallel", size, size,
+        [] {},
+        [&] {
+            filledIndex.findAllNeighbors(objects, velocities, results.getRows(), &orderScratch, nullptr, threadPoolPtr);
+            benchmarkSink = benchmarkSink + results.neighborCounts[0] + results.raycastCounts[0];
+        });
+}
+
+/**
+ * Times the collision broadphase on the objects of the spatial index benchmarks, every tick moves all objects one step
+ * and finds the intersecting pairs, so the cost of keeping the intervals sorted is measured with the sweep.
+ */
+static void benchmarkSweepAndPrune(BenchmarkRunner& runner, const uint32_t size, const uint64_t seed) {
+    SimRandom::Stream rng = SimRandom::Stream(seed).split(size);
+    const SDL_Rect bounds = getScaledBounds(size);
+    const SDL_FRect boundsF = SimUtils::rectToFRect(bounds);
+    std::vector<SpatialIndex::Object> objects = createObjects(size, bounds, rng);
+
+    std::vector<Vec2> velocities;
+    velocities.reserve(size);
+    std::uniform_real_distribution<float> distVelocity(-1.0f, 1.0f);
+    for(uint32_t i = 0; i < size; i++) velocities.emplace_back(distVelocity(rng), distVelocity(rng));
+
+    SweepAndPrune broadphase(boundsF);
+    for(const auto& object : objects) broadphase.insert(object);
+    benchmarkSink = benchmarkSink + broadphase.getIntersections().size();
+
+    runner.run("SweepAndPrune/getIntersections", size, size,
+        [] {},
+        [&] {benchmarkSink = benchmarkSink + broadphase.getIntersections().size();});
+    float direction = 1.0f;
+    runner.run("SweepAndPrune/move+getIntersections", size, size,
+        [] {},
+        [&] {
+            //objects walk back and forth so they stay inside the bounds however many iterations run
+            for(uint32_t i = 0; i < size; i++) {
+                objects[i].boundingBox.x += velocities[i].x * direction;
+                objects[i].boundingBox.y += velocities[i].y * direction;
+                broadphase.move(objects[i]);
+            }
+            direction = -direction;
+            benchmarkSink = benchmarkSink + broadphase.getIntersections().size();
+        });
+}
+
+static void benchmarkNeuralNet(BenchmarkRunner& runner, const uint64_t seed) {
+    SimRandom::Stream rng = SimRandom::Stream(seed).split(SimRandom::Subsystem::ORGANISM);
+    const std::vector<Genome::Genome> genomes = createGenomes(rng);
+    std::vector<std::unique_ptr<NeuralNet>> nets(genomes.size());
+
+    runner.run("NeuralNet/construct", 0, genomes.size(),
+        [] {},
+        [&] {
+            for(size_t i = 0; i < genomes.size(); i++) nets[i] = std::make_unique<NeuralNet>(genomes[i]);
+        });
+
+    for(size_t i = 0; i < genomes.size(); i++) nets[i] = std::make_unique<NeuralNet>(genomes[i]);
+    std::uniform_real_distribution<float> distActivation(0.0f, 1.0f);
+    runner.run("NeuralNet/evaluate", 0, nets.size(),
+        [&] {
+            for(const auto& netPtr : nets) {
+                for(size_t i = 0; i < netPtr->getInputTypes().size(); i++) netPtr->setInputActivation(i, distActivation(rng));
+            }
+        },
+        [&] {
+            for(const auto& netPtr : nets) {
+                netPtr->evaluate();
+                if(!netPtr->getOutputTypes().empty()) benchmarkSink = benchmarkSink + (netPtr->getOutputActivation(0) > 0.5f);
+            }
+        });
+
+    NeuralBatch batch;
+    for(const auto& netPtr : nets) batch.push(*netPtr);
+    runner.run(std::string("NeuralBatch/evaluate/") + NeuralBatch::getKernelName(), 0, batch.size(),
+        [&] {
+            for(size_t row = 0; row < batch.size(); row++) {
+                for(const NeuronInputType type : nets[row]->getInputTypes()) batch.setInput(row, type, distActivation(rng));
+            }
+        },
+        [&] {
+            batch.evaluate();
+            benchmarkSink = benchmarkSink + (batch.getOutput(0, MOVE_LEFT) > 0.5f);
+        });
+}
+
+static void benchmarkGenome(BenchmarkRunner& runner, const uint64_t seed) {
+    SimRandom::Stream rng = SimRandom::Stream(seed).split(SimRandom::Subsystem::REPRODUCTION);
+    const std::vector<Genome::Genome> genomes = createGenomes(rng);
+    std::vector<Genome::Genome> children;
+
+    runner.run("Genome/createGenomeFromParents", 0, genomes.size(),
+        [&] {
+            children.clear();
+            children.reserve(genomes.size());
+        },
+        [&] {
+            for(size_t i = 0; i < genomes.size(); i++) {
+                children.push_back(Genome::createGenomeFromParents(genomes[i], genomes[(i + 1) % genomes.size()], rng));
+            }
+            benchmarkSink = benchmarkSink + children.size();
+        });
+    runner.run("Genome/mutateGenome", 0, genomes.size(),
+        [&] {children = genomes;},
+        [&] {
+            for(auto& genome : children) Genome::mutateGenome(&genome, rng);
+            benchmarkSink = benchmarkSink + children.size();
+        });
+}
+
+/**
+ * Steps a whole simulation at the given organism count. fixedUpdate and the wait for the neighbor worker
+ * are measured apart from update so a regression can be pinned on either side of the tick, then times copying the
+ * result into a render snapshot.
+ */
+static void benchmarkSimulation(BenchmarkRunner& runner, const BenchmarkOptions& options, const uint32_t size) {
+    if(!runner.shouldRun("Simulation/")) return;
+    static constexpr float fixedDeltaTime = 1.0f / 60.0f;
+    const SDL_Rect bounds = getScaledBounds(size);
+
+    auto start = std::chrono::steady_clock::now();
+    const auto simPtr = std::make_unique<Simulation>(bounds, size, genomeSize, 0.08f, options.seed, options.spatialIndexType,
+        options.workerCount);
+    const std::chrono::duration<double> constructSeconds = std::chrono::steady_clock::now() - start;
+    if(runner.shouldRun("Simulation/construct")) runner.add({"Simulation/construct", size, 1, size, constructSeconds.count()});
+
+    for(uint64_t i = 0; i < options.warmupTicks; i++) simPtr->step(fixedDeltaTime);
+
+    BenchmarkResult neighbor{"Simulation/fixedUpdate+neighborTask", size, 0, simPtr->getCurrentPopulation(), 0.0};
+    BenchmarkResult update{"Simulation/update", size, 0, simPtr->getCurrentPopulation(), 0.0};
+    BenchmarkResult tick{"Simulation/tick", size, 0, simPtr->getCurrentPopulation(), 0.0};
+    for(uint64_t i = 0; i < options.simTicks; i++) {
+        start = std::chrono::steady_clock::now();
+        simPtr->fixedUpdate();
+        simPtr->waitForNeighborTask();
+        const auto neighborsDone = std::chrono::steady_clock::now();
+        simPtr->update(bounds, fixedDeltaTime);
+        const auto updateDone = std::chrono::steady_clock::now();
+
+        neighbor.seconds += std::chrono::duration<double>(neighborsDone - start).count();
+        update.seconds += std::chrono::duration<double>(updateDone - neighborsDone).count();
+        tick.seconds += std::chrono::duration<double>(updateDone - start).count();
+        neighbor.iterations++;
+        update.iterations++;
+        tick.iterations++;
+    }
+    if(runner.shouldRun(neighbor.name)) runner.add(neighbor);
+    if(runner.shouldRun(update.name)) runner.add(update);
+    if(runner.shouldRun(tick.name)) runner.add(tick);
+
+    //what the simulation thread pays per drawn frame, the buffers are reused like the render buffer does
+    if(runner.shouldRun("Simulation/writeRenderSnapshot")) {
+        RenderSnapshot snapshot;
+        BenchmarkResult snapshotResult{"Simulation/writeRenderSnapshot", size, 0, simPtr->getCurrentPopulation(), 0.0};
+        for(uint64_t i = 0; i < options.simTicks; i++) {
+            start = std::chrono::steady_clock::now();
+            simPtr->writeRenderSnapshot(&snapshot);
+            snapshotResult.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            snapshotResult.iterations++;
+        }
+        runner.add(snapshotResult);
+    }
+    std::cerr << "population after " << options.warmupTicks + options.simTicks << " ticks: " << simPtr->getCurrentPopulation() << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if(!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    BenchmarkRunner runner(options);
+    ThreadPool threadPool(options.workerCount);
+    for(const uint32_t size : options.sizes) {
+        benchmarkSpatialIndex(runner, SpatialIndexType::QUADTREE, size, options.seed, &threadPool);
+        benchmarkSpatialIndex(runner, SpatialIndexType::GRID, size, options.seed, &threadPool);
+        benchmarkSpatialIndex(runner, SpatialIndexType::LINEAR_QUADTREE, size, options.seed, &threadPool);
+        benchmarkSweepAndPrune(runner, size, options.seed);
+    }
+    benchmarkNeuralNet(runner, options.seed);
+    benchmarkGenome(runner, options.seed);
+    for(const uint32_t size : options.sizes) benchmarkSimulation(runner, options, size);
+
+    if(options.outPath.empty()) {
+        runner.write(std::cout);
+        return 0;
+    }
+    std::ofstream out(options.outPath);
+    if(!out) {
+        std::cerr << "Couldn't open " << options.outPath << std::endl;
+        return 1;
+    }
+    runner.write(out);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef ENTITYSTORE_HPP
+#define ENTITYSTORE_HPP
+
+#include "SlotMap.hpp"
+#include "SimObject.hpp"
+#include "Organism.hpp"
+#include "StaticSimObjects.hpp"
+#include "OrganismComponents.hpp"
+#include "NeuralBatch.hpp"
+#include "UtilityStructs.hpp"
+#include <cstdint>
+#include <utility>
+
+/**
+ * Owns every object in a simulation, one slot map per kind of object.
+ * Object ids are the slot map handles, so an id found in the quadtree or a neighbor list
+ * resolves to its object with an index and a generation check instead of a hash lookup.
+ */
+class EntityStore {
+public:
+    SlotMap<Organism> organisms{static_cast<uint8_t>(EntityKind::ORGANISM)};
+    SlotMap<Food> foods{static_cast<uint8_t>(EntityKind::FOOD)};
+    SlotMap<FoodSpawnRange> foodSpawnRanges{static_cast<uint8_t>(EntityKind::FOOD_SPAWN_RANGE)};
+    SlotMap<Fire> fires{static_cast<uint8_t>(EntityKind::FIRE)};
+    SlotMap<Pheromone> pheromones{static_cast<uint8_t>(EntityKind::PHEROMONE)};
+    //both aligned with organisms, only add and erase organisms through emplaceOrganism and eraseOrganismAt
+    OrganismComponents organismComponents;
+    NeuralBatch neuralBatch;
+
+    template<typename Factory>
+    uint64_t emplaceOrganism(Factory&& create, const SDL_FRect& boundingBox) {
+        const uint64_t handle = organisms.emplace(std::forward<Factory>(create));
+        organismComponents.push(boundingBox);
+        neuralBatch.push(organisms[organisms.size() - 1].getNeuralNet());
+        return handle;
+    }
+    void eraseOrganismAt(const size_t denseIndex) {
+        organisms.eraseAt(denseIndex);
+        organismComponents.eraseAt(denseIndex);
+        neuralBatch.eraseAt(denseIndex);
+    }
+    void reserveOrganisms(const size_t capacity) {
+        organisms.reserve(capacity);
+        organismComponents.reserve(capacity);
+        neuralBatch.reserve(capacity);
+    }
+
+    [[nodiscard]] static EntityKind getKind(const uint64_t handle) {
+        return static_cast<EntityKind>(SlotHandle::getKind(handle));
+    }
+
+    /**
+     * @return the object with this id, or nullptr if it has been erased.
+     */
+    [[nodiscard]] SimObject* get(const uint64_t handle) {
+        switch(getKind(handle)) {
+            case EntityKind::ORGANISM: return organisms.get(handle);
+            case EntityKind::FOOD: return foods.get(handle);
+            case EntityKind::FOOD_SPAWN_RANGE: return foodSpawnRanges.get(handle);
+            case EntityKind::FIRE: return fires.get(handle);
+            case EntityKind::PHEROMONE: return pheromones.get(handle);
+            default: return nullptr;
+        }
+    }
+    [[nodiscard]] bool contains(const uint64_t handle) {return get(handle) != nullptr;}
+    [[nodiscard]] size_t size() const {
+        return organisms.size() + foods.size() + foodSpawnRanges.size() + fires.size() + pheromones.size();
+    }
+};
+
+#endif //ENTITYSTORE_HPP
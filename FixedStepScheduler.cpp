@@ -0,0 +1,65 @@
+#include "FixedStepScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+FixedStepScheduler::FixedStepScheduler(const float fixedDeltaTime, const float maxCatchUpSeconds) :
+    fixedDeltaTime(fixedDeltaTime),
+    maxCatchUpSeconds(maxCatchUpSeconds) {}
+
+float FixedStepScheduler::getMultiplier(const SimulationSpeed speed) {
+    switch(speed) {
+        case SimulationSpeed::X1: return 1.0f;
+        case SimulationSpeed::X10: return 10.0f;
+        case SimulationSpeed::X100: return 100.0f;
+        default: return INFINITY;
+    }
+}
+
+const char* FixedStepScheduler::getSpeedName(const SimulationSpeed speed) {
+    switch(speed) {
+        case SimulationSpeed::X1: return "1x";
+        case SimulationSpeed::X10: return "10x";
+        case SimulationSpeed::X100: return "100x";
+        case SimulationSpeed::UNLIMITED: return "unlimited";
+        default: return "unknown";
+    }
+}
+
+SimulationSpeed FixedStepScheduler::parseSpeed(const char* name) {
+    if(strcmp(name, "1") == 0 || strcmp(name, "1x") == 0) return SimulationSpeed::X1;
+    if(strcmp(name, "10") == 0 || strcmp(name, "10x") == 0) return SimulationSpeed::X10;
+    if(strcmp(name, "100") == 0 || strcmp(name, "100x") == 0) return SimulationSpeed::X100;
+    if(strcmp(name, "unlimited") == 0) return SimulationSpeed::UNLIMITED;
+    return SimulationSpeed::SIZE;
+}
+
+void FixedStepScheduler::setSpeed(const SimulationSpeed newSpeed) {
+    if(newSpeed == speed || newSpeed == SimulationSpeed::SIZE) return;
+    speed = newSpeed;
+    //steps owed at the old speed would otherwise all run at once after slowing down
+    dropBacklog();
+}
+
+void FixedStepScheduler::addRealTime(const float realSeconds) {
+    if(speed == SimulationSpeed::UNLIMITED) return;
+    accumulator += realSeconds * getMultiplier(speed);
+}
+
+bool FixedStepScheduler::isStepDue() const {
+    return speed == SimulationSpeed::UNLIMITED || accumulator >= fixedDeltaTime;
+}
+
+void FixedStepScheduler::consumeStep() {
+    if(speed == SimulationSpeed::UNLIMITED) return;
+    accumulator -= fixedDeltaTime;
+}
+
+void FixedStepScheduler::dropBacklog() {
+    accumulator = std::fmod(std::max(accumulator, 0.0f), fixedDeltaTime);
+}
+
+float FixedStepScheduler::getSecondsUntilNextStep() const {
+    if(isStepDue()) return 0.0f;
+    return (fixedDeltaTime - accumulator) / getMultiplier(speed);
+}
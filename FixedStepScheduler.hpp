@@ -0,0 +1,60 @@
+#ifndef FIXEDSTEPSCHEDULER_HPP
+#define FIXEDSTEPSCHEDULER_HPP
+
+#include <cstdint>
+
+enum class SimulationSpeed : uint8_t {
+    X1,
+    X10,
+    X100,
+    UNLIMITED, //as many ticks as the cpu can run
+    SIZE
+};
+
+/**
+ * Decides how many fixed steps the simulation runs for the real time that passed, so a tick always advances the
+ * simulation by the same delta time and the outcome doesn't depend on the frame rate or the speed it's watched at.
+ * Real time is scaled by the speed multiplier and collected until a whole step is due, the remainder carries over.
+ * When the steps fall behind for longer than the catch-up budget the backlog is dropped, the simulation runs slower
+ * than asked instead of spending ever longer catching up.
+ */
+class FixedStepScheduler {
+public:
+    /**
+     * @param maxCatchUpSeconds the real time spent running due steps before the rest of them are dropped.
+     */
+    explicit FixedStepScheduler(float fixedDeltaTime = 1.0f / 60.0f, float maxCatchUpSeconds = 0.05f);
+
+    void setSpeed(SimulationSpeed newSpeed);
+    [[nodiscard]] SimulationSpeed getSpeed() const {return speed;}
+    [[nodiscard]] float getFixedDeltaTime() const {return fixedDeltaTime;}
+    [[nodiscard]] float getMaxCatchUpSeconds() const {return maxCatchUpSeconds;}
+
+    void addRealTime(float realSeconds);
+    [[nodiscard]] bool isStepDue() const;
+    void consumeStep();
+    /**
+     * Forgets every due step but keeps the progress towards the next one.
+     */
+    void dropBacklog();
+    /**
+     * @return the real seconds until the next step is due, 0 if one already is.
+     */
+    [[nodiscard]] float getSecondsUntilNextStep() const;
+
+    static float getMultiplier(SimulationSpeed speed);
+    static const char* getSpeedName(SimulationSpeed speed);
+    /**
+     * @return SimulationSpeed::SIZE if name isn't 1, 10, 100 or unlimited.
+     */
+    static SimulationSpeed parseSpeed(const char* name);
+
+private:
+    const float fixedDeltaTime;
+    const float maxCatchUpSeconds;
+    SimulationSpeed speed = SimulationSpeed::X1;
+    //simulated seconds not run yet
+    float accumulator = 0.0f;
+};
+
+#endif //FIXEDSTEPSCHEDULER_HPP
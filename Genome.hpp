@@ -2,6 +2,7 @@
 #define GENOME_HPP
 #include "Neuron.hpp"
 #include "Traits.hpp"
+#include "SimRandom.hpp"
 #include <cassert>
 #include <cstdint>
 #include <random>
@@ -11,8 +12,6 @@
 
 namespace Genome {
 
-    static std::mt19937 mt{std::random_device{}()};
-
     struct Genome {
         // [source neuron is hidden | source neuron id | destination neuron is hidden | destination neuron id ] -> weight
         // [0                       | 0000000          | 0                            | 0000000               ] -> 16bits
@@ -28,11 +27,11 @@ namespace Genome {
         std::array<uint16_t, TRAITS_SIZE> traits;
     };
 
-    static inline uint8_t getRandomNeuronID(const bool isSource) {
+    static inline uint8_t getRandomNeuronID(const bool isSource, SimRandom::Stream& rng) {
         std::bernoulli_distribution distHidden(0.50);
         std::uniform_int_distribution<uint8_t> distNeuronID;
 
-        const bool isHidden = distHidden(mt);
+        const bool isHidden = distHidden(rng);
 
         if(isHidden)
             distNeuronID.param(std::uniform_int_distribution<uint8_t>::param_type(0,
@@ -48,58 +47,58 @@ namespace Genome {
                     NEURONINPUTTYPE_SIZE + NEURONOUTPUTTYPE_SIZE - 1));
 
         uint8_t neuronID = static_cast<uint8_t>(isHidden) << 7;
-        neuronID |= distNeuronID(mt);
+        neuronID |= distNeuronID(rng);
 
         return neuronID;
     }
 
-    static inline uint16_t getRandomConnectionID() {
-        auto connection = static_cast<uint16_t>(getRandomNeuronID(true)) << 8;
-        connection |= static_cast<uint16_t>(getRandomNeuronID(false));
+    static inline uint16_t getRandomConnectionID(SimRandom::Stream& rng) {
+        auto connection = static_cast<uint16_t>(getRandomNeuronID(true, rng)) << 8;
+        connection |= static_cast<uint16_t>(getRandomNeuronID(false, rng));
         return connection;
     }
 
-    static inline uint16_t getRandomValue() {
+    static inline uint16_t getRandomValue(SimRandom::Stream& rng) {
         std::uniform_int_distribution<uint16_t> distValue(0, UINT16_MAX);
 
-        return distValue(mt);
+        return distValue(rng);
     }
 
-    inline TraitGenome createRandomTraitGenome() {
+    inline TraitGenome createRandomTraitGenome(SimRandom::Stream& rng) {
         TraitGenome traitGenome = {};
 
         for(auto& trait : traitGenome.traits) {
-            trait = getRandomValue();
+            trait = getRandomValue(rng);
         }
 
         return traitGenome;
     }
 
-    inline Genome createRandomGenome(const uint16_t size) {
+    inline Genome createRandomGenome(const uint16_t size, SimRandom::Stream& rng) {
         assert(size > 0 && size <= 1000);
 
         Genome genome{};
         genome.connections.reserve(size);
 
         for (int i = 0; i < size; i++) {
-            const uint16_t connectionID = getRandomConnectionID();
+            const uint16_t connectionID = getRandomConnectionID(rng);
             if(genome.connections.contains(connectionID)) continue;
             const auto sourceID = static_cast<uint8_t>(connectionID >> 8);
             const auto destID = static_cast<uint8_t>(connectionID);
-            const uint16_t weight = getRandomValue();
+            const uint16_t weight = getRandomValue(rng);
 
             genome.connections[connectionID] = weight;
 
             if(!genome.biases.contains(sourceID))
-                genome.biases[sourceID] = getRandomValue();
+                genome.biases[sourceID] = getRandomValue(rng);
 
             if(!genome.biases.contains(destID))
-                genome.biases[destID] = getRandomValue();
+                genome.biases[destID] = getRandomValue(rng);
         }
         return genome;
     }
 
-    inline TraitGenome createTraitGenomeFromParents(const TraitGenome& parent1, const TraitGenome& parent2) {
+    inline TraitGenome createTraitGenomeFromParents(const TraitGenome& parent1, const TraitGenome& parent2, SimRandom::Stream& rng) {
         assert(parent1.traits.size() == parent2.traits.size());
         const size_t size = parent1.traits.size();
         TraitGenome traitGenome{};
@@ -107,8 +106,8 @@ namespace Genome {
         std::uniform_int_distribution<int> distNumParent1Genes(1, static_cast<int>(size) - 2);
         std::bernoulli_distribution distWhichParentFirst(0.50f);
 
-        const int numParent1Genes = distNumParent1Genes(mt);
-        const bool parent1First = distWhichParentFirst(mt);
+        const int numParent1Genes = distNumParent1Genes(rng);
+        const bool parent1First = distWhichParentFirst(rng);
 
         for(int i = 0; i < size; i++) {
             if((parent1First && i < numParent1Genes) || (!parent1First && i >= size - numParent1Genes)) {
@@ -120,7 +119,7 @@ namespace Genome {
         return traitGenome;
     }
 
-    inline Genome createGenomeFromParents(const Genome& parent1, const Genome& parent2) {
+    inline Genome createGenomeFromParents(const Genome& parent1, const Genome& parent2, SimRandom::Stream& rng) {
         const bool p1IsLarger = parent1.connections.size() >= parent2.connections.size();
         const Genome *largerParentPtr = p1IsLarger ? &parent1 : &parent2;
         const Genome *smallerParentPtr = p1IsLarger ? &parent2 : &parent1;
@@ -131,8 +130,8 @@ namespace Genome {
         std::uniform_int_distribution<int> distNumSmallerParentGenes(1, static_cast<int>(smallerParentPtr->connections.size()) - 2);
         std::bernoulli_distribution distWhichParentFirst(0.50f);
 
-        const int numSmallerParentGenes = distNumSmallerParentGenes(mt);
-        const bool smallerParentFirst = distWhichParentFirst(mt);
+        const int numSmallerParentGenes = distNumSmallerParentGenes(rng);
+        const bool smallerParentFirst = distWhichParentFirst(rng);
 
         if(parent1.connections.size() <= 2 || parent2.connections.size() <= 2) {
             if(smallerParentFirst) {
@@ -193,7 +192,7 @@ namespace Genome {
         return genome;
     }
 
-    static inline void mutateGene(const uint16_t connectionID, Genome* genomePtr) {
+    static inline void mutateGene(const uint16_t connectionID, Genome* genomePtr, SimRandom::Stream& rng) {
         const auto sourceID = static_cast<uint8_t>(connectionID >> 8);
         const auto destID = static_cast<uint8_t>(connectionID);
         const uint16_t weight = genomePtr->connections[connectionID];
@@ -201,55 +200,55 @@ namespace Genome {
         //mutation type of 0 denotes a source neuron mutation,
         //1 denotes a destination neuron mutation, 2 denotes a weight mutation,
         //3 denotes a bias mutation, and 4 denotes a whole gene mutation
-        switch(std::uniform_int_distribution<uint8_t> distMutationType(0, 4); distMutationType(mt)) {
+        switch(std::uniform_int_distribution<uint8_t> distMutationType(0, 4); distMutationType(rng)) {
             case 0: { //source neuron mutation
-                const uint8_t newSourceID = getRandomNeuronID(true);
+                const uint8_t newSourceID = getRandomNeuronID(true, rng);
                 const uint16_t newConnectionID = (connectionID & 0x00FF) | (static_cast<uint16_t>(newSourceID) << 8);
 
                 if(!genomePtr->connections.contains(newConnectionID)) {
                     genomePtr->connections.erase(connectionID);
                     genomePtr->connections[newConnectionID] = weight;
                     if(!genomePtr->biases.contains(newSourceID))
-                        genomePtr->biases[newSourceID] = getRandomValue();
+                        genomePtr->biases[newSourceID] = getRandomValue(rng);
                 }
                 break;
             }
             case 1: { //destination neuron mutation
-                const uint8_t newDestID = getRandomNeuronID(false);
+                const uint8_t newDestID = getRandomNeuronID(false, rng);
                 const uint16_t newConnectionID = (connectionID & 0xFF00) | static_cast<uint16_t>(newDestID);
 
                 if(!genomePtr->connections.contains(newConnectionID)) {
                     genomePtr->connections.erase(connectionID);
                     genomePtr->connections[newConnectionID] = weight;
                     if(!genomePtr->biases.contains(newDestID))
-                        genomePtr->biases[newDestID] = getRandomValue();
+                        genomePtr->biases[newDestID] = getRandomValue(rng);
                 }
                 break;
             }
             case 2: { //weight mutation
-                genomePtr->connections[connectionID] = getRandomValue();
+                genomePtr->connections[connectionID] = getRandomValue(rng);
                 break;
             }
                 //bias mutation
             case 3: {
-                genomePtr->biases[sourceID] = getRandomValue();
-                genomePtr->biases[destID] = getRandomValue();
+                genomePtr->biases[sourceID] = getRandomValue(rng);
+                genomePtr->biases[destID] = getRandomValue(rng);
                 break;
             }
             case 4: { //mutate whole gene
-                const uint16_t newConnectionID = getRandomConnectionID();
+                const uint16_t newConnectionID = getRandomConnectionID(rng);
 
                 if(!genomePtr->connections.contains(newConnectionID)) {
                     genomePtr->connections.erase(connectionID);
-                    genomePtr->connections[newConnectionID] = getRandomValue();
+                    genomePtr->connections[newConnectionID] = getRandomValue(rng);
                     const auto newSourceID = static_cast<uint8_t>(newConnectionID >> 8);
                     const auto newDestID = static_cast<uint8_t>(newConnectionID);
-                    genomePtr->biases[newSourceID] = getRandomValue();
-                    genomePtr->biases[newDestID] = getRandomValue();
+                    genomePtr->biases[newSourceID] = getRandomValue(rng);
+                    genomePtr->biases[newDestID] = getRandomValue(rng);
                 }else {
-                    genomePtr->connections[connectionID] = getRandomValue();
-                    genomePtr->biases[sourceID] = getRandomValue();
-                    genomePtr->biases[destID] = getRandomValue();
+                    genomePtr->connections[connectionID] = getRandomValue(rng);
+                    genomePtr->biases[sourceID] = getRandomValue(rng);
+                    genomePtr->biases[destID] = getRandomValue(rng);
                 }
                 break;
             }
@@ -257,16 +256,16 @@ namespace Genome {
         }
     }
 
-    inline void mutateTraitGenome(TraitGenome* traitGenomePtr) {
+    inline void mutateTraitGenome(TraitGenome* traitGenomePtr, SimRandom::Stream& rng) {
         std::bernoulli_distribution distChanceToMutate(0.10);
         for(auto& trait : traitGenomePtr->traits) {
-            if(distChanceToMutate(mt)) {
-               trait = getRandomValue();
+            if(distChanceToMutate(rng)) {
+               trait = getRandomValue(rng);
             }
         }
     }
 
-    inline void mutateGenome(Genome* genomePtr) {
+    inline void mutateGenome(Genome* genomePtr, SimRandom::Stream& rng) {
         if(genomePtr->connections.empty()) return;
 
         std::geometric_distribution<int> distNumConnectionsToMutate(0.2);
@@ -275,17 +274,17 @@ namespace Genome {
         std::set<int> connectionsToMutate;
 
         do {
-            numConnectionsToMutate = distNumConnectionsToMutate(mt);
+            numConnectionsToMutate = distNumConnectionsToMutate(rng);
         } while(numConnectionsToMutate < 1 || numConnectionsToMutate > genomePtr->connections.size());
 
         for(int i = 0; i < numConnectionsToMutate; i++) {
-            connectionsToMutate.insert(distConnectionsToMutate(mt));
+            connectionsToMutate.insert(distConnectionsToMutate(rng));
         }
 
         for(const int connectionToMutate : connectionsToMutate) {
             auto itrConnections = genomePtr->connections.begin();
             std::advance(itrConnections, connectionToMutate);
-            mutateGene(itrConnections->first, genomePtr);
+            mutateGene(itrConnections->first, genomePtr, rng);
         }
     }
 }
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "SDL3/SDL.h"
+#include "LinearQuadTree.hpp"
+#include "ThreadPool.hpp"
+#include "UtilityStructs.hpp"
+
+//keys counted and scattered by one task of a parallel sort, LinearQuadTree/rebuild/parallel costs the same as the
+//serial rebuild at this size while chunks of 4096 keys already paid for their tasks
+static constexpr size_t keysPerChunk = 16384;
+
+/**
+ * Sorts keys by their upper 32 bits with a least significant digit radix sort, 8 bits per pass.
+ * With a thread pool the keys are split into chunks of about keysPerChunk: the chunks count their digits across the
+ * pool, the counts are summed into offsets so each chunk writes to its own part of every bucket, then the chunks scatter.
+ * Every pass is stable, so keys with the same upper bits keep the order of their lower bits and the result doesn't
+ * depend on the split.
+ * @param bufferPtr scratch space as large as keys, kept by the caller between sorts.
+ * @param threadPoolPtr may be nullptr.
+ */
+static void radixSort(std::vector<uint64_t>* keysPtr, std::vector<uint64_t>* bufferPtr, ThreadPool* threadPoolPtr) {
+    constexpr uint32_t digitBits = 8;
+    constexpr uint32_t radix = 1 << digitBits;
+    constexpr uint32_t passes = 32 / digitBits;
+
+    const size_t count = keysPtr->size();
+    bufferPtr->resize(count);
+    const bool isParallel = threadPoolPtr && threadPoolPtr->getWorkerCount() > 0 && count > keysPerChunk;
+    const size_t chunkCount = isParallel ? (count + keysPerChunk - 1) / keysPerChunk : 1;
+
+    std::vector<std::array<size_t, radix>> histograms(chunkCount);
+    uint64_t* source = keysPtr->data();
+    uint64_t* destination = bufferPtr->data();
+    uint32_t shift = 32;
+
+    const auto countDigits = [&](const size_t chunk) {
+        std::array<size_t, radix>& histogram = histograms[chunk];
+        histogram.fill(0);
+        const size_t end = count * (chunk + 1) / chunkCount;
+        for(size_t i = count * chunk / chunkCount; i < end; i++) histogram[(source[i] >> shift) & (radix - 1)]++;
+    };
+    //turns the counts into where every chunk writes its first key of each digit
+    const auto computeOffsets = [&]() {
+        size_t offset = 0;
+        for(uint32_t digit = 0; digit < radix; digit++) {
+            for(std::array<size_t, radix>& histogram : histograms) {
+                const size_t digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+        }
+    };
+    const auto scatter = [&](const size_t chunk) {
+        std::array<size_t, radix>& offsets = histograms[chunk];
+        const size_t end = count * (chunk + 1) / chunkCount;
+        for(size_t i = count * chunk / chunkCount; i < end; i++) {
+            destination[offsets[(source[i] >> shift) & (radix - 1)]++] = source[i];
+        }
+    };
+    const auto forEachChunk = [&](const auto& func) {
+        if(!isParallel) {
+            func(0);
+            return;
+        }
+        threadPoolPtr->parallelFor(chunkCount, 1, [&func](const size_t begin, const size_t end) {
+            for(size_t chunk = begin; chunk < end; chunk++) func(chunk);
+        });
+    };
+
+    for(uint32_t pass = 0; pass < passes; pass++) {
+        forEachChunk(countDigits);
+        computeOffsets();
+        forEachChunk(scatter);
+        std::swap(source, destination);
+        shift += digitBits;
+    }
+    //an even amount of passes leaves the sorted keys back in keysPtr
+}
+
+void LinearQuadTree::insert(const Object& object) {
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) return;
+
+    const auto [slot, isNew] = slotOf.try_emplace(object.id, static_cast<uint32_t>(objects.size()));
+    if(isNew) objects.push_back(object);
+    else objects[slot->second] = object;
+    isDirty = true;
+}
+
+void LinearQuadTree::remove(const Object& object) {
+    const auto slot = slotOf.find(object.id);
+    if(slot == slotOf.end()) return;
+
+    const uint32_t index = slot->second;
+    slotOf.erase(slot);
+    if(index != objects.size() - 1) {
+        objects[index] = objects.back();
+        slotOf[objects[index].id] = index;
+    }
+    objects.pop_back();
+    isDirty = true;
+}
+
+/**
+ * Nothing is stored by position until the next rebuild, so a move only replaces the object's bounding box.
+ */
+void LinearQuadTree::move(const Object& object, const SDL_FRect& /*oldBoundingBox*/) {
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) remove(object);
+    else insert(object);
+}
+
+void LinearQuadTree::compact(ThreadPool* threadPoolPtr) {
+    if(isDirty) rebuild(threadPoolPtr);
+}
+
+std::unique_ptr<SpatialIndex> LinearQuadTree::clone() const {
+    auto copyPtr = std::make_unique<LinearQuadTree>(*this);
+    if(copyPtr->isDirty) copyPtr->rebuild(nullptr);
+    return copyPtr;
+}
+
+void LinearQuadTree::rebuild(ThreadPool* threadPoolPtr) {
+    isDirty = false;
+    largeObjects.clear();
+    sortScratch.clear();
+    maxHalfWidth = 0.0f;
+    maxHalfHeight = 0.0f;
+    for(uint32_t i = 0; i < objects.size(); i++) {
+        const SDL_FRect& box = objects[i].boundingBox;
+        if(box.w > largeObjectSize || box.h > largeObjectSize) {
+            largeObjects.push_back(objects[i]);
+            continue;
+        }
+        maxHalfWidth = std::max(maxHalfWidth, box.w * 0.5f);
+        maxHalfHeight = std::max(maxHalfHeight, box.h * 0.5f);
+        sortScratch.push_back((static_cast<uint64_t>(getCode(box)) << 32) | i);
+    }
+    radixSort(&sortScratch, &sortBuffer, threadPoolPtr);
+
+    sortedObjects.clear();
+    codes.clear();
+    sortedObjects.reserve(sortScratch.size());
+    codes.reserve(sortScratch.size());
+    for(const uint64_t key : sortScratch) {
+        codes.push_back(static_cast<uint32_t>(key >> 32));
+        sortedObjects.push_back(objects[static_cast<uint32_t>(key)]);
+    }
+}
+
+static uint32_t toCell(const float offset, const float extent, const uint32_t cellsPerAxis) {
+    const float cell = std::floor(offset / std::max(extent, 1.0f) * static_cast<float>(cellsPerAxis));
+    if(!(cell > 0.0f)) return 0;
+    return std::min(static_cast<uint32_t>(std::min(cell, static_cast<float>(cellsPerAxis))), cellsPerAxis - 1);
+}
+
+uint32_t LinearQuadTree::getCode(const SDL_FRect& box) const {
+    return getMortonCode(
+        toCell(box.x + box.w * 0.5f - bounds.x, bounds.w, cellsPerAxis),
+        toCell(box.y + box.h * 0.5f - bounds.y, bounds.h, cellsPerAxis)
+    );
+}
+
+//one cell of slack on every side keeps centers rounded onto the border of the range inside it
+LinearQuadTree::CellRange LinearQuadTree::getCandidateCells(const SDL_FRect& rect) const {
+    const uint32_t minX = toCell(rect.x - maxHalfWidth - bounds.x, bounds.w, cellsPerAxis);
+    const uint32_t minY = toCell(rect.y - maxHalfHeight - bounds.y, bounds.h, cellsPerAxis);
+    const uint32_t maxX = toCell(rect.x + rect.w + maxHalfWidth - bounds.x, bounds.w, cellsPerAxis);
+    const uint32_t maxY = toCell(rect.y + rect.h + maxHalfHeight - bounds.y, bounds.h, cellsPerAxis);
+    return {
+        minX == 0 ? 0 : minX - 1,
+        minY == 0 ? 0 : minY - 1,
+        std::min(maxX + 1, cellsPerAxis - 1),
+        std::min(maxY + 1, cellsPerAxis - 1)
+    };
+}
+
+uint32_t LinearQuadTree::findFirstCode(const uint32_t begin, const uint32_t end, const uint64_t code) const {
+    const auto first = std::lower_bound(codes.begin() + begin, codes.begin() + end, code,
+        [](const uint32_t currCode, const uint64_t value) {return currCode < value;});
+    return static_cast<uint32_t>(first - codes.begin());
+}
+
+/**
+ * Starts from the smallest quad holding the whole range, two binary searches find it instead of descending from the root.
+ */
+template<typename Func>
+void LinearQuadTree::forEachCandidate(const CellRange& range, const uint32_t firstIndex, Func&& func) const {
+    const uint32_t spread = (range.minX ^ range.maxX) | (range.minY ^ range.maxY);
+    const uint32_t cellCount = 1u << std::bit_width(spread);
+    const uint32_t cellX = range.minX & ~(cellCount - 1);
+    const uint32_t cellY = range.minY & ~(cellCount - 1);
+    const uint64_t firstCode = getMortonCode(cellX, cellY);
+    const auto objectCount = static_cast<uint32_t>(sortedObjects.size());
+    const uint32_t begin = findFirstCode(std::min(firstIndex, objectCount), objectCount, firstCode);
+    const uint32_t end = findFirstCode(begin, objectCount, firstCode + static_cast<uint64_t>(cellCount) * cellCount);
+    forEachCandidateInternal(begin, end, cellX, cellY, cellCount, range, func);
+}
+
+/**
+ * The quad at cellX, cellY spanning cellCount cells per side holds the sorted objects begin to end.
+ * Its four children split that range at the first code of each child, which every code of the quad shares the upper bits of.
+ */
+template<typename Func>
+void LinearQuadTree::forEachCandidateInternal(
+    const uint32_t begin,
+    const uint32_t end,
+    const uint32_t cellX,
+    const uint32_t cellY,
+    const uint32_t cellCount,
+    const CellRange& range,
+    Func&& func
+) const {
+    if(begin == end) return;
+    const uint32_t lastX = cellX + (cellCount - 1);
+    const uint32_t lastY = cellY + (cellCount - 1);
+    if(cellX > range.maxX || lastX < range.minX || cellY > range.maxY || lastY < range.minY) return;
+
+    const bool isInside = cellX >= range.minX && lastX <= range.maxX && cellY >= range.minY && lastY <= range.maxY;
+    if(isInside || end - begin <= leafSize || cellCount == 1) {
+        for(uint32_t i = begin; i < end; i++) func(i);
+        return;
+    }
+
+    const uint32_t half = cellCount / 2;
+    const uint64_t quarter = static_cast<uint64_t>(half) * half;
+    const uint64_t firstCode = getMortonCode(cellX, cellY);
+    uint32_t childBegin = begin;
+    for(uint32_t quad = 0; quad < 4; quad++) {
+        const uint32_t childEnd = quad < 3 ? findFirstCode(childBegin, end, firstCode + quarter * (quad + 1)) : end;
+        forEachCandidateInternal(childBegin, childEnd, cellX + (quad & 1) * half, cellY + (quad >> 1) * half, half, range, func);
+        childBegin = childEnd;
+    }
+}
+
+template<typename Func>
+void LinearQuadTree::forEachObjectIn(const SDL_FRect& rect, Func&& func) const {
+    forEachCandidate(getCandidateCells(rect), 0, [this, &rect, &func](const uint32_t i) {
+        if(rangeIntersectsRect(sortedObjects[i].boundingBox, rect)) func(sortedObjects[i]);
+    });
+    for(const Object& largeObject : largeObjects) {
+        if(rangeIntersectsRect(largeObject.boundingBox, rect)) func(largeObject);
+    }
+}
+
+/**
+ * Checks if the given object intersects any other objects present in the tree.
+ * @return a vector holding the id's of simulation objects the range is intersecting.
+ */
+void LinearQuadTree::findOverlapping(const Object& object, std::vector<uint64_t>* idsPtr) const {
+    idsPtr->clear();
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) return;
+    forEachObjectIn(object.boundingBox, [&object, idsPtr](const Object& currObject) {
+        if(currObject.id != object.id) idsPtr->push_back(currObject.id);
+    });
+}
+
+uint8_t LinearQuadTree::findNearestNeighbors(const Object& object, const std::span<Neighbor> neighbors) const {
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) return 0;
+
+    const SDL_FRect& box = object.boundingBox;
+    const SDL_FRect nearRange = {
+        box.x - isNearDistance,
+        box.y - isNearDistance,
+        box.w + isNearDistance * 2.0f,
+        box.h + isNearDistance * 2.0f
+    };
+    uint8_t count = 0;
+    const std::span<Neighbor> ranked = neighbors.first(maxNeighbors);
+    forEachObjectIn(nearRange, [&object, &ranked, &count](const Object& currObject) {
+        if(currObject.id == object.id || !rangeIsNearRect(object.boundingBox, currObject.boundingBox)) return;
+        const Vec2 distance = getMinDistanceBetweenRects(object.boundingBox, currObject.boundingBox);
+        if(distance == Vec2(0.0f, 0.0f)) return;
+        insertRanked(ranked, &count, Neighbor{currObject.id, currObject.kind, distance}, isCloserNeighbor);
+    });
+    return count;
+}
+
+/**
+ * Scans the whole ray box on purpose and ignores the direction, objects come out of the Morton ranges in Morton
+ * order rather than along the ray, and walking the ray a step at a time would redo the range lookup and the scan
+ * of the large objects for every step of a ray only a few cells long.
+ */
+void LinearQuadTree::rankRayHits(
+    const Object& object,
+    const Vec2&,
+    const SDL_FRect& ray,
+    const std::span<RayHit> hits,
+    uint8_t* countPtr
+) const {
+    forEachObjectIn(ray, [&object, &hits, countPtr](const Object& currObject) {
+        if(currObject.id != object.id) rankRayHit(object, currObject, hits, countPtr);
+    });
+}
+
+/**
+ * Every small object only looks at the small objects after it in Morton order, so each pair is reported once,
+ * large objects are checked against everything.
+ */
+std::vector<LinearQuadTree::Intersection> LinearQuadTree::getIntersections() const {
+    std::vector<Intersection> intersections;
+    for(uint32_t i = 0; i < sortedObjects.size(); i++) {
+        const Object& currObject = sortedObjects[i];
+        forEachCandidate(getCandidateCells(currObject.boundingBox), i + 1, [this, &currObject, &intersections](const uint32_t j) {
+            const Object& otherObject = sortedObjects[j];
+            if(rangeIntersectsRect(otherObject.boundingBox, currObject.boundingBox)) {
+                intersections.push_back({currObject.id, currObject.kind, otherObject.id, otherObject.kind});
+            }
+        });
+    }
+    for(uint32_t i = 0; i < largeObjects.size(); i++) {
+        const Object& currObject = largeObjects[i];
+        forEachCandidate(getCandidateCells(currObject.boundingBox), 0, [this, &currObject, &intersections](const uint32_t j) {
+            const Object& otherObject = sortedObjects[j];
+            if(rangeIntersectsRect(otherObject.boundingBox, currObject.boundingBox)) {
+                intersections.push_back({currObject.id, currObject.kind, otherObject.id, otherObject.kind});
+            }
+        });
+        for(uint32_t j = i + 1; j < largeObjects.size(); j++) {
+            const Object& otherObject = largeObjects[j];
+            if(rangeIntersectsRect(otherObject.boundingBox, currObject.boundingBox)) {
+                intersections.push_back({currObject.id, currObject.kind, otherObject.id, otherObject.kind});
+            }
+        }
+    }
+    return intersections;
+}
+
+/**
+ * Outlines every quad a lookup would scan whole, the way the tree would look if it stored nodes.
+ */
+void LinearQuadTree::show(SDL_Renderer* rendererPtr) const {
+    SDL_SetRenderDrawColor(rendererPtr, 255, 0, 0, 255);
+    SDL_RenderRect(rendererPtr, &bounds);
+    showInternal(0, static_cast<uint32_t>(sortedObjects.size()), 0, 0, cellsPerAxis, rendererPtr);
+}
+
+void LinearQuadTree::showInternal(
+    const uint32_t begin,
+    const uint32_t end,
+    const uint32_t cellX,
+    const uint32_t cellY,
+    const uint32_t cellCount,
+    SDL_Renderer* rendererPtr
+) const {
+    if(begin == end) return;
+    const float cellWidth = bounds.w / static_cast<float>(cellsPerAxis);
+    const float cellHeight = bounds.h / static_cast<float>(cellsPerAxis);
+    const SDL_FRect quadBounds = {
+        bounds.x + static_cast<float>(cellX) * cellWidth,
+        bounds.y + static_cast<float>(cellY) * cellHeight,
+        static_cast<float>(cellCount) * cellWidth,
+        static_cast<float>(cellCount) * cellHeight
+    };
+    SDL_RenderRect(rendererPtr, &quadBounds);
+    if(end - begin <= leafSize || cellCount == 1) return;
+
+    const uint32_t half = cellCount / 2;
+    const uint64_t quarter = static_cast<uint64_t>(half) * half;
+    const uint64_t firstCode = getMortonCode(cellX, cellY);
+    uint32_t childBegin = begin;
+    for(uint32_t quad = 0; quad < 4; quad++) {
+        const uint32_t childEnd = quad < 3 ? findFirstCode(childBegin, end, firstCode + quarter * (quad + 1)) : end;
+        showInternal(childBegin, childEnd, cellX + (quad & 1) * half, cellY + (quad >> 1) * half, half, rendererPtr);
+        childBegin = childEnd;
+    }
+}
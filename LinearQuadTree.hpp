@@ -0,0 +1,106 @@
+#ifndef LINEARQUADTREE_HPP
+#define LINEARQUADTREE_HPP
+
+#include "SDL3/SDL.h"
+#include "SpatialIndex.hpp"
+#include "UtilityStructs.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The spatial index backend that rebuilds from scratch every fixed step instead of maintaining a tree.
+ * compact sorts the objects by the Morton code of their centers, after which every quad of a 65536x65536 cell
+ * quadtree over the bounds is a contiguous range of the sorted array found with a binary search, no nodes are stored.
+ * Lookups see the objects as they were at the last compact (or clone), inserts, removes and moves only take effect
+ * with the next one. Objects larger than largeObjectSize are kept out of the sort and checked by every lookup, so
+ * a few big ones don't widen the range every lookup has to search.
+ */
+class LinearQuadTree : public SpatialIndex {
+public:
+    /**
+     * @param bounds an sdl float rectangle with the x,y members pointing to the top left point of the rectangle
+     */
+    explicit LinearQuadTree(const SDL_FRect& bounds) : bounds(bounds) {}
+
+    //the built tree is a handful of flat vectors, so copying it is a few bulk copies
+
+    void insert(const Object& object) override;
+    void remove(const Object& object) override;
+    void move(const Object& object, const SDL_FRect& oldBoundingBox) override;
+    /**
+     * Rebuilds the sorted array if anything changed since the last rebuild, sorting across threadPoolPtr if given.
+     */
+    void compact(ThreadPool* threadPoolPtr = nullptr) override;
+    void reset(const SDL_FRect& newBounds) override {*this = LinearQuadTree(newBounds);}
+    [[nodiscard]] std::unique_ptr<SpatialIndex> clone() const override;
+
+    void findOverlapping(const Object& object, std::vector<uint64_t>* idsPtr) const override;
+    uint8_t findNearestNeighbors(const Object& object, std::span<Neighbor> neighbors) const override;
+    [[nodiscard]] std::vector<Intersection> getIntersections() const override;
+    [[nodiscard]] SDL_FRect getBounds() const override {return bounds;}
+
+    void show(SDL_Renderer* rendererPtr) const override;
+    [[nodiscard]] size_t size() const override {return objects.size();}
+
+protected:
+    void rankRayHits(const Object& object, const Vec2& direction, const SDL_FRect& ray, std::span<RayHit> hits,
+        uint8_t* countPtr) const override;
+
+private:
+    static constexpr uint32_t cellsPerAxis = 65536;
+    static constexpr uint32_t leafSize = 8;
+    static constexpr float largeObjectSize = 64.0f;
+
+    struct CellRange {
+        uint32_t minX;
+        uint32_t minY;
+        uint32_t maxX;
+        uint32_t maxY;
+    };
+
+    SDL_FRect bounds;
+    //the objects as inserted, removes swap the last object into the freed slot
+    std::vector<Object> objects;
+    std::unordered_map<uint64_t, uint32_t> slotOf;
+    bool isDirty = false;
+
+    //the last rebuild: small objects and their codes in Morton order, large objects apart
+    std::vector<Object> sortedObjects;
+    std::vector<uint32_t> codes;
+    std::vector<Object> largeObjects;
+    //how far the box of a small object reaches past its center at most
+    float maxHalfWidth = 0.0f;
+    float maxHalfHeight = 0.0f;
+    std::vector<uint64_t> sortScratch;
+    std::vector<uint64_t> sortBuffer;
+
+    void rebuild(ThreadPool* threadPoolPtr);
+    [[nodiscard]] uint32_t getCode(const SDL_FRect& box) const;
+    /**
+     * @return the cells holding the center of every small object that can intersect rect.
+     */
+    [[nodiscard]] CellRange getCandidateCells(const SDL_FRect& rect) const;
+    /**
+     * @return the index of the first sorted object from begin to end with a code of at least code, end if there is none.
+     */
+    [[nodiscard]] uint32_t findFirstCode(uint32_t begin, uint32_t end, uint64_t code) const;
+    /**
+     * Calls func with the sorted index of every small object from firstIndex on whose center cell lies in range, the caller tests the boxes.
+     */
+    template<typename Func>
+    void forEachCandidate(const CellRange& range, uint32_t firstIndex, Func&& func) const;
+    template<typename Func>
+    void forEachCandidateInternal(uint32_t begin, uint32_t end, uint32_t cellX, uint32_t cellY, uint32_t cellCount,
+        const CellRange& range, Func&& func) const;
+    /**
+     * Calls func with every object, small or large, intersecting rect.
+     */
+    template<typename Func>
+    void forEachObjectIn(const SDL_FRect& rect, Func&& func) const;
+    void showInternal(uint32_t begin, uint32_t end, uint32_t cellX, uint32_t cellY, uint32_t cellCount, SDL_Renderer* rendererPtr) const;
+};
+
+#endif //LINEARQUADTREE_HPP
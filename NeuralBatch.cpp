@@ -0,0 +1,253 @@
+#include "NeuralBatch.hpp"
+#include "NeuralNet.hpp"
+#include "Neuron.hpp"
+#include "SDL3/SDL_log.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NEURALBATCH_SSE2
+#endif
+
+//the same neuron of every row in a group, the kernel below is written once against these operations
+#if defined(__AVX2__)
+struct Lanes {
+    __m256 value;
+};
+static Lanes load(const float* source) {return {_mm256_loadu_ps(source)};}
+static void store(float* destination, const Lanes& lanes) {_mm256_storeu_ps(destination, lanes.value);}
+static Lanes broadcast(const float value) {return {_mm256_set1_ps(value)};}
+static Lanes operator+(const Lanes& a, const Lanes& b) {return {_mm256_add_ps(a.value, b.value)};}
+static Lanes operator-(const Lanes& a, const Lanes& b) {return {_mm256_sub_ps(a.value, b.value)};}
+static Lanes operator*(const Lanes& a, const Lanes& b) {return {_mm256_mul_ps(a.value, b.value)};}
+static Lanes operator/(const Lanes& a, const Lanes& b) {return {_mm256_div_ps(a.value, b.value)};}
+static Lanes clamp(const Lanes& a, const float low, const float high) {
+    return {_mm256_min_ps(_mm256_max_ps(a.value, _mm256_set1_ps(low)), _mm256_set1_ps(high))};
+}
+static Lanes floorLanes(const Lanes& a) {return {_mm256_floor_ps(a.value)};}
+static Lanes exp2Integer(const Lanes& n) {
+    const __m256i exponent = _mm256_add_epi32(_mm256_cvtps_epi32(n.value), _mm256_set1_epi32(127));
+    return {_mm256_castsi256_ps(_mm256_slli_epi32(exponent, 23))};
+}
+#elif defined(NEURALBATCH_SSE2)
+struct Lanes {
+    __m128 low;
+    __m128 high;
+};
+static Lanes load(const float* source) {return {_mm_loadu_ps(source), _mm_loadu_ps(source + 4)};}
+static void store(float* destination, const Lanes& lanes) {
+    _mm_storeu_ps(destination, lanes.low);
+    _mm_storeu_ps(destination + 4, lanes.high);
+}
+static Lanes broadcast(const float value) {return {_mm_set1_ps(value), _mm_set1_ps(value)};}
+static Lanes operator+(const Lanes& a, const Lanes& b) {return {_mm_add_ps(a.low, b.low), _mm_add_ps(a.high, b.high)};}
+static Lanes operator-(const Lanes& a, const Lanes& b) {return {_mm_sub_ps(a.low, b.low), _mm_sub_ps(a.high, b.high)};}
+static Lanes operator*(const Lanes& a, const Lanes& b) {return {_mm_mul_ps(a.low, b.low), _mm_mul_ps(a.high, b.high)};}
+static Lanes operator/(const Lanes& a, const Lanes& b) {return {_mm_div_ps(a.low, b.low), _mm_div_ps(a.high, b.high)};}
+static Lanes clamp(const Lanes& a, const float low, const float high) {
+    const __m128 lowBound = _mm_set1_ps(low);
+    const __m128 highBound = _mm_set1_ps(high);
+    return {_mm_min_ps(_mm_max_ps(a.low, lowBound), highBound), _mm_min_ps(_mm_max_ps(a.high, lowBound), highBound)};
+}
+static __m128 floorHalf(const __m128 a) {
+    //sse2 has no floor, truncate and step down where truncating rounded up
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+}
+static Lanes floorLanes(const Lanes& a) {return {floorHalf(a.low), floorHalf(a.high)};}
+static __m128 exp2IntegerHalf(const __m128 n) {
+    const __m128i exponent = _mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127));
+    return _mm_castsi128_ps(_mm_slli_epi32(exponent, 23));
+}
+static Lanes exp2Integer(const Lanes& n) {return {exp2IntegerHalf(n.low), exp2IntegerHalf(n.high)};}
+#else
+struct Lanes {
+    std::array<float, NeuralBatch::laneCount> value;
+};
+template<typename Func>
+static Lanes forEachLane(Func&& func) {
+    Lanes result{};
+    for(size_t i = 0; i < NeuralBatch::laneCount; i++) result.value[i] = func(i);
+    return result;
+}
+static Lanes load(const float* source) {return forEachLane([source](const size_t i) {return source[i];});}
+static void store(float* destination, const Lanes& lanes) {std::copy(lanes.value.begin(), lanes.value.end(), destination);}
+static Lanes broadcast(const float value) {return forEachLane([value](size_t) {return value;});}
+static Lanes operator+(const Lanes& a, const Lanes& b) {return forEachLane([&](const size_t i) {return a.value[i] + b.value[i];});}
+static Lanes operator-(const Lanes& a, const Lanes& b) {return forEachLane([&](const size_t i) {return a.value[i] - b.value[i];});}
+static Lanes operator*(const Lanes& a, const Lanes& b) {return forEachLane([&](const size_t i) {return a.value[i] * b.value[i];});}
+static Lanes operator/(const Lanes& a, const Lanes& b) {return forEachLane([&](const size_t i) {return a.value[i] / b.value[i];});}
+static Lanes clamp(const Lanes& a, const float low, const float high) {
+    return forEachLane([&](const size_t i) {return std::min(std::max(a.value[i], low), high);});
+}
+static Lanes floorLanes(const Lanes& a) {return forEachLane([&](const size_t i) {return std::floor(a.value[i]);});}
+static Lanes exp2Integer(const Lanes& n) {
+    return forEachLane([&](const size_t i) {
+        return std::bit_cast<float>((static_cast<int32_t>(n.value[i]) + 127) << 23);
+    });
+}
+#endif
+
+/**
+ * e^x with the range reduction and polynomial of the cephes expf, accurate to a few ulp.
+ * std::exp has no SIMD form, this is written with the lane operations so every build computes the same values.
+ */
+static Lanes expLanes(const Lanes& x) {
+    static constexpr float log2e = 1.44269504088896341f;
+    //ln(2) split in two so the reduction stays exact
+    static constexpr float ln2High = 0.693359375f;
+    static constexpr float ln2Low = -2.12194440e-4f;
+
+    const Lanes clamped = clamp(x, -88.0f, 88.0f);
+    const Lanes n = floorLanes(clamped * broadcast(log2e) + broadcast(0.5f));
+    const Lanes r = clamped - n * broadcast(ln2High) - n * broadcast(ln2Low);
+
+    Lanes polynomial = broadcast(1.9875691500e-4f);
+    polynomial = polynomial * r + broadcast(1.3981999507e-3f);
+    polynomial = polynomial * r + broadcast(8.3334519073e-3f);
+    polynomial = polynomial * r + broadcast(4.1665795894e-2f);
+    polynomial = polynomial * r + broadcast(1.6666665459e-1f);
+    polynomial = polynomial * r + broadcast(5.0000001201e-1f);
+    polynomial = polynomial * r * r + r + broadcast(1.0f);
+    return polynomial * exp2Integer(n);
+}
+
+static Lanes sigmoidLanes(const Lanes& x) {
+    const Lanes one = broadcast(1.0f);
+    return one / (one + expLanes(broadcast(0.0f) - x));
+}
+
+const char* NeuralBatch::getKernelName() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(NEURALBATCH_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void NeuralBatch::push(const NeuralNet& net) {
+    if(rowCount % laneCount == 0) {
+        const size_t groupCount = rowCount / laneCount + 1;
+        weights.resize(groupCount * weightCount * laneCount, 0.0f);
+        biases.resize(groupCount * destinationCount * laneCount, 0.0f);
+        activations.resize(groupCount * activationCount * laneCount, 0.0f);
+    }
+    assign(rowCount++, net);
+}
+
+void NeuralBatch::assign(const size_t row, const NeuralNet& net) {
+    for(size_t i = 0; i < weightCount; i++) weights[index(row, i, weightCount)] = 0.0f;
+    for(size_t i = 0; i < destinationCount; i++) biases[index(row, i, destinationCount)] = 0.0f;
+    for(size_t i = 0; i < activationCount; i++) activations[index(row, i, activationCount)] = 0.0f;
+
+    //net slot -> position in this batch's activations, which start with the same inputs and hidden neurons as the sources
+    auto toActivation = [&net](const size_t slot) -> size_t {
+        if(slot < net.hiddenOffset) return net.inputTypes[slot];
+        if(slot < net.outputOffset) return inputCount + net.hiddenTypes[slot - net.hiddenOffset];
+        return hiddenCount + net.outputTypes[slot - net.outputOffset];
+    };
+    for(size_t slot = 0; slot < net.activations.size(); slot++) {
+        const size_t activation = toActivation(slot);
+        activations[index(row, activation, activationCount)] = net.activations[slot];
+        if(slot >= net.hiddenOffset) biases[index(row, activation - inputCount, destinationCount)] = net.biases[slot];
+    }
+    auto addEdges = [&](const std::vector<NeuralNet::Edge>& edges) {
+        for(const NeuralNet::Edge& edge : edges) {
+            const size_t source = toActivation(edge.source);
+            const size_t destination = toActivation(edge.destination) - inputCount;
+            weights[index(row, source * destinationCount + destination, weightCount)] = edge.weight;
+        }
+    };
+    addEdges(net.hiddenEdges);
+    addEdges(net.outputEdges);
+}
+
+void NeuralBatch::copyRow(const size_t fromRow, const size_t toRow) {
+    for(size_t i = 0; i < weightCount; i++) weights[index(toRow, i, weightCount)] = weights[index(fromRow, i, weightCount)];
+    for(size_t i = 0; i < destinationCount; i++) biases[index(toRow, i, destinationCount)] = biases[index(fromRow, i, destinationCount)];
+    for(size_t i = 0; i < activationCount; i++) activations[index(toRow, i, activationCount)] = activations[index(fromRow, i, activationCount)];
+}
+
+/**
+ * Moves the last row into the erased one, the same way SlotMap::eraseAt does.
+ */
+void NeuralBatch::eraseAt(const size_t row) {
+    const size_t lastRow = rowCount - 1;
+    if(row != lastRow) copyRow(lastRow, row);
+    rowCount--;
+    if(rowCount % laneCount == 0) {
+        const size_t groupCount = rowCount / laneCount;
+        weights.resize(groupCount * weightCount * laneCount);
+        biases.resize(groupCount * destinationCount * laneCount);
+        activations.resize(groupCount * activationCount * laneCount);
+        return;
+    }
+    //keep the unused lanes of the last group zeroed so they never hold stale values
+    for(size_t i = 0; i < weightCount; i++) weights[index(lastRow, i, weightCount)] = 0.0f;
+    for(size_t i = 0; i < destinationCount; i++) biases[index(lastRow, i, destinationCount)] = 0.0f;
+    for(size_t i = 0; i < activationCount; i++) activations[index(lastRow, i, activationCount)] = 0.0f;
+}
+
+void NeuralBatch::reserve(const size_t capacity) {
+    const size_t groupCount = (capacity + laneCount - 1) / laneCount;
+    weights.reserve(groupCount * weightCount * laneCount);
+    biases.reserve(groupCount * destinationCount * laneCount);
+    activations.reserve(groupCount * activationCount * laneCount);
+}
+
+void NeuralBatch::setInput(const size_t row, const NeuronInputType type, const float activation) {
+    if(activation < 0.0f || activation > 1.0f) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+                     "Error on provided activation for Neuron ID: %d"
+                     "\nError: Provided activation is not between 0.0 and 1.0", type);
+        return;
+    }
+    activations[index(row, type, activationCount)] = activation;
+}
+
+void NeuralBatch::evaluate(const size_t beginRow, const size_t endRow) {
+    const size_t endGroup = (std::min(endRow, rowCount) + laneCount - 1) / laneCount;
+    for(size_t group = beginRow / laneCount; group < endGroup; group++) {
+        const float* groupWeights = weights.data() + group * weightCount * laneCount;
+        const float* groupBiases = biases.data() + group * destinationCount * laneCount;
+        float* groupActivations = activations.data() + group * activationCount * laneCount;
+        float* hiddenActivations = groupActivations + inputCount * laneCount;
+        float* outputActivations = groupActivations + (inputCount + hiddenCount) * laneCount;
+
+        //every hidden sum is finished before any hidden activation is written, so hidden neurons read each other's previous step
+        std::array<Lanes, hiddenCount> hiddenSums;
+        for(size_t i = 0; i < hiddenCount; i++) {
+            hiddenSums[i] = load(hiddenActivations + i * laneCount) + load(groupBiases + i * laneCount);
+        }
+        for(size_t source = 0; source < sourceCount; source++) {
+            const Lanes sourceActivation = load(groupActivations + source * laneCount);
+            const float* sourceWeights = groupWeights + source * destinationCount * laneCount;
+            for(size_t i = 0; i < hiddenCount; i++) {
+                hiddenSums[i] = hiddenSums[i] + load(sourceWeights + i * laneCount) * sourceActivation;
+            }
+        }
+        for(size_t i = 0; i < hiddenCount; i++) store(hiddenActivations + i * laneCount, sigmoidLanes(hiddenSums[i]));
+
+        std::array<Lanes, outputCount> outputSums;
+        for(size_t i = 0; i < outputCount; i++) {
+            outputSums[i] = load(outputActivations + i * laneCount) + load(groupBiases + (hiddenCount + i) * laneCount);
+        }
+        for(size_t source = 0; source < sourceCount; source++) {
+            const Lanes sourceActivation = load(groupActivations + source * laneCount);
+            const float* sourceWeights = groupWeights + (source * destinationCount + hiddenCount) * laneCount;
+            for(size_t i = 0; i < outputCount; i++) {
+                outputSums[i] = outputSums[i] + load(sourceWeights + i * laneCount) * sourceActivation;
+            }
+        }
+        for(size_t i = 0; i < outputCount; i++) store(outputActivations + i * laneCount, sigmoidLanes(outputSums[i]));
+    }
+}
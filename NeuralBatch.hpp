@@ -0,0 +1,77 @@
+#ifndef NEURALBATCH_HPP
+#define NEURALBATCH_HPP
+
+#include "NeuralNet.hpp"
+#include "Neuron.hpp"
+#include <cstddef>
+#include <vector>
+
+/**
+ * The neural nets of a whole population, padded to the same dense shape and evaluated together.
+ * Every net gets a full weight matrix from all 23 inputs and 10 hidden neurons into all 10 hidden neurons and 5 outputs,
+ * connections its genome doesn't have are zero weights, so one kernel fits every net regardless of its topology.
+ * Rows are interleaved in groups of laneCount: for every weight, bias and activation the group stores the value of
+ * each of its rows next to each other, so one SIMD instruction updates the same neuron of laneCount nets at once.
+ * Rows are added and swap-removed alongside the organisms like OrganismComponents rows.
+ */
+class NeuralBatch {
+public:
+    static constexpr size_t laneCount = 8;
+    static constexpr size_t inputCount = inputValues.size();
+    static constexpr size_t hiddenCount = hiddenValues.size();
+    static constexpr size_t outputCount = outputValues.size();
+
+    void push(const NeuralNet& net);
+    /**
+     * Replaces a row with another net, its activations are taken from the net.
+     */
+    void assign(size_t row, const NeuralNet& net);
+    void eraseAt(size_t row);
+    void reserve(size_t capacity);
+    [[nodiscard]] size_t size() const {return rowCount;}
+
+    [[nodiscard]] float getInput(const size_t row, const NeuronInputType type) const {
+        return activations[index(row, type, activationCount)];
+    }
+    void setInput(size_t row, NeuronInputType type, float activation);
+    [[nodiscard]] float getOutput(const size_t row, const NeuronOutputType type) const {
+        return activations[index(row, inputCount + hiddenCount + (type - inputCount), activationCount)];
+    }
+
+    /**
+     * Runs one step of every net, with the same update rule as NeuralNet::evaluate.
+     */
+    void evaluate() {evaluate(0, rowCount);}
+    /**
+     * Runs one step of the nets in the groups holding rows beginRow to endRow. Ranges split at multiples of laneCount
+     * share no group, so they can be evaluated on different threads at once.
+     */
+    void evaluate(size_t beginRow, size_t endRow);
+
+    /**
+     * @return the instruction set evaluate was compiled for, "avx2", "sse2" or "scalar".
+     */
+    static const char* getKernelName();
+
+private:
+    //weights come from every input and hidden neuron and go to every hidden and output neuron
+    static constexpr size_t sourceCount = inputCount + hiddenCount;
+    static constexpr size_t destinationCount = hiddenCount + outputCount;
+    static constexpr size_t weightCount = destinationCount * sourceCount;
+    static constexpr size_t activationCount = inputCount + hiddenCount + outputCount;
+
+    size_t rowCount = 0;
+    std::vector<float> weights; //per group [source][destination][lane]
+    std::vector<float> biases; //per group [destination][lane]
+    std::vector<float> activations; //per group [inputs, hidden, outputs][lane]
+
+    /**
+     * @return where the value of one row for one item sits in an array with itemCount items per group.
+     */
+    static size_t index(const size_t row, const size_t item, const size_t itemCount) {
+        return ((row / laneCount) * itemCount + item) * laneCount + row % laneCount;
+    }
+    void copyRow(size_t fromRow, size_t toRow);
+};
+
+#endif //NEURALBATCH_HPP
@@ -2,6 +2,8 @@
 #include "Neuron.hpp"
 #include "Genome.hpp"
 #include "SDL3/SDL_log.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <vector>
 #include <utility>
@@ -17,166 +19,127 @@ float NeuralNet::convertRawWeightOrBias(const uint16_t rawValue) {
 }
 
 NeuralNet::NeuralNet(const Genome::Genome& genome) {
-    for(const auto & [connectionID, rawWeight] : genome.connections) {
-        const auto sourceFullID =
-            static_cast<uint8_t>(connectionID >> 8);
-        const auto destFullID =
-            static_cast<uint8_t>(connectionID);
-        const bool sourceIsHidden = connectionID & 0x8000;
-        const bool destIsHidden = connectionID & 0x0080;
-        const uint8_t sourceID = sourceFullID & 0x7F;
-        const uint8_t destID = destFullID & 0x7F;
-        const float weight = convertRawWeightOrBias(rawWeight);
-
-        std::shared_ptr<Neuron> sourceNeuron = getNeuron(
-            sourceIsHidden ?
-                NeuronType (static_cast<NeuronHiddenType>(sourceID))
-                    :
-                NeuronType (static_cast<NeuronInputType>(sourceID)),
-            genome.biases.at(sourceFullID));
-
-        std::shared_ptr<Neuron> destNeuron = getNeuron(
-            destIsHidden ?
-                NeuronType (static_cast<NeuronHiddenType>(destID))
-                    :
-                NeuronType (static_cast<NeuronOutputType>(destID)),
-            genome.biases.at(destFullID));
+    //neurons are only part of the net if a connection uses them
+    std::vector<uint8_t> usedInputs(NEURONINPUTTYPE_SIZE, false);
+    std::vector<uint8_t> usedHidden(NEURONHIDDENTYPE_SIZE, false);
+    std::vector<uint8_t> usedOutputs(NEURONOUTPUTTYPE_SIZE, false);
+    auto markUsed = [&](const uint8_t fullID, const bool isSource) {
+        const uint8_t neuronID = fullID & 0x7F;
+        if(fullID & 0x80) usedHidden[neuronID] = true;
+        else if(isSource) usedInputs[neuronID] = true;
+        else usedOutputs[neuronID - NEURONINPUTTYPE_SIZE] = true;
+    };
+    for(const auto& [connectionID, rawWeight] : genome.connections) {
+        markUsed(static_cast<uint8_t>(connectionID >> 8), true);
+        markUsed(static_cast<uint8_t>(connectionID), false);
+    }
 
-        destNeuron->prevLayerConnections.value().emplace_back(sourceNeuron, weight);
+    //full genome neuron id -> slot in the activation array
+    std::vector<uint16_t> inputSlots(NEURONINPUTTYPE_SIZE), hiddenSlots(NEURONHIDDENTYPE_SIZE), outputSlots(NEURONOUTPUTTYPE_SIZE);
+    uint16_t slot = 0;
+    for(size_t i = 0; i < usedInputs.size(); i++) {
+        if(!usedInputs[i]) continue;
+        inputTypes.push_back(static_cast<NeuronInputType>(i));
+        inputSlots[i] = slot++;
+    }
+    hiddenOffset = slot;
+    for(size_t i = 0; i < usedHidden.size(); i++) {
+        if(!usedHidden[i]) continue;
+        hiddenTypes.push_back(static_cast<NeuronHiddenType>(i));
+        hiddenSlots[i] = slot++;
+    }
+    outputOffset = slot;
+    for(size_t i = 0; i < usedOutputs.size(); i++) {
+        if(!usedOutputs[i]) continue;
+        outputTypes.push_back(static_cast<NeuronOutputType>(i + NEURONINPUTTYPE_SIZE));
+        outputSlots[i] = slot++;
+    }
+    auto getSlot = [&](const uint8_t fullID, const bool isSource) -> uint16_t {
+        const uint8_t neuronID = fullID & 0x7F;
+        if(fullID & 0x80) return hiddenSlots[neuronID];
+        if(isSource) return inputSlots[neuronID];
+        return outputSlots[neuronID - NEURONINPUTTYPE_SIZE];
+    };
+
+    activations.assign(slot, 0.0f);
+    previousActivations.assign(slot, 0.0f);
+    biases.assign(slot, 0.0f);
+    for(size_t i = 0; i < hiddenTypes.size(); i++) {
+        biases[hiddenOffset + i] = convertRawWeightOrBias(genome.biases.at(0x80 | hiddenTypes[i]));
+    }
+    for(size_t i = 0; i < outputTypes.size(); i++) {
+        biases[outputOffset + i] = convertRawWeightOrBias(genome.biases.at(outputTypes[i]));
     }
-}
 
-std::vector<std::pair<NeuronInputType, float>> NeuralNet::getInputActivations() const{
-    std::vector<std::pair<NeuronInputType, float>> inputActivations;
-    inputActivations.reserve(inputNeurons.size());
-    for(auto & [neuronID, neuronPtr] : inputNeurons) {
-        inputActivations.emplace_back(neuronID, neuronPtr->activation);
+    for(const auto& [connectionID, rawWeight] : genome.connections) {
+        const Edge edge{
+            getSlot(static_cast<uint8_t>(connectionID >> 8), true),
+            getSlot(static_cast<uint8_t>(connectionID), false),
+            convertRawWeightOrBias(rawWeight)
+        };
+        if(connectionID & 0x0080) hiddenEdges.push_back(edge);
+        else outputEdges.push_back(edge);
     }
-    return inputActivations;
+    auto byDestination = [](const Edge& edge1, const Edge& edge2) {
+        return edge1.destination != edge2.destination ? edge1.destination < edge2.destination : edge1.source < edge2.source;
+    };
+    std::sort(hiddenEdges.begin(), hiddenEdges.end(), byDestination);
+    std::sort(outputEdges.begin(), outputEdges.end(), byDestination);
 }
 
-void NeuralNet::setInputActivations(const std::vector<std::pair<NeuronInputType, float>>& activations) {
-    if(activations.size() != inputNeurons.size()) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Activations not provided for every input neuron");
+void NeuralNet::setInputActivation(const size_t inputIndex, const float activation) {
+    if(activation < 0.0f || activation > 1.0f) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR,
+                     "Error on provided activation for Neuron ID: %d"
+                     "\nError: Provided activation is not between 0.0 and 1.0", inputTypes[inputIndex]);
         return;
     }
+    activations[inputIndex] = activation;
+}
 
-    for(auto & [neuronID, activation] : activations) {
-        if(!inputNeurons.contains(neuronID)) {
-            SDL_LogError(SDL_LOG_CATEGORY_ERROR,
-                         "Error on provided activation for Neuron ID: %d"
-                         "\nError: Provided neuron type is not in the neural network", neuronID);
-        }else if(activation < 0.0f || activation > 1.0f) {
-            SDL_LogError(SDL_LOG_CATEGORY_ERROR,
-                         "Error on provided activation for Neuron ID: %d"
-                         "\nError: Provided activation is not between 0.0 and 1.0", neuronID);
-        }else {
-            inputNeurons[neuronID]->activation = activation;
-        }
+std::vector<std::pair<NeuronInputType, float>> NeuralNet::getInputActivations() const {
+    std::vector<std::pair<NeuronInputType, float>> inputActivations;
+    inputActivations.reserve(inputTypes.size());
+    for(size_t i = 0; i < inputTypes.size(); i++) {
+        inputActivations.emplace_back(inputTypes[i], getInputActivation(i));
     }
+    return inputActivations;
 }
 
-std::vector<std::pair<NeuronOutputType, float>> NeuralNet::getOutputActivations() const{
+std::vector<std::pair<NeuronOutputType, float>> NeuralNet::getOutputActivations() const {
     std::vector<std::pair<NeuronOutputType, float>> outputActivations;
-
-    feedForward();
-
-    for(auto & [neuronID, neuronPtr] : outputNeurons) {
-        outputActivations.emplace_back(neuronID, neuronPtr->activation);
+    outputActivations.reserve(outputTypes.size());
+    for(size_t i = 0; i < outputTypes.size(); i++) {
+        outputActivations.emplace_back(outputTypes[i], getOutputActivation(i));
     }
-
     return outputActivations;
 }
 
-std::shared_ptr<Neuron> NeuralNet::getNeuron(
-    const NeuronType type,
-    const uint16_t rawBias) {
-
-    std::shared_ptr<Neuron> neuron{};
-
-    switch(type.index()) {
-        case 0: {
-            const auto& neuronID = std::get<NeuronInputType>(type);
-            if(!inputNeurons.contains(neuronID)) {
-                neuron = createNeuron(type, rawBias);
-            }else {
-                neuron = inputNeurons[neuronID];
-            }
-            break;
-        }
-        case 1: {
-            const auto& neuronID = std::get<NeuronHiddenType>(type);
-            if(!hiddenNeurons.contains(neuronID)) {
-                neuron = createNeuron(type, rawBias);
-            }else {
-                neuron = hiddenNeurons[neuronID];
-            }
-            break;
-        }
-        case 2: {
-            const auto& neuronID = std::get<NeuronOutputType>(type);
-            if(!outputNeurons.contains(neuronID)) {
-                neuron = createNeuron(type, rawBias);
-            }else {
-                neuron = outputNeurons[neuronID];
-            }
-            break;
-        }
-        default: break;
+void NeuralNet::accumulate(const std::vector<Edge>& edges, const std::vector<float>& sourceActivations, std::vector<float>& sums) {
+    for(const Edge& edge : edges) {
+        sums[edge.destination] += sourceActivations[edge.source] * edge.weight;
     }
-    return neuron;
 }
 
-std::shared_ptr<Neuron> NeuralNet::createNeuron(
-    const NeuronType type,
-    const uint16_t rawBias) {
-
-    auto neuron = std::make_shared<Neuron>(convertRawWeightOrBias(rawBias));
-
-    switch(type.index()) {
-        case 0: {
-            inputNeurons[std::get<NeuronInputType>(type)] = neuron;
-            break;
-        }
-        case 1: {
-            hiddenNeurons[std::get<NeuronHiddenType>(type)] = neuron;
-            neuron->prevLayerConnections = std::vector<NeuronConnection>();
-            neuron->prevLayerConnections.value().reserve(10);
-            break;
-        }
-        case 2: {
-            outputNeurons[std::get<NeuronOutputType>(type)] = neuron;
-            neuron->prevLayerConnections = std::vector<NeuronConnection>();
-            neuron->prevLayerConnections.value().reserve(10);
-            break;
-        }
-        default: break;
+/**
+ * Runs one step of the net. Like before it was compiled, each hidden and output neuron adds its weighted inputs
+ * and bias onto its last activation before the sigmoid.
+ * Hidden neurons read each other's activations from the previous step, so the result doesn't depend on neuron order,
+ * outputs read the hidden activations of this step.
+ */
+void NeuralNet::evaluate() {
+    std::copy(activations.begin(), activations.end(), previousActivations.begin());
+
+    for(size_t i = hiddenOffset; i < activations.size(); i++) {
+        activations[i] += biases[i];
     }
-    return neuron;
-}
-
-void NeuralNet::feedForward() const {
-    for(auto& [neuronID, neuronPtr] : hiddenNeurons) {
-        if(neuronPtr->prevLayerConnections.has_value()) {
-            for(NeuronConnection& prevConnection : *neuronPtr->prevLayerConnections) {
-                const float originalActivation = neuronPtr->activation;
-                if(neuronPtr != prevConnection.neuronPtr) {
-                    neuronPtr->activation += prevConnection.neuronPtr->activation * prevConnection.weight;
-                }else { //if the neuron is connected to itself don't use the intermediate activation
-                    neuronPtr->activation += originalActivation * prevConnection.weight;
-                }
-            }
-            neuronPtr->activation += neuronPtr->bias;
-            neuronPtr->activation = sigmoid(neuronPtr->activation);
-        }
+    accumulate(hiddenEdges, previousActivations, activations);
+    for(size_t i = hiddenOffset; i < outputOffset; i++) {
+        activations[i] = sigmoid(activations[i]);
     }
-    for(auto& [neuronID, neuronPtr] : outputNeurons) {
-        if(neuronPtr->prevLayerConnections.has_value()) {
-            for(NeuronConnection& prevConnection : *neuronPtr->prevLayerConnections) {
-                neuronPtr->activation += prevConnection.neuronPtr->activation * prevConnection.weight;
-            }
-            neuronPtr->activation += neuronPtr->bias;
-            neuronPtr->activation = sigmoid(neuronPtr->activation);
-        }
+
+    accumulate(outputEdges, activations, activations);
+    for(size_t i = outputOffset; i < activations.size(); i++) {
+        activations[i] = sigmoid(activations[i]);
     }
-}
\ No newline at end of file
+}
@@ -2,28 +2,54 @@
 #define NEURALNET_HPP
 #include "Genome.hpp"
 #include "Neuron.hpp"
-#include <unordered_map>
+#include <cstdint>
 #include <vector>
-#include <memory>
-#include <variant>
 #include <utility>
 
+/**
+ * A neural net compiled from a genome into flat arrays.
+ * Every neuron that appears in a connection gets one slot in the activation array, laid out as inputs, then hidden neurons, then outputs,
+ * each group in ascending neuron id order. Connections become an edge list sorted by destination.
+ * Evaluating only reads and writes these arrays, nothing is allocated after construction.
+ */
 class NeuralNet {
 public:
     explicit NeuralNet(const Genome::Genome& genome);
     static float sigmoid(float input);
+
+    [[nodiscard]] const std::vector<NeuronInputType>& getInputTypes() const {return inputTypes;}
+    [[nodiscard]] const std::vector<NeuronOutputType>& getOutputTypes() const {return outputTypes;}
+    [[nodiscard]] float getInputActivation(const size_t inputIndex) const {return activations[inputIndex];}
+    void setInputActivation(size_t inputIndex, float activation);
+    [[nodiscard]] float getOutputActivation(const size_t outputIndex) const {return activations[outputOffset + outputIndex];}
+    void evaluate();
+
+    //copies for displaying the net, the simulation reads activations by index instead
     [[nodiscard]] std::vector<std::pair<NeuronInputType, float>> getInputActivations() const;
-    void setInputActivations(const std::vector<std::pair<NeuronInputType, float>>& activations);
     [[nodiscard]] std::vector<std::pair<NeuronOutputType, float>> getOutputActivations() const;
+
 private:
-    using NeuronType = std::variant<NeuronInputType, NeuronHiddenType, NeuronOutputType>;
+    friend class NeuralBatch; //copies the compiled net into its dense rows
+
+    struct Edge {
+        uint16_t source;
+        uint16_t destination;
+        float weight;
+    };
 
     static float convertRawWeightOrBias(uint16_t value);
-    void feedForward() const;
-    std::shared_ptr<Neuron> getNeuron(NeuronType type, uint16_t rawBias);
-    std::shared_ptr<Neuron> createNeuron(NeuronType type, uint16_t rawBias);
-    std::unordered_map<NeuronInputType, std::shared_ptr<Neuron>> inputNeurons;
-    std::unordered_map<NeuronHiddenType, std::shared_ptr<Neuron>> hiddenNeurons;
-    std::unordered_map<NeuronOutputType, std::shared_ptr<Neuron>> outputNeurons;
+    static void accumulate(const std::vector<Edge>& edges, const std::vector<float>& sourceActivations, std::vector<float>& sums);
+
+    std::vector<NeuronInputType> inputTypes;
+    std::vector<NeuronHiddenType> hiddenTypes;
+    std::vector<NeuronOutputType> outputTypes;
+    size_t hiddenOffset = 0;
+    size_t outputOffset = 0;
+
+    std::vector<float> activations;
+    std::vector<float> previousActivations;
+    std::vector<float> biases; //indexed like activations, unused for inputs
+    std::vector<Edge> hiddenEdges; //edges into hidden neurons
+    std::vector<Edge> outputEdges; //edges into output neurons
 };
 #endif //NEURALNET_HPP
@@ -2,9 +2,7 @@
 #define NEURON_HPP
 
 #include <array>
-#include <memory>
-#include <optional>
-#include <vector>
+#include <cstddef>
 
 constexpr std::array<const char*, 10> hiddenValues = {"ZERO","ONE","TWO","THREE","FOUR","FIVE","SIX","SEVEN","EIGHT","NINE"};
 constexpr std::array<const char*, 23> inputValues = {
@@ -42,8 +40,6 @@ inline size_t NEURONHIDDENTYPE_SIZE = hiddenValues.size();
 inline size_t NEURONINPUTTYPE_SIZE = inputValues.size();
 inline size_t NEURONOUTPUTTYPE_SIZE = outputValues.size();
 
-struct Neuron;
-
 enum NeuronHiddenType {
     ZERO,
     ONE,
@@ -91,23 +87,5 @@ enum NeuronOutputType {
     EAT,
 };
 
-struct NeuronConnection {
-    std::shared_ptr<Neuron> neuronPtr;
-    float weight;
-
-    NeuronConnection(
-        const std::shared_ptr<Neuron>& neuronPtr,
-        const float weight)
-    : neuronPtr(neuronPtr), weight(weight){};
-};
-
-struct Neuron {
-    float activation = 0.0f;
-    float bias;
-    std::optional<std::vector<NeuronConnection>> prevLayerConnections;
-
-    explicit Neuron(const float bias) : bias(bias) {}
-};
-
 #endif //NEURON_HPP
 
@@ -2,20 +2,86 @@
 #include "Genome.hpp"
 #include "Traits.hpp"
 #include "NeuralNet.hpp"
+#include "NeuralBatch.hpp"
 #include "UtilityStructs.hpp"
-#include "QuadTree.hpp"
+#include "SpatialIndex.hpp"
 #include "StaticSimObjects.hpp"
 #include "SimObject.hpp"
+#include "EntityStore.hpp"
+#include "RenderSnapshot.hpp"
 #include <array>
+#include <algorithm>
+#include <utility>
 
 void Organism::mutateGenome() {
-    Genome::mutateGenome(&genome);
+    Genome::mutateGenome(&genome, rng);
     neuralNet = NeuralNet(genome);
-    Genome::mutateTraitGenome(&traitGenome);
+    getNeuralBatch().assign(getRow(), neuralNet);
+    Genome::mutateTraitGenome(&traitGenome, rng);
     initTraitValues();
     color = {255, 85, 0, 255};
-    boundingBox.w = 10.0f;
-    boundingBox.h = 10.0f;
+    OrganismComponents& components = getComponents();
+    const size_t row = getRow();
+    components.w[row] = 10.0f;
+    components.h[row] = 10.0f;
+}
+
+Organism::Parent Organism::copyAsParent() const {
+    return {getID(), traitGenome, genome, getFertility(), getPosition()};
+}
+
+Organism::Inheritance Organism::inherit(const Parent& parent1, const Parent& parent2, SimRandom::Stream rng) {
+    //same order the members of a random organism are built in, the trait genome draws first
+    Genome::TraitGenome traitGenome = Genome::createTraitGenomeFromParents(parent1.traitGenome, parent2.traitGenome, rng);
+    Genome::Genome genome = Genome::createGenomeFromParents(parent1.genome, parent2.genome, rng);
+    NeuralNet neuralNet(genome);
+    return {rng, std::move(traitGenome), std::move(genome), std::move(neuralNet)};
+}
+
+OrganismComponents& Organism::getComponents() const {
+    return simState.entitiesPtr->organismComponents;
+}
+
+NeuralBatch& Organism::getNeuralBatch() const {
+    return simState.entitiesPtr->neuralBatch;
+}
+
+/**
+ * @return this organism's row in the components, which moves whenever another organism is erased.
+ */
+size_t Organism::getRow() const {
+    return static_cast<size_t>(simState.entitiesPtr->organisms.indexOf(id));
+}
+
+Vec2 Organism::getVelocity() const {
+    const OrganismComponents& components = getComponents();
+    const size_t row = getRow();
+    return {components.velocityX[row], components.velocityY[row]};
+}
+
+void Organism::setVelocity(const Vec2& newVelocity) {
+    if(abs(newVelocity.x) > velocityMax || abs(newVelocity.y) > velocityMax) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Provided velocity for organism exceeds the maximum");
+        return;
+    }
+    OrganismComponents& components = getComponents();
+    const size_t row = getRow();
+    components.velocityX[row] = newVelocity.x;
+    components.velocityY[row] = newVelocity.y;
+}
+
+uint8_t Organism::getBreath() const {return getComponents().breath[getRow()];}
+uint8_t Organism::getAge() const {return getComponents().age[getRow()];}
+uint8_t Organism::getHunger() const {return getComponents().hunger[getRow()];}
+uint32_t Organism::getEnergy() const {return getComponents().energy[getRow()];}
+bool Organism::shouldReproduce() const {return getComponents().canReproduce[getRow()];}
+
+void Organism::reproduce() {
+    OrganismComponents& components = getComponents();
+    const size_t row = getRow();
+    components.canReproduce[row] = false;
+    reproduced = true;
+    components.energy[row] = components.energy[row] < 100 ? 0 : components.energy[row] - 100;
 }
 
 void Organism::initTraitValues() {
@@ -25,7 +91,7 @@ void Organism::initTraitValues() {
     }
 }
 
-void Organism::updateHeatParams() {
+void Organism::updateHeatParams(OrganismComponents& components, const size_t row) {
     const float tempF = static_cast<float>(temperature) / 255.0f;
 
     const float coldFactor = (1.0f - traitValues[COLD_TOLERANCE]) * std::max(0.5f - tempF, 0.0f);
@@ -33,10 +99,10 @@ void Organism::updateHeatParams() {
     const float factor = 1.0f - (coldFactor + heatFactor);
 
     acceleration = factor * maxAcceleration;
-    hungerStep = std::floor(inverseActivation(factor - 0.5f, maxHungerStep, 6.2f));
+    components.hungerStep[row] = static_cast<uint8_t>(std::floor(inverseActivation(factor - 0.5f, maxHungerStep, 6.2f)));
 }
 
-void Organism::updateAtmosphereParams() {
+void Organism::updateAtmosphereParams(OrganismComponents& components, const size_t row) const {
     const float oxygenSatF = static_cast<float>(oxygenSat) / 255.0f;
     const float hydrogenSatF = static_cast<float>(hydrogenSat) / 255.0f;
 
@@ -46,46 +112,68 @@ void Organism::updateAtmosphereParams() {
     const float oxygenInhale = inhaleStep * oxygenFactor;
     const float hydrogenInhale = inhaleStep * hydrogenFactor;
 
+    uint8_t& breath = components.breath[row];
     if(static_cast<float>(breath) + oxygenInhale < 100.0f) {
         breath += static_cast<uint8_t>(oxygenInhale);
-    }else breath = 100.0f;
+    }else breath = 100;
     if(static_cast<float>(breath) + hydrogenInhale < 100.0f) {
         breath += static_cast<uint8_t>(hydrogenInhale);
-    }else breath = 100.0f;
+    }else breath = 100;
 }
 
-void Organism::grow() {
-    if(energy < growthEnergyThreshold) return;
+void Organism::grow(OrganismComponents& components, const size_t row) const {
+    if(components.energy[row] < growthEnergyThreshold) return;
 
     float newWidth = traitValues[GROWTH] * maxSize.x;
     float newHeight = traitValues[GROWTH] * maxSize.y;
 
-    if(newWidth > boundingBox.w) boundingBox.w = newWidth;
-    if(newHeight > boundingBox.h) boundingBox.h = newHeight;
+    if(newWidth > components.w[row]) components.w[row] = newWidth;
+    if(newHeight > components.h[row]) components.h[row] = newHeight;
 }
 
-void Organism::update(const float deltaTime) {
+/**
+ * Updates this organism's state for the tick and writes its neural net inputs into the batch.
+ * The simulation evaluates the whole batch once every organism has sensed, then each organism acts on its outputs.
+ * @param row this organism's row in the components, passed in since the caller is already iterating them in order.
+ */
+void Organism::sense(const size_t row) {
+    OrganismComponents& components = getComponents();
+    if(components.expired[row]) markedForDeletion = true;
+    if(components.growthDue[row]) grow(components, row);
     if(emitDangerPheromone) emitDangerPheromone = false;
 
-    updateHeatParams();
-    updateAtmosphereParams();
+    updateHeatParams(components, row);
+    updateAtmosphereParams(components, row);
+    updateInputs(components, getNeuralBatch(), row);
+}
 
-    SDL_FRect lastBoundingBox = boundingBox;
+/**
+ * Queues the moves the neural net decided on and tries to eat, the move pass applies the moves after every organism has acted.
+ */
+void Organism::act(const float deltaTime, const size_t row) {
+    updateFromOutputs(getComponents(), getNeuralBatch(), row, deltaTime);
+}
 
-    handleTimer(deltaTime);
+std::vector<std::pair<NeuronInputType, float>> Organism::getInputActivations() const {
+    const NeuralBatch& batch = getNeuralBatch();
+    const size_t row = getRow();
+    std::vector<std::pair<NeuronInputType, float>> activations;
+    activations.reserve(neuralNet.getInputTypes().size());
+    for(const NeuronInputType type : neuralNet.getInputTypes()) activations.emplace_back(type, batch.getInput(row, type));
+    return activations;
+}
 
-    updateInputs();
-    updateFromOutputs(deltaTime);
-    if (lastBoundingBox.x != boundingBox.x || lastBoundingBox.y != boundingBox.y ||
-        lastBoundingBox.w != boundingBox.w || lastBoundingBox.h != boundingBox.h) {
-        simState.quadTreePtr->remove(
-            QuadTree::QuadTreeObject(id, lastBoundingBox));
-        simState.quadTreePtr->insert(QuadTree::QuadTreeObject(id, boundingBox));
-    }
+std::vector<std::pair<NeuronOutputType, float>> Organism::getOutputActivations() const {
+    const NeuralBatch& batch = getNeuralBatch();
+    const size_t row = getRow();
+    std::vector<std::pair<NeuronOutputType, float>> activations;
+    activations.reserve(neuralNet.getOutputTypes().size());
+    for(const NeuronOutputType type : neuralNet.getOutputTypes()) activations.emplace_back(type, batch.getOutput(row, type));
+    return activations;
 }
 
 std::array<SDL_Vertex, 3> Organism::getVelocityDirectionTriangleCoords() const {
-    Vec2 normVelocity = velocity.getNormalizedVector();
+    Vec2 normVelocity = getVelocity().getNormalizedVector();
     std::array<SDL_Vertex, 3> result{};
     Vec2 centerPoint{0,0}, leftPoint{0,0}, rightPoint{0,0};
     float size = 5.0f;
@@ -138,60 +226,87 @@ std::array<SDL_Vertex, 3> Organism::getVelocityDirectionTriangleCoords() const {
     return result;
 }
 
-void Organism::render(SDL_Renderer* rendererPtr) const {
-    SDL_SetRenderDrawColor(rendererPtr, color.r, color.g, color.b, color.a);
-    SDL_RenderFillRect(rendererPtr, &boundingBox);
-
-    std::array<SDL_Vertex, 3> directionTriangle = getVelocityDirectionTriangleCoords();
-    std::array<int, 3> verticesOrder = {1, 0, 2};
-    if(!SDL_RenderGeometry(
-            rendererPtr,
-            NULL,
-            directionTriangle.data(),
-            directionTriangle.size(),
-            verticesOrder.data(),
-            verticesOrder.size()))
-        SDL_Log("%s", SDL_GetError());
+void Organism::addToRenderSnapshot(RenderSnapshot* snapshotPtr) const {
+    SimObject::addToRenderSnapshot(snapshotPtr);
+    const std::array<SDL_Vertex, 3> directionTriangle = getVelocityDirectionTriangleCoords();
+    for(const int vertex : {1, 0, 2}) snapshotPtr->triangles.push_back(directionTriangle[vertex]);
 }
 
-void Organism::handleTimer(const float deltaTime) {
-    if(timer >= 1.00f) {
-        if(deleteSoon) markedForDeletion = true;
-
-        if(hungerStep <= hunger) hunger -= hungerStep;
-        else hunger = 0;
-
-        if(exhaleStep <= breath) breath -= exhaleStep;
-        else breath = 0;
+/**
+ * Advances every organism's timers, the once a second hunger, breath and age counters and the growth timer.
+ * Organisms act on the flags this leaves in expired and growthDue when they next think.
+ */
+void Organism::updateTimers(OrganismComponents& components, const float deltaTime) {
+    const size_t size = components.size();
+    float* timer = components.timer.data();
+    float* growthTimer = components.growthTimer.data();
+    uint8_t* secondElapsed = components.secondElapsed.data();
+    uint8_t* growthDue = components.growthDue.data();
+    for(size_t i = 0; i < size; i++) {
+        secondElapsed[i] = timer[i] >= 1.0f;
+        timer[i] = secondElapsed[i] ? 0.0f : timer[i] + deltaTime;
+        growthDue[i] = growthTimer[i] >= 5.0f;
+        growthTimer[i] = growthDue[i] ? 0.0f : growthTimer[i] + deltaTime;
+    }
 
-        age++;
-        if(age >= reproductionAge && energy >= 200) canReproduce = true;
+    uint8_t* hunger = components.hunger.data();
+    const uint8_t* hungerStep = components.hungerStep.data();
+    uint8_t* breath = components.breath.data();
+    uint8_t* age = components.age.data();
+    uint8_t* deleteSoon = components.deleteSoon.data();
+    uint8_t* expired = components.expired.data();
+    for(size_t i = 0; i < size; i++) {
+        const uint8_t elapsed = secondElapsed[i];
+        expired[i] = elapsed & deleteSoon[i];
+        const uint8_t nextHunger = hungerStep[i] <= hunger[i] ? hunger[i] - hungerStep[i] : 0;
+        const uint8_t nextBreath = exhaleStep <= breath[i] ? breath[i] - exhaleStep : 0;
+        hunger[i] = elapsed ? nextHunger : hunger[i];
+        breath[i] = elapsed ? nextBreath : breath[i];
+        age[i] += elapsed;
+        deleteSoon[i] |= elapsed & ((hunger[i] == 0) | (breath[i] == 0) | (age[i] >= maxAge));
+    }
 
-        if(hunger <= 0 || breath <= 0 || (age >= maxAge)) {
-            deleteSoon = true;
-            //boundingBox.w = 12.0f;
-            //boundingBox.h = 12.0f; //todo some kind of death animation
-            //color = {255, 0, 0, 255};
-        }
+    const uint32_t* energy = components.energy.data();
+    uint8_t* canReproduce = components.canReproduce.data();
+    for(size_t i = 0; i < size; i++) {
+        canReproduce[i] |= secondElapsed[i] & (age[i] >= reproductionAge) & (energy[i] >= 200);
+        growthDue[i] &= energy[i] >= growthEnergyThreshold;
+    }
+}
 
-        timer = 0.0f;
-    }else timer += deltaTime;
-    if(growthTimer >= 5.0f) {
-        if(energy >= growthEnergyThreshold) grow();
-        growthTimer = 0.0f;
-    }else growthTimer += deltaTime;
+void Organism::decayVelocities(OrganismComponents& components) {
+    const size_t size = components.size();
+    float* velocityX = components.velocityX.data();
+    float* velocityY = components.velocityY.data();
+    for(size_t i = 0; i < size; i++) {
+        velocityX[i] *= velocityDecay;
+        velocityY[i] *= velocityDecay;
+    }
 }
 
-void Organism::fixedUpdate() {
-    velocity.x *= velocityDecay;
-    velocity.y *= velocityDecay;
+/**
+ * Moves every organism by the velocities it queued while thinking.
+ */
+void Organism::applyMoves(OrganismComponents& components, const float deltaTime) {
+    const size_t size = components.size();
+    float* x = components.x.data();
+    float* y = components.y.data();
+    float* moveX = components.moveX.data();
+    float* moveY = components.moveY.data();
+    for(size_t i = 0; i < size; i++) {
+        x[i] += moveX[i] * deltaTime;
+        y[i] += moveY[i] * deltaTime;
+        moveX[i] = 0.0f;
+        moveY[i] = 0.0f;
+    }
 }
 
-void Organism::updateInputs() {
-    std::vector<std::pair<NeuronInputType, float>> activations = neuralNet.getInputActivations();
-    for(auto & [neuronID, activation] : activations) {
+void Organism::updateInputs(const OrganismComponents& components, NeuralBatch& batch, const size_t row) {
+    for(const NeuronInputType neuronID : neuralNet.getInputTypes()) {
+        float activation = batch.getInput(row, neuronID);
         switch(neuronID) {
             case HUNGER: {
+                const uint8_t hunger = components.hunger[row];
                 if(hunger > 0) activation = ((-0.01f) * static_cast<float>(hunger)) + 1;
                 break;
             }
@@ -199,31 +314,31 @@ void Organism::updateInputs() {
             case BOUNDS_RIGHT:
             case BOUNDS_UP:
             case BOUNDS_DOWN:
-                activation = checkBounds(neuronID);
+                activation = checkBounds(components, row, neuronID);
                 break;
             case FOOD_LEFT:
             case FOOD_RIGHT:
             case FOOD_UP:
             case FOOD_DOWN:
-                activation = std::max(findNearby<FoodSpawnRange>(neuronID), findNearby<FoodSpawnRange>(neuronID, true));
+                activation = std::max(findNearby(EntityKind::FOOD_SPAWN_RANGE, neuronID), findNearby(EntityKind::FOOD_SPAWN_RANGE, neuronID, true));
                 break;
             case FOOD_COLLISION:
-                activation = isColliding<Food>() ? 1.0f : 0.0f;
+                activation = isColliding(EntityKind::FOOD) ? 1.0f : 0.0f;
                 break;
             case ORGANISM_LEFT:
             case ORGANISM_RIGHT:
             case ORGANISM_UP:
             case ORGANISM_DOWN:
-                activation = std::max(findNearby<Organism>(neuronID), findNearby<Organism>(neuronID, true));
+                activation = std::max(findNearby(EntityKind::ORGANISM, neuronID), findNearby(EntityKind::ORGANISM, neuronID, true));
                 break;
             case ORGANISM_COLLISION:
-                activation = isColliding<Organism>() ? 1.0 : 0.0f;
+                activation = isColliding(EntityKind::ORGANISM) ? 1.0 : 0.0f;
                 break;
             case FIRE_LEFT:
             case FIRE_RIGHT:
             case FIRE_UP:
             case FIRE_DOWN:
-                activation = std::max(findNearby<Fire>(neuronID), findNearby<Fire>(neuronID, true));
+                activation = std::max(findNearby(EntityKind::FIRE, neuronID), findNearby(EntityKind::FIRE, neuronID, true));
                 break;
             case DETECT_DANGER_PHEROMONE: {
                 activation = detectedDangerPheromone ? 1.0f : 0.0f;
@@ -243,39 +358,37 @@ void Organism::updateInputs() {
                 activation = 0.00f;
                 break;
         }
+        batch.setInput(row, neuronID, activation);
     }
-    neuralNet.setInputActivations(activations);
 }
 
-void Organism::updateFromOutputs(const float deltaTime) {
-    for(auto & [neuronID, activation] : neuralNet.getOutputActivations()) {
+void Organism::updateFromOutputs(OrganismComponents& components, const NeuralBatch& batch, const size_t row, const float deltaTime) {
+    for(const NeuronOutputType neuronID : neuralNet.getOutputTypes()) {
+        const float activation = batch.getOutput(row, neuronID);
+        Vec2 moveVelocity(components.velocityX[row], components.velocityY[row]);
         switch(neuronID) {
             case MOVE_LEFT: {
-                Vec2 moveVelocity = velocity;
                 moveVelocity.x += -activation * acceleration * traitValues[Traits::SPEED] * deltaTime;
-                move(moveVelocity, deltaTime);
+                move(components, row, moveVelocity);
                 break;
             }
             case MOVE_RIGHT: {
-                Vec2 moveVelocity = velocity;
                 moveVelocity.x += activation * acceleration * traitValues[Traits::SPEED] * deltaTime;
-                move(moveVelocity, deltaTime);
+                move(components, row, moveVelocity);
                 break;
             }
             case MOVE_UP: {
-                Vec2 moveVelocity = velocity;
                 moveVelocity.y += -activation * acceleration * traitValues[Traits::SPEED] * deltaTime;
-                move(moveVelocity, deltaTime);
+                move(components, row, moveVelocity);
                 break;
             }
             case MOVE_DOWN: {
-                Vec2 moveVelocity = velocity;
                 moveVelocity.y += activation * acceleration * traitValues[Traits::SPEED] * deltaTime;
-                move(moveVelocity, deltaTime);
+                move(components, row, moveVelocity);
                 break;
             }
             case EAT: {
-                tryEat(activation);
+                tryEat(components, row, activation);
                 break;
             }
             default: break;
@@ -283,40 +396,28 @@ void Organism::updateFromOutputs(const float deltaTime) {
     }
 }
 
-void Organism::move(const Vec2& moveVelocity, const float deltaTime) {
+void Organism::move(OrganismComponents& components, const size_t row, const Vec2& moveVelocity) {
     if(abs(moveVelocity.x) <= velocityMax && abs(moveVelocity.y) <= velocityMax) {
-        velocity = moveVelocity;
-        boundingBox.x += moveVelocity.x * deltaTime;
-        boundingBox.y += moveVelocity.y * deltaTime;
+        components.velocityX[row] = moveVelocity.x;
+        components.velocityY[row] = moveVelocity.y;
+        components.moveX[row] += moveVelocity.x;
+        components.moveY[row] += moveVelocity.y;
     }
 }
 
-template<typename SimObjectType>
-bool Organism::isColliding() const {
-    for(const auto collisionID : collisionIDs) {
-        std::shared_ptr<SimObject> basePtr = (*simState.getFuncPtr)(collisionID);
-        if(basePtr) {
-            SimObject& baseObject = *basePtr;
-            if(typeid(SimObjectType) == typeid(baseObject)) return true;
-        }
-    }
-    return false;
+bool Organism::isColliding(const EntityKind kind) const {
+    return std::any_of(collisions.begin(), collisions.end(),
+        [kind](const std::pair<uint64_t, EntityKind>& collision) {return collision.second == kind;});
 }
 
-template<typename SimObjectType>
-float Organism::findNearby(NeuronInputType neuronID, const bool useRaycast) {
-    if(useRaycast && raycastNeighbors.empty()) return 0.0f;
-    if(!useRaycast && neighbors.empty()) return 0.0f;
-    const std::vector<std::pair<uint64_t, Vec2>>* searchObjectsPtr;
-    if(useRaycast) searchObjectsPtr = &raycastNeighbors;
-    else searchObjectsPtr = &neighbors;
+float Organism::findNearby(const EntityKind kind, NeuronInputType neuronID, const bool useRaycast) {
+    const std::span<const SpatialIndex::Neighbor> searchObjects = useRaycast ? raycastNeighbors : neighbors;
+    if(searchObjects.empty()) return 0.0f;
 
     float distance = NAN;
 
-    for(const auto& [neighborID, neighborDistance] : *searchObjectsPtr) {
-        std::shared_ptr<SimObject> basePtr = (*simState.getFuncPtr)(neighborID);
-        std::shared_ptr<SimObjectType> derivedPtr = std::dynamic_pointer_cast<SimObjectType>(basePtr);
-        if(!derivedPtr) continue;
+    for(const auto& [neighborID, neighborKind, neighborDistance] : searchObjects) {
+        if(neighborKind != kind) continue;
         switch(neuronID) {
             case ORGANISM_LEFT:
             case FOOD_LEFT:
@@ -348,15 +449,14 @@ float Organism::findNearby(NeuronInputType neuronID, const bool useRaycast) {
     }
     if(std::isnan(distance)) return 0.0f;
 
-    if constexpr(std::is_same_v<SimObjectType, Fire>) {
-        if(!useRaycast) emitDangerPheromone = distance <= 20.0f;
-    }
+    if(kind == EntityKind::FIRE && !useRaycast) emitDangerPheromone = distance <= 20.0f;
 
     return inverseActivation(distance, 1.0f, useRaycast ? 0.007f : 0.05f); //values approaching 0 result in values closer to 1.
 }
 
-float Organism::checkBounds(NeuronInputType neuronID) const {
+float Organism::checkBounds(const OrganismComponents& components, const size_t row, NeuronInputType neuronID) const {
     float distance;
+    const SDL_FRect boundingBox = components.getBoundingBox(row);
 
     switch(neuronID) {
         case BOUNDS_LEFT:
@@ -379,11 +479,13 @@ float Organism::checkBounds(NeuronInputType neuronID) const {
     return inverseActivation(distance, 1.0f, 0.05f); //values approaching 0 result in values closer to 1.
 }
 
-void Organism::tryEat(const float activation) {
+void Organism::tryEat(OrganismComponents& components, const size_t row, const float activation) {
     const int threshold = static_cast<int>(activation * 100.0f);
-    for (const uint64_t collisionID : collisionIDs) {
-        std::shared_ptr<SimObject> objectPtr = (*simState.getFuncPtr)(collisionID);
-        std::shared_ptr<Food> foodPtr = std::dynamic_pointer_cast<Food>(objectPtr);
+    uint8_t& hunger = components.hunger[row];
+    uint32_t& energy = components.energy[row];
+    for (const auto& [collisionID, collisionKind] : collisions) {
+        if(collisionKind != EntityKind::FOOD) continue;
+        Food* foodPtr = simState.entitiesPtr->foods.get(collisionID);
         if (foodPtr && !foodPtr->shouldDelete() && hunger < threshold) {
             hunger += foodPtr->getNutritionalValue();
             energy += foodPtr->getNutritionalValue();
@@ -4,8 +4,11 @@
 #include "Genome.hpp"
 #include "Traits.hpp"
 #include "NeuralNet.hpp"
+#include "NeuralBatch.hpp"
 #include "SimObject.hpp"
 #include "SimUtils.hpp"
+#include "SimRandom.hpp"
+#include "OrganismComponents.hpp"
 #include "UtilityStructs.hpp"
 #include "SDL3/SDL.h"
 #include <vector>
@@ -13,6 +16,7 @@
 #include <utility>
 #include <map>
 #include <array>
+#include <span>
 
 class Organism : public SimObject{
 public:
@@ -21,86 +25,116 @@ public:
         const SDL_Color& initialColor,
         const SDL_FRect& boundingBox,
         const SimUtils::SimState& simState,
+        const SimRandom::Stream& rng,
         const bool inQuadTree)
-        : SimObject(id, boundingBox, initialColor, simState, inQuadTree),
-          genome(Genome::createRandomGenome(genomeSize)),
-          traitGenome(Genome::createRandomTraitGenome()),
+        : SimObject(id, EntityKind::ORGANISM, boundingBox, initialColor, simState, inQuadTree),
+          rng(rng),
+          genome(Genome::createRandomGenome(genomeSize, this->rng)),
+          traitGenome(Genome::createRandomTraitGenome(this->rng)),
           neuralNet(genome) {initTraitValues();}
 
+    /**
+     * Everything a child inherits, built apart from the organism so children can be bred on worker threads
+     * before the store hands out their ids.
+     */
+    struct Inheritance {
+        SimRandom::Stream rng; //advanced past the crossover, the child keeps drawing from it
+        Genome::TraitGenome traitGenome;
+        Genome::Genome genome;
+        NeuralNet neuralNet;
+    };
+
+    /**
+     * What breeding needs from a parent, copied when the parent is picked so it can still breed if it dies before
+     * the next generation is created.
+     */
+    struct Parent {
+        uint64_t id;
+        Genome::TraitGenome traitGenome;
+        Genome::Genome genome;
+        float fertility;
+        Vec2 position;
+        bool bred = false; //already had children this generation
+    };
+
+    [[nodiscard]] Parent copyAsParent() const;
+
+    /**
+     * Crosses the parents' genomes and compiles the child's neural net, only reads the parents so children of the
+     * same parents can be bred at once.
+     */
+    static Inheritance inherit(const Parent& parent1, const Parent& parent2, SimRandom::Stream rng);
+
     Organism(const uint64_t id,
-        const Organism& parent1,
-        const Organism& parent2,
+        Inheritance&& inheritance,
         const SDL_Color& initialColor,
         const SDL_FRect& boundingBox,
         const SimUtils::SimState& simState,
         const bool inQuadTree)
-        : SimObject(id, boundingBox, initialColor, simState, inQuadTree),
-          genome(Genome::createGenomeFromParents(parent1.genome, parent2.genome)),
-          traitGenome(Genome::createTraitGenomeFromParents(parent1.traitGenome, parent2.traitGenome)),
-          neuralNet(genome) {initTraitValues();}
+        : SimObject(id, EntityKind::ORGANISM, boundingBox, initialColor, simState, inQuadTree),
+          rng(inheritance.rng),
+          traitGenome(std::move(inheritance.traitGenome)),
+          genome(std::move(inheritance.genome)),
+          neuralNet(std::move(inheritance.neuralNet)) {initTraitValues();}
 
     void mutateGenome();
-    [[nodiscard]] std::vector<std::pair<NeuronInputType, float>> getInputActivations() const {return neuralNet.getInputActivations();}
-    [[nodiscard]] std::vector<std::pair<NeuronOutputType, float>> getOutputActivations() const {return neuralNet.getOutputActivations();}
+    [[nodiscard]] const NeuralNet& getNeuralNet() const {return neuralNet;}
+    [[nodiscard]] std::vector<std::pair<NeuronInputType, float>> getInputActivations() const;
+    [[nodiscard]] std::vector<std::pair<NeuronOutputType, float>> getOutputActivations() const;
     [[nodiscard]] std::array<float, TRAITS_SIZE> getTraitValues() const {return traitValues;}
 
     static constexpr float velocityMax = 50.0f;
     static constexpr float velocityDecay = 0.9f;
 
-    void addRaycastNeighbors(const std::vector<std::pair<uint64_t, Vec2>>& newRaycastNeighbors) {raycastNeighbors = newRaycastNeighbors;}
-    void addNeighbors(const std::vector<std::pair<uint64_t, Vec2>>& newNeighbors) {neighbors = newNeighbors;}
-    void addNeighbor(const std::pair<uint64_t, Vec2>& newNeighbor) {neighbors.emplace_back(newNeighbor);}
-    void addCollisionID(const uint64_t collisionID) {collisionIDs.push_back(collisionID);}
-    void clearCollisionIDs() {collisionIDs.clear();}
-    [[nodiscard]] Vec2 getVelocity() const {return velocity;}
-    void setVelocity(const Vec2& newVelocity) {
-        if(abs(newVelocity.x) > velocityMax || abs(newVelocity.y) > velocityMax) {
-            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Provided velocity for organism exceeds the maximum");
-            return;
-        }
-        velocity = newVelocity;
+    /**
+     * The spans point into the simulation's current neighbor results and must be cleared before those are released.
+     */
+    void setNeighbors(const std::span<const SpatialIndex::Neighbor> newNeighbors, const std::span<const SpatialIndex::Neighbor> newRaycastNeighbors) {
+        neighbors = newNeighbors;
+        raycastNeighbors = newRaycastNeighbors;
     }
+    void clearNeighbors() {neighbors = {}; raycastNeighbors = {};}
+    void addCollision(const uint64_t collisionID, const EntityKind collisionKind) {collisions.emplace_back(collisionID, collisionKind);}
+    void clearCollisions() {collisions.clear();}
+    [[nodiscard]] Vec2 getVelocity() const;
+    void setVelocity(const Vec2& newVelocity);
     void setDetectedDangerPheromone(const bool isDetected) {detectedDangerPheromone = isDetected;}
     [[nodiscard]] bool isEmittingDangerPheromone() const {return emitDangerPheromone;}
     [[nodiscard]] float getFertility() const {return traitValues[Traits::FERTILITY];}
     [[nodiscard]] uint8_t getTemperature() const {return temperature;}
     void setTemperature(const uint8_t newTemperature) {temperature = newTemperature;}
-    [[nodiscard]] uint8_t getBreath() {return breath;}
+    [[nodiscard]] uint8_t getBreath() const;
     [[nodiscard]] float getOxygenSat() const {return oxygenSat;}
     void setOxygenSat(const float newOxygenSat) {oxygenSat = newOxygenSat;}
     [[nodiscard]] float getHydrogenSat() const {return hydrogenSat;}
     void setHydrogenSat(const float newHydrogenSat) {hydrogenSat = newHydrogenSat;}
-    [[nodiscard]] uint8_t getAge() const {return age;}
-    [[nodiscard]] uint8_t getHunger() const {return hunger;}
-    [[nodiscard]] uint32_t getEnergy() const {return energy;}
-    [[nodiscard]] bool shouldReproduce() const {return canReproduce;}
-    void reproduce() {canReproduce = false; reproduced = true; energy = energy < 100 ? 0 : energy - 100;}
-    void update(float deltaTime) override;
-    void fixedUpdate() override;
-    void render(SDL_Renderer* rendererPtr) const override;
+    [[nodiscard]] uint8_t getAge() const;
+    [[nodiscard]] uint8_t getHunger() const;
+    [[nodiscard]] uint32_t getEnergy() const;
+    [[nodiscard]] bool shouldReproduce() const;
+    void reproduce();
+    void sense(size_t row);
+    void act(float deltaTime, size_t row);
+    void addToRenderSnapshot(RenderSnapshot* snapshotPtr) const override;
+
+    static void decayVelocities(OrganismComponents& components);
+    static void updateTimers(OrganismComponents& components, float deltaTime);
+    static void applyMoves(OrganismComponents& components, float deltaTime);
 
 private:
+    SimRandom::Stream rng; //owned by this organism alone, declared first so it is ready before the genomes are built
     Genome::TraitGenome traitGenome;
     std::array<float, TRAITS_SIZE> traitValues{};
     Genome::Genome genome;
     NeuralNet neuralNet;
+    //velocity, size, hunger, energy, breath, age and timers live in the simulation's OrganismComponents
     float acceleration = 10.0f;
-    Vec2 velocity = {0.0f, 0.0f};
-    uint8_t hunger = 100;
-    uint8_t hungerStep = 0;
-    uint32_t energy = 0;
-    uint8_t age = 0;
     uint8_t temperature = 128;
-    uint8_t breath = 100;
     float oxygenSat = 0.0f;
     float hydrogenSat = 0.0f;
-    bool canReproduce = false;
     bool reproduced = false;
     bool detectedDangerPheromone = false;
     bool emitDangerPheromone = false;
-    bool deleteSoon = false;
-    float timer = 0.0f;
-    float growthTimer = 0.0f;
 
     static constexpr Vec2 maxSize{25.0f, 25.0f};
     static constexpr uint8_t reproductionAge = 5;
@@ -111,25 +145,28 @@ private:
     static constexpr uint8_t inhaleStep = 30;
     static constexpr uint8_t exhaleStep = 10;
 
-    std::vector<std::pair<uint64_t, Vec2>> neighbors;
-    std::vector<std::pair<uint64_t, Vec2>> raycastNeighbors;
-    std::vector<uint64_t> collisionIDs{};
+    std::span<const SpatialIndex::Neighbor> neighbors;
+    std::span<const SpatialIndex::Neighbor> raycastNeighbors;
+    std::vector<std::pair<uint64_t, EntityKind>> collisions{};
+
+    [[nodiscard]] OrganismComponents& getComponents() const;
+    [[nodiscard]] NeuralBatch& getNeuralBatch() const;
+    [[nodiscard]] size_t getRow() const;
 
     void initTraitValues();
-    void grow();
-    void updateHeatParams();
-    void updateAtmosphereParams();
+    void grow(OrganismComponents& components, size_t row) const;
+    void updateHeatParams(OrganismComponents& components, size_t row);
+    void updateAtmosphereParams(OrganismComponents& components, size_t row) const;
 
-    void handleTimer(float deltaTime);
-    void updateInputs();
-    void updateFromOutputs(float deltaTime);
+    void updateInputs(const OrganismComponents& components, NeuralBatch& batch, size_t row);
+    void updateFromOutputs(OrganismComponents& components, const NeuralBatch& batch, size_t row, float deltaTime);
 
 
-    void move(const Vec2& moveVelocity, const float deltaTime);
-    template<typename SimObjectType> bool isColliding() const;
-    template<typename SimObjectType> float findNearby(NeuronInputType neuronID, bool useRaycast = false);
-    float checkBounds(NeuronInputType neuronID) const;
-    void tryEat(float activation);
+    static void move(OrganismComponents& components, size_t row, const Vec2& moveVelocity);
+    [[nodiscard]] bool isColliding(EntityKind kind) const;
+    float findNearby(EntityKind kind, NeuronInputType neuronID, bool useRaycast = false);
+    float checkBounds(const OrganismComponents& components, size_t row, NeuronInputType neuronID) const;
+    void tryEat(OrganismComponents& components, size_t row, float activation);
     std::array<SDL_Vertex, 3> getVelocityDirectionTriangleCoords() const;
     static float inverseActivation(float value, float rootPos, float strictness) {return (rootPos * 2.0f) / (1.0f + std::exp(value * strictness));}
 };
@@ -0,0 +1,93 @@
+#ifndef ORGANISMCOMPONENTS_HPP
+#define ORGANISMCOMPONENTS_HPP
+
+#include "SDL3/SDL.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * The per-tick numeric state of every organism, one array per field.
+ * Row i belongs to the organism at dense index i of the organism slot map, rows are added and
+ * swap-removed together with the organisms so the two stay aligned.
+ * Keeping these fields in contiguous arrays lets the kinematics and timer passes run as plain loops the compiler vectorizes.
+ */
+struct OrganismComponents {
+    //bounding box, the organism's SimObject bounding box is synced from these once per update
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> w;
+    std::vector<float> h;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    //sum of the velocities the organism moved with this update, applied to x/y by the move pass
+    std::vector<float> moveX;
+    std::vector<float> moveY;
+    std::vector<float> timer;
+    std::vector<float> growthTimer;
+    std::vector<uint32_t> energy;
+    std::vector<uint8_t> hunger;
+    std::vector<uint8_t> hungerStep;
+    std::vector<uint8_t> breath;
+    std::vector<uint8_t> age;
+    std::vector<uint8_t> canReproduce;
+    std::vector<uint8_t> deleteSoon;
+    //set by the timer and bounds passes, consumed later in the same update
+    std::vector<uint8_t> secondElapsed;
+    std::vector<uint8_t> expired;
+    std::vector<uint8_t> growthDue;
+    std::vector<uint8_t> clamped;
+
+    void push(const SDL_FRect& boundingBox) {
+        x.push_back(boundingBox.x);
+        y.push_back(boundingBox.y);
+        w.push_back(boundingBox.w);
+        h.push_back(boundingBox.h);
+        velocityX.push_back(0.0f);
+        velocityY.push_back(0.0f);
+        moveX.push_back(0.0f);
+        moveY.push_back(0.0f);
+        timer.push_back(0.0f);
+        growthTimer.push_back(0.0f);
+        energy.push_back(0);
+        hunger.push_back(100);
+        hungerStep.push_back(0);
+        breath.push_back(100);
+        age.push_back(0);
+        canReproduce.push_back(false);
+        deleteSoon.push_back(false);
+        secondElapsed.push_back(false);
+        expired.push_back(false);
+        growthDue.push_back(false);
+        clamped.push_back(false);
+    }
+
+    /**
+     * Removes a row the same way SlotMap::eraseAt removes a value, by moving the last row into its place.
+     */
+    void eraseAt(const size_t row) {
+        forEachColumn([row](auto& column) {
+            column[row] = column.back();
+            column.pop_back();
+        });
+    }
+
+    void reserve(const size_t capacity) {
+        forEachColumn([capacity](auto& column) {column.reserve(capacity);});
+    }
+    [[nodiscard]] size_t size() const {return x.size();}
+
+    [[nodiscard]] SDL_FRect getBoundingBox(const size_t row) const {return {x[row], y[row], w[row], h[row]};}
+
+private:
+    template<typename Func>
+    void forEachColumn(Func&& func) {
+        func(x); func(y); func(w); func(h);
+        func(velocityX); func(velocityY); func(moveX); func(moveY);
+        func(timer); func(growthTimer); func(energy);
+        func(hunger); func(hungerStep); func(breath); func(age);
+        func(canReproduce); func(deleteSoon);
+        func(secondElapsed); func(expired); func(growthDue); func(clamped);
+    }
+};
+
+#endif //ORGANISMCOMPONENTS_HPP
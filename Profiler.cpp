@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include "SDL3/SDL.h"
+#include "Profiler.hpp"
+
+TickProfiler::LapTimer::~LapTimer() {
+    if(!profilerPtr) return;
+    for(size_t i = 0; i < laps.size(); i++) {
+        if(laps[i] > 0) profilerPtr->addTime(static_cast<ProfilerPhase>(i), laps[i]);
+    }
+}
+
+TickProfiler::TickProfiler(const size_t windowSize) :
+    windowSize(windowSize > 0 ? windowSize : 1),
+    counterTicksToMs(1000.0 / static_cast<double>(SDL_GetPerformanceFrequency())),
+    lastFrameEnd(SDL_GetPerformanceCounter()) {}
+
+const char* TickProfiler::getPhaseName(const ProfilerPhase phase) {
+    switch(phase) {
+        case ProfilerPhase::FIXED_UPDATE: return "fixed_update";
+        case ProfilerPhase::TIMERS: return "timers";
+        case ProfilerPhase::MAP_VALUES: return "map_values";
+        case ProfilerPhase::OBJECT_UPDATE: return "object_update";
+        case ProfilerPhase::NEURAL_NET: return "neural_net";
+        case ProfilerPhase::PARENTS: return "add_parents";
+        case ProfilerPhase::PHEROMONES: return "pheromones";
+        case ProfilerPhase::BOUNDS: return "check_bounds";
+        case ProfilerPhase::DELETION: return "deletion";
+        case ProfilerPhase::COLLISIONS: return "collisions";
+        case ProfilerPhase::NEIGHBOR_TASK: return "neighbor_task";
+        case ProfilerPhase::RENDER_SNAPSHOT: return "render_snapshot";
+        case ProfilerPhase::LAYOUT: return "layout";
+        case ProfilerPhase::RENDER: return "render";
+        default: return "unknown";
+    }
+}
+
+/**
+ * Starts streaming one row per frame to a csv file, the file is truncated if it already exists.
+ * @return false if the file couldn't be opened.
+ */
+bool TickProfiler::openCSV(const std::string& path) {
+    csvFile.open(path, std::ios::out | std::ios::trunc);
+    if(!csvFile.is_open()) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to open profiler csv file %s", path.c_str());
+        return false;
+    }
+
+    csvFile << "frame,frame_ms,population";
+    for(size_t i = 0; i < static_cast<size_t>(ProfilerPhase::SIZE); i++) {
+        csvFile << ',' << getPhaseName(static_cast<ProfilerPhase>(i)) << "_ms";
+    }
+    csvFile << '\n';
+    return true;
+}
+
+void TickProfiler::addTime(const ProfilerPhase phase, const uint64_t counterTicks) {
+    accumulated[static_cast<size_t>(phase)].fetch_add(counterTicks, std::memory_order_relaxed);
+    timesRun[static_cast<size_t>(phase)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TickProfiler::History::push(const float sample, const size_t windowSize) {
+    if(samples.size() < windowSize) {
+        samples.push_back(sample);
+    }else {
+        samples[next] = sample;
+    }
+    next = (next + 1) % windowSize;
+}
+
+/**
+ * Moves the time accumulated since the last call into the rolling windows and the csv file.
+ * Phases that didn't run this frame (e.g. fixedUpdate on frames between fixed steps) don't add a sample.
+ */
+void TickProfiler::endFrame(const uint32_t population) {
+    const uint64_t now = SDL_GetPerformanceCounter();
+    const auto frameMs = static_cast<float>(static_cast<double>(now - lastFrameEnd) * counterTicksToMs);
+    lastFrameEnd = now;
+    if(!isEnabled()) return;
+
+    frameHistory.push(frameMs, windowSize);
+    if(csvFile.is_open()) csvFile << frameNum << ',' << frameMs << ',' << population;
+
+    for(size_t i = 0; i < static_cast<size_t>(ProfilerPhase::SIZE); i++) {
+        const uint64_t counterTicks = accumulated[i].exchange(0, std::memory_order_relaxed);
+        const uint32_t runs = timesRun[i].exchange(0, std::memory_order_relaxed);
+        const auto phaseMs = static_cast<float>(static_cast<double>(counterTicks) * counterTicksToMs);
+        if(runs > 0) phaseHistory[i].push(phaseMs, windowSize);
+        if(csvFile.is_open()) csvFile << ',' << phaseMs;
+    }
+    if(csvFile.is_open()) csvFile << '\n';
+    frameNum++;
+}
+
+TickProfiler::PhaseStats TickProfiler::computeStats(const History& history) {
+    PhaseStats stats;
+    if(history.samples.empty()) return stats;
+
+    std::vector<float> sorted = history.samples;
+    const size_t p99Index = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(sorted.size()))) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<long>(p99Index), sorted.end());
+
+    double sum = 0.0;
+    float min = sorted.front();
+    for(const float sample : sorted) {
+        sum += sample;
+        min = std::min(min, sample);
+    }
+    stats.minMs = min;
+    stats.avgMs = sum / static_cast<double>(sorted.size());
+    stats.p99Ms = sorted[p99Index];
+    return stats;
+}
+
+TickProfiler::PhaseStats TickProfiler::getStats(const ProfilerPhase phase) const {
+    return computeStats(phaseHistory[static_cast<size_t>(phase)]);
+}
+
+/**
+ * @return one "name min/avg/p99" line per phase that has run, in milliseconds.
+ */
+std::string TickProfiler::getSummary() const {
+    std::stringstream summaryStream;
+    summaryStream << std::fixed << std::setprecision(2) << "ms min/avg/p99";
+    const PhaseStats frameStats = getFrameStats();
+    summaryStream << "\nframe " << frameStats.minMs << '/' << frameStats.avgMs << '/' << frameStats.p99Ms;
+
+    for(size_t i = 0; i < static_cast<size_t>(ProfilerPhase::SIZE); i++) {
+        if(phaseHistory[i].samples.empty()) continue;
+        const PhaseStats stats = computeStats(phaseHistory[i]);
+        summaryStream << '\n' << getPhaseName(static_cast<ProfilerPhase>(i)) << ' ' <<
+            stats.minMs << '/' << stats.avgMs << '/' << stats.p99Ms;
+    }
+    return summaryStream.str();
+}
@@ -0,0 +1,134 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include "SDL3/SDL.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum class ProfilerPhase : uint8_t {
+    FIXED_UPDATE,
+    TIMERS, //handleTimers, includes creating the next generation
+    MAP_VALUES, //setMapVals
+    OBJECT_UPDATE,
+    NEURAL_NET, //batched evaluation of every organism's neural net
+    PARENTS,
+    PHEROMONES,
+    BOUNDS,
+    DELETION, //sweep of the objects marked for deletion
+    COLLISIONS,
+    NEIGHBOR_TASK, //runs on the thread pool alongside the other phases
+    RENDER_SNAPSHOT, //copying what's drawn out of the simulation, on the simulation thread
+    LAYOUT,
+    RENDER,
+    SIZE
+};
+
+/**
+ * Accumulates the time spent in each phase of a frame and keeps min/avg/p99 over the last frames.
+ * Phases can be timed from any thread, endFrame and the stats getters must be called from one thread.
+ */
+class TickProfiler {
+public:
+    struct PhaseStats {
+        double minMs = 0.0;
+        double avgMs = 0.0;
+        double p99Ms = 0.0;
+    };
+
+    /**
+     * Times the enclosing scope into one phase.
+     */
+    class ScopedTimer {
+    public:
+        ScopedTimer(TickProfiler* profilerPtr, const ProfilerPhase phase) :
+            profilerPtr(profilerPtr && profilerPtr->isEnabled() ? profilerPtr : nullptr),
+            phase(phase),
+            start(this->profilerPtr ? SDL_GetPerformanceCounter() : 0) {}
+        ~ScopedTimer() {
+            if(profilerPtr) profilerPtr->addTime(phase, SDL_GetPerformanceCounter() - start);
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        TickProfiler* profilerPtr;
+        ProfilerPhase phase;
+        uint64_t start;
+    };
+
+    /**
+     * Splits a loop body into consecutive phases with one counter read per phase,
+     * laps are summed locally and handed to the profiler once when the timer goes out of scope.
+     */
+    class LapTimer {
+    public:
+        explicit LapTimer(TickProfiler* profilerPtr) :
+            profilerPtr(profilerPtr && profilerPtr->isEnabled() ? profilerPtr : nullptr),
+            last(this->profilerPtr ? SDL_GetPerformanceCounter() : 0) {}
+        ~LapTimer();
+        LapTimer(const LapTimer&) = delete;
+        LapTimer& operator=(const LapTimer&) = delete;
+
+        void lap(ProfilerPhase phase) {
+            if(!profilerPtr) return;
+            const uint64_t now = SDL_GetPerformanceCounter();
+            laps[static_cast<size_t>(phase)] += now - last;
+            last = now;
+        }
+        //restarts the current lap without counting the time since the last one
+        void skip() {
+            if(profilerPtr) last = SDL_GetPerformanceCounter();
+        }
+
+    private:
+        TickProfiler* profilerPtr;
+        uint64_t last;
+        std::array<uint64_t, static_cast<size_t>(ProfilerPhase::SIZE)> laps{};
+    };
+
+    /**
+     * @param windowSize the amount of frames min/avg/p99 are computed over.
+     */
+    explicit TickProfiler(size_t windowSize = 300);
+
+    void setEnabled(const bool setEnabled) {enabled.store(setEnabled, std::memory_order_relaxed);}
+    [[nodiscard]] bool isEnabled() const {return enabled.load(std::memory_order_relaxed);}
+    [[nodiscard]] bool isWritingCSV() const {return csvFile.is_open();}
+    bool openCSV(const std::string& path);
+
+    void addTime(ProfilerPhase phase, uint64_t counterTicks);
+    void endFrame(uint32_t population);
+
+    [[nodiscard]] PhaseStats getStats(ProfilerPhase phase) const;
+    [[nodiscard]] PhaseStats getFrameStats() const {return computeStats(frameHistory);}
+    [[nodiscard]] std::string getSummary() const;
+    static const char* getPhaseName(ProfilerPhase phase);
+
+private:
+    //rolling window of milliseconds, oldest sample overwritten first
+    struct History {
+        std::vector<float> samples;
+        size_t next = 0;
+
+        void push(float sample, size_t windowSize);
+    };
+
+    const size_t windowSize;
+    const double counterTicksToMs;
+    std::atomic<bool> enabled = false;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(ProfilerPhase::SIZE)> accumulated{};
+    std::array<std::atomic<uint32_t>, static_cast<size_t>(ProfilerPhase::SIZE)> timesRun{};
+    std::array<History, static_cast<size_t>(ProfilerPhase::SIZE)> phaseHistory;
+    History frameHistory;
+    uint64_t lastFrameEnd;
+    uint64_t frameNum = 0;
+    std::ofstream csvFile;
+
+    static PhaseStats computeStats(const History& history);
+};
+
+#endif //PROFILER_HPP
@@ -13,81 +13,260 @@
  * Traverses the QuadTree and returns the amount of elements present in all leaf nodes.
  */
 size_t QuadTree::size() const{
+    return sizeInternal(root);
+}
+
+size_t QuadTree::sizeInternal(const uint32_t nodeIndex) const {
+    const Node& node = nodes[nodeIndex];
+    if(!node.isDivided()) return node.objectCount;
     size_t size = 0;
-    if(divided) {
-        for(const auto& childPtr : children) {
-            size += childPtr->size();
-        }
-    }else {
-        size += objects.size();
+    for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) {
+        size += sizeInternal(child);
     }
     return size;
 }
 
-
 void QuadTree::insert(const QuadTreeObject& object) {
-    if(!rangeIntersectsRect(bounds, object.boundingBox)) return;
-    if(divided) {
-        insertIntoSubTree(object);
-    }else if(objects.size() < granularity || bounds.w * 0.5f <= minWidth || bounds.h * 0.5f <= minHeight) {
-        if(std::find(objects.begin(), objects.end(), object) == objects.end()) objects.push_back(object);
+    insertInternal(root, object);
+}
+
+void QuadTree::insertInternal(const uint32_t nodeIndex, const QuadTreeObject& object) {
+    const Node& node = nodes[nodeIndex];
+    if(!rangeIntersectsRect(node.bounds, object.boundingBox)) return;
+    if(node.isDivided()) {
+        insertIntoSubTree(nodeIndex, object);
+    }else if(node.objectCount < granularity || node.bounds.w * 0.5f <= minWidth || node.bounds.h * 0.5f <= minHeight) {
+        if(!leafContains(nodeIndex, object.id)) appendObject(nodeIndex, object);
     }else {
-        divided = true;
-        subdivide();
-        insertIntoSubTree(object);
-        for(const QuadTreeObject& currObject : objects) {
-            insertIntoSubTree(currObject);
+        //subdivide detaches the leaf's list, its entries are moved into the children and freed one by one
+        uint32_t objectIndex = node.firstObject;
+        subdivide(nodeIndex);
+        insertIntoSubTree(nodeIndex, object);
+        while(objectIndex != invalidIndex) {
+            const QuadTreeObject currObject = objectPool[objectIndex].object;
+            const uint32_t next = objectPool[objectIndex].next;
+            detachFromObjectChain(objectIndex);
+            objectPool[objectIndex].next = freeObject;
+            freeObject = objectIndex;
+            insertIntoSubTree(nodeIndex, currObject);
+            objectIndex = next;
         }
-        objects.clear();
     }
 }
 
-void QuadTree::insertIntoSubTree(const QuadTreeObject& object) {
-    if(!divided) return;
+void QuadTree::insertIntoSubTree(const uint32_t nodeIndex, const QuadTreeObject& object) {
+    const uint32_t firstChild = nodes[nodeIndex].firstChild;
+    if(firstChild == invalidIndex) return;
+
+    for(uint32_t child = firstChild; child < firstChild + 4; child++) {
+        //insertInternal may grow the node vector, so the child is looked up again every iteration
+        if(rangeIntersectsRect(nodes[child].bounds, object.boundingBox)) insertInternal(child, object);
+    }
+}
+
+uint32_t* QuadTree::getChainHead(const uint64_t id) {
+    return const_cast<uint32_t*>(std::as_const(*this).getChainHead(id));
+}
+
+const uint32_t* QuadTree::getChainHead(const uint64_t id) const {
+    const size_t chainSlot = getChainSlot(id);
+    if(chainSlot >= objectChains.size()) return nullptr;
+    const uint32_t& head = objectChains[chainSlot];
+    //an emptied chain, or the chain of an older handle of the same slot
+    if(head == invalidIndex || objectPool[head].object.id != id) return nullptr;
+    return &head;
+}
+
+bool QuadTree::leafContains(const uint32_t nodeIndex, const uint64_t id) const {
+    const uint32_t* headPtr = getChainHead(id);
+    if(!headPtr) return false;
+    for(uint32_t i = *headPtr; i != invalidIndex; i = objectPool[i].nextOfObject) {
+        if(objectPool[i].node == nodeIndex) return true;
+    }
+    return false;
+}
 
-    for(const auto& childPtr: children) {
-        if(rangeIntersectsRect(childPtr->bounds, object.boundingBox)) childPtr->insert(object);
+void QuadTree::appendObject(const uint32_t nodeIndex, const QuadTreeObject& object) {
+    Node& node = nodes[nodeIndex];
+    const ObjectEntry entry{object, invalidIndex, node.lastObject, nodeIndex, invalidIndex};
+    uint32_t entryIndex;
+    if(freeObject != invalidIndex) {
+        entryIndex = freeObject;
+        freeObject = objectPool[entryIndex].next;
+        objectPool[entryIndex] = entry;
+    }else {
+        entryIndex = static_cast<uint32_t>(objectPool.size());
+        objectPool.push_back(entry);
     }
+
+    if(node.lastObject == invalidIndex) node.firstObject = entryIndex;
+    else objectPool[node.lastObject].next = entryIndex;
+    node.lastObject = entryIndex;
+    node.objectCount++;
+
+    const size_t chainSlot = getChainSlot(object.id);
+    if(chainSlot >= objectChains.size()) objectChains.resize(chainSlot + 1, invalidIndex);
+    uint32_t& head = objectChains[chainSlot];
+    assert(head == invalidIndex || objectPool[head].object.id == object.id);
+    objectPool[entryIndex].nextOfObject = head;
+    head = entryIndex;
+}
+
+/**
+ * Takes an entry out of its leaf's list and returns it to the free list, the caller unlinks it from its object's chain.
+ * The leaf's parent is queued for the next undivide, since it may have few enough objects left to merge.
+ */
+void QuadTree::unlinkObject(const uint32_t entryIndex) {
+    ObjectEntry& entry = objectPool[entryIndex];
+    Node& node = nodes[entry.node];
+    if(entry.previous == invalidIndex) node.firstObject = entry.next;
+    else objectPool[entry.previous].next = entry.next;
+    if(entry.next == invalidIndex) node.lastObject = entry.previous;
+    else objectPool[entry.next].previous = entry.previous;
+    node.objectCount--;
+    entry.next = freeObject;
+    freeObject = entryIndex;
+    queueUndivide(node.parent);
+}
+
+void QuadTree::detachFromObjectChain(const uint32_t entryIndex) {
+    uint32_t* linkPtr = getChainHead(objectPool[entryIndex].object.id);
+    if(!linkPtr) return;
+    while(*linkPtr != invalidIndex && *linkPtr != entryIndex) linkPtr = &objectPool[*linkPtr].nextOfObject;
+    if(*linkPtr == entryIndex) *linkPtr = objectPool[entryIndex].nextOfObject;
 }
 
+/**
+ * Returns every entry of a leaf to the free list, leaving the leaf empty.
+ */
+void QuadTree::freeObjects(const uint32_t nodeIndex) {
+    Node& node = nodes[nodeIndex];
+    for(uint32_t i = node.firstObject; i != invalidIndex; i = objectPool[i].next) detachFromObjectChain(i);
+    if(node.lastObject != invalidIndex) {
+        objectPool[node.lastObject].next = freeObject;
+        freeObject = node.firstObject;
+    }
+    node.firstObject = invalidIndex;
+    node.lastObject = invalidIndex;
+    node.objectCount = 0;
+}
+
+/**
+ * Removes every entry of the object, its entries are found through its chain so the tree isn't descended.
+ */
 void QuadTree::remove(const QuadTreeObject& object) {
-    if(!rangeIntersectsRect(bounds, object.boundingBox)) return;
+    uint32_t* headPtr = getChainHead(object.id);
+    if(!headPtr) return;
+    for(uint32_t i = *headPtr; i != invalidIndex;) {
+        const uint32_t nextOfObject = objectPool[i].nextOfObject;
+        unlinkObject(i);
+        i = nextOfObject;
+    }
+    *headPtr = invalidIndex;
+}
+
+/**
+ * Moves an object that was inserted with oldBoundingBox to object.boundingBox. Only the subtree of the smallest node
+ * holding both boxes is searched for the new leaves, leaves the object stays in keep their entries and the tree
+ * is untouched if the object doesn't cross into or out of a leaf.
+ */
+void QuadTree::move(const QuadTreeObject& object, const SDL_FRect& oldBoundingBox) {
+    uint32_t* headPtr = getChainHead(object.id);
+    if(!headPtr) {
+        insert(object);
+        return;
+    }
+    if(!rangeIntersectsRect(nodes[root].bounds, object.boundingBox)) {
+        remove(object);
+        return;
+    }
 
-    if(divided) {
-        for(const auto& childPtr: children) {
-            if(rangeIntersectsRect(childPtr->bounds, object.boundingBox)) {
-                childPtr->remove(object);
+    const SDL_FRect& newBox = object.boundingBox;
+    const float minX = std::min(oldBoundingBox.x, newBox.x);
+    const float minY = std::min(oldBoundingBox.y, newBox.y);
+    const SDL_FRect bothBoxes = {
+        minX,
+        minY,
+        std::max(oldBoundingBox.x + oldBoundingBox.w, newBox.x + newBox.w) - minX,
+        std::max(oldBoundingBox.y + oldBoundingBox.h, newBox.y + newBox.h) - minY
+    };
+    moveScratch.clear();
+    collectLeaves(getCommonAncestor(bothBoxes), newBox, &moveScratch);
+
+    //refresh the entries in leaves the object still overlaps and drop the rest
+    uint32_t* linkPtr = headPtr;
+    while(*linkPtr != invalidIndex) {
+        const uint32_t entryIndex = *linkPtr;
+        ObjectEntry& entry = objectPool[entryIndex];
+        if(std::find(moveScratch.begin(), moveScratch.end(), entry.node) != moveScratch.end()) {
+            entry.object = object;
+            linkPtr = &entry.nextOfObject;
+        }else {
+            *linkPtr = entry.nextOfObject;
+            unlinkObject(entryIndex);
+        }
+    }
+
+    for(const uint32_t leaf : moveScratch) {
+        if(!leafContains(leaf, object.id)) insertInternal(leaf, object);
+    }
+}
+
+/**
+ * @return the deepest node whose bounds strictly contain rect, objects touching a node's edge are also in its neighbor.
+ */
+uint32_t QuadTree::getCommonAncestor(const SDL_FRect& rect) const {
+    uint32_t nodeIndex = root;
+    while(nodes[nodeIndex].isDivided()) {
+        uint32_t containingChild = invalidIndex;
+        for(uint32_t child = nodes[nodeIndex].firstChild; child < nodes[nodeIndex].firstChild + 4; child++) {
+            const SDL_FRect& bounds = nodes[child].bounds;
+            if(rect.x > bounds.x && rect.x + rect.w < bounds.x + bounds.w &&
+               rect.y > bounds.y && rect.y + rect.h < bounds.y + bounds.h) {
+                containingChild = child;
+                break;
             }
         }
-    }else {
-        const auto& found = std::find(objects.begin(), objects.end(), object);
-        if(found != objects.end()) objects.erase(found);
+        if(containingChild == invalidIndex) break;
+        nodeIndex = containingChild;
     }
+    return nodeIndex;
 }
 
-std::vector<std::pair<uint64_t, uint64_t>> QuadTree::getIntersections() const {
+void QuadTree::collectLeaves(const uint32_t nodeIndex, const SDL_FRect& rect, std::vector<uint32_t>* leavesPtr) const {
+    const Node& node = nodes[nodeIndex];
+    if(!rangeIntersectsRect(node.bounds, rect)) return;
+    if(!node.isDivided()) {
+        leavesPtr->push_back(nodeIndex);
+        return;
+    }
+    for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) collectLeaves(child, rect, leavesPtr);
+}
+
+std::vector<QuadTree::Intersection> QuadTree::getIntersections() const {
     QuadTreeObjectPairSet collisions;
-    getIntersectionsInternal(&collisions);
-    std::vector<std::pair<uint64_t, uint64_t>> ids;
-    ids.reserve(collisions.size());
-    std::transform(collisions.begin(), collisions.end(), std::back_inserter(ids),
+    getIntersectionsInternal(root, &collisions);
+    std::vector<Intersection> intersections;
+    intersections.reserve(collisions.size());
+    std::transform(collisions.begin(), collisions.end(), std::back_inserter(intersections),
          [](const QuadTreeObjectPair& pair) {
-                        return std::make_pair(pair.first.id, pair.second.id);
+                        return Intersection{pair.first.id, pair.first.kind, pair.second.id, pair.second.kind};
                    }
     );
-    return ids;
+    return intersections;
 }
 
-void QuadTree::getIntersectionsInternal(QuadTreeObjectPairSet* collisionsPtr) const {
-    if(divided) {
-        for(const auto & childPtr : children) {
-            childPtr->getIntersectionsInternal(collisionsPtr);
+void QuadTree::getIntersectionsInternal(const uint32_t nodeIndex, QuadTreeObjectPairSet* collisionsPtr) const {
+    const Node& node = nodes[nodeIndex];
+    if(node.isDivided()) {
+        for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) {
+            getIntersectionsInternal(child, collisionsPtr);
         }
     }else {
-        for(int i = 0; i < objects.size(); i++) {
-            const QuadTreeObject& currObject = objects[i];
-            for(int j = i + 1; j < objects.size(); j++) {
-                const QuadTreeObject& otherObject = objects[j];
+        for(uint32_t i = node.firstObject; i != invalidIndex; i = objectPool[i].next) {
+            const QuadTreeObject& currObject = objectPool[i].object;
+            for(uint32_t j = objectPool[i].next; j != invalidIndex; j = objectPool[j].next) {
+                const QuadTreeObject& otherObject = objectPool[j].object;
                 if(rangeIntersectsRect(otherObject.boundingBox, currObject.boundingBox))
                     collisionsPtr->emplace(currObject, otherObject);
             }
@@ -98,150 +277,121 @@ void QuadTree::getIntersectionsInternal(QuadTreeObjectPairSet* collisionsPtr) co
 /**
  * Finds the nearest neighbors of the given QuadTreeObject.
  * @param object the QuadTreeObject to find the neighbors of.
- * @return the nearest neighbors of object in a pairing of id and distance to object, sorted by closest distance first.
+ * @param neighbors receives the nearest neighbors of object with their kind and distance to object, sorted by closest distance first.
+ * @return the amount of neighbors written.
  */
-std::vector<std::pair<uint64_t, Vec2>> QuadTree::getNearestNeighbors(const QuadTreeObject& object) const{
-    if(!rangeIntersectsRect(bounds, object.boundingBox)) return {};
-
-    QuadTreeObjectSet neighbors;
-    getNearestNeighborsInternal(object, &neighbors);
-    std::vector<std::pair<uint64_t, Vec2>> neighborsVec;
-    neighborsVec.reserve(neighbors.size());
-    std::transform(neighbors.begin(), neighbors.end(), std::back_inserter(neighborsVec),
-        [object](const QuadTreeObject& neighbor) {
-            Vec2 minDist = QuadTree::getMinDistanceBetweenRects(object.boundingBox, neighbor.boundingBox);
-            return std::make_pair(neighbor.id, minDist);
-        }
-    );
-    std::sort(neighborsVec.begin(), neighborsVec.end(),
-        [](const std::pair<uint64_t, Vec2>& neighbor1, const std::pair<uint64_t, Vec2>& neighbor2)-> bool{
-           return neighbor1.second < neighbor2.second;
-        }
-    );
-    if(neighborsVec.size() > maxNeighbors) neighborsVec.erase(neighborsVec.begin() + maxNeighbors, neighborsVec.end());
-    return neighborsVec;
+uint8_t QuadTree::findNearestNeighbors(const QuadTreeObject& object, const std::span<Neighbor> neighbors) const {
+    if(!rangeIntersectsRect(nodes[root].bounds, object.boundingBox)) return 0;
+
+    NearestSearch search;
+    getNearestNeighborsInternal(root, object, &search);
+    std::sort_heap(search.candidates.begin(), search.candidates.begin() + search.count, isCloserCandidate);
+    for(uint8_t i = 0; i < search.count; i++) neighbors[i] = search.candidates[i].neighbor;
+    return search.count;
 }
 
-void QuadTree::getNearestNeighborsInternal(const QuadTreeObject& object, QuadTreeObjectSet* neighborsPtr) const {
-    if(divided) {
-        for(const auto& childPtr : children) {
-            if(rangeIntersectsRect(childPtr->bounds, object.boundingBox) || rangeIsNearRect(childPtr->bounds, object.boundingBox)) {
-                childPtr->getNearestNeighborsInternal(object, neighborsPtr);
-            }
-        }
-    }else {
-        for(const QuadTreeObject& currObject : objects) {
-            if(
-                object.id != currObject.id &&
-                rangeIsNearRect(object.boundingBox, currObject.boundingBox)
-            ) {
-                const Vec2 currDistance = getMinDistanceBetweenRects(object.boundingBox, currObject.boundingBox);
-                if(currDistance == Vec2(0.0f, 0.0f)) continue;
-                if(neighborsPtr->size() >= maxNeighborsInQuad) {
-                    for(const QuadTreeObject& neighbor : *neighborsPtr) {
-                        const Vec2 neighborDistance = getMinDistanceBetweenRects(object.boundingBox, neighbor.boundingBox);
-                        if(currDistance < neighborDistance || currObject.highPriority) {
-                            neighborsPtr->erase(neighbor);
-                            neighborsPtr->emplace(currObject.id, currObject.boundingBox);
-                            break;
-                        }
-                    }
-                }else {
-                    neighborsPtr->emplace(currObject.id, currObject.boundingBox);
-                }
-            }
-        }
-    }
+bool QuadTree::isCloserCandidate(const Candidate& candidate1, const Candidate& candidate2) {
+    return isCloser(candidate1.distanceSquared, candidate1.neighbor.id, candidate2.distanceSquared, candidate2.neighbor.id);
 }
 
-std::vector<std::pair<uint64_t, Vec2>> QuadTree::raycast(const QuadTreeObject& object, Vec2 velocityCopy) const {
-    const float rayDistance = 400.0f;
-
-    if(std::max(std::abs(velocityCopy.x), std::abs(velocityCopy.y)) == std::abs(velocityCopy.x)) {
-        velocityCopy.y = 0.0f;
-    }else velocityCopy.x = 0.0f;
-
-    auto closeNeighbors = raycastInternal(object, velocityCopy, rayDistance);
-    return closeNeighbors;
+/**
+ * Insertion sort over the first childCount children, nearest first.
+ */
+void QuadTree::sortChildren(ChildOrder* childrenPtr, const uint8_t childCount) {
+    ChildOrder& children = *childrenPtr;
+    for(uint8_t i = 1; i < childCount; i++) {
+        const std::pair<float, uint32_t> child = children[i];
+        uint8_t j = i;
+        for(; j > 0 && child < children[j - 1]; j--) children[j] = children[j - 1];
+        children[j] = child;
+    }
 }
 
-std::vector<std::pair<uint64_t, Vec2>> QuadTree::raycastInternal(
-        const QuadTreeObject& object,
-        const Vec2& velocity,
-        const float rayDistance) const {
-    QuadTreeObjectSet rayCollisions;
-    std::vector<std::pair<uint64_t, Vec2>> result;
-    std::unordered_map<uint64_t, bool> priorities;
-
-    queryInternal(
-            QuadTreeObject(getRay(velocity, object, rayDistance)),
-            &rayCollisions);
-
-    result.reserve(rayCollisions.size());
-    std::transform(rayCollisions.begin(), rayCollisions.end(), std::back_inserter(result),
-        [&object, &priorities](const QuadTreeObject& neighbor) {
-            Vec2 minDist = QuadTree::getMinDistanceBetweenRects(object.boundingBox, neighbor.boundingBox);
-            priorities[neighbor.id] = neighbor.highPriority;
-
-            return std::make_pair(neighbor.id, minDist);
+/**
+ * Visits the children closest to object first, so the heap fills with close candidates early and every child
+ * further away than the current k-th best is skipped without descending into it.
+ */
+void QuadTree::getNearestNeighborsInternal(const uint32_t nodeIndex, const QuadTreeObject& object, NearestSearch* searchPtr) const {
+    const Node& node = nodes[nodeIndex];
+    if(node.isDivided()) {
+        ChildOrder children;
+        uint8_t childCount = 0;
+        for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) {
+            const SDL_FRect& childBounds = nodes[child].bounds;
+            if(!rangeIntersectsRect(childBounds, object.boundingBox) && !rangeIsNearRect(childBounds, object.boundingBox)) continue;
+            children[childCount++] = {getDistanceSquared(getMinDistanceBetweenRects(object.boundingBox, childBounds)), child};
         }
-    );
-
-    std::sort(result.begin(), result.end(),
-              [](const std::pair<uint64_t, Vec2>& neighbor1, const std::pair<uint64_t, Vec2>& neighbor2)-> bool{
-                  //send neighbors with 0 distance to our object (collisions) to the back of the vector, so they
-                  //don't take up space of actual neighbors.
-                  if(neighbor1.second == Vec2(0.0f, 0.0f)) {
-                      return false;
-                  }else if(neighbor2.second == Vec2(0.0f, 0.0f)) {
-                      return true;
-                  }else {
-                      return neighbor1.second < neighbor2.second;
-                  }
-              }
-    );
-
-    std::stable_sort(result.begin(), result.end(),
-        [&priorities](const std::pair<uint64_t, Vec2>& neighbor1, const std::pair<uint64_t, Vec2>& neighbor2)-> bool{
-        if(!priorities.contains(neighbor1.first) || !priorities.contains(neighbor2.first)) return false;
-        return priorities.at(neighbor1.first) && !priorities.at(neighbor2.first);
-    });
-
-    if(result.size() > maxNeighbors) result.erase(result.begin() + maxNeighbors, result.end());
+        sortChildren(&children, childCount);
+        for(uint8_t i = 0; i < childCount; i++) {
+            if(searchPtr->count == maxNeighbors && children[i].first > searchPtr->candidates.front().distanceSquared) break;
+            getNearestNeighborsInternal(children[i].second, object, searchPtr);
+        }
+        return;
+    }
 
-    return result;
+    std::array<Candidate, maxNeighbors>& candidates = searchPtr->candidates;
+    uint8_t& count = searchPtr->count;
+    for(uint32_t i = node.firstObject; i != invalidIndex; i = objectPool[i].next) {
+        const QuadTreeObject& currObject = objectPool[i].object;
+        if(object.id == currObject.id || !rangeIsNearRect(object.boundingBox, currObject.boundingBox)) continue;
+        const Vec2 currDistance = getMinDistanceBetweenRects(object.boundingBox, currObject.boundingBox);
+        if(currDistance == Vec2(0.0f, 0.0f)) continue;
+
+        const Candidate candidate = {getDistanceSquared(currDistance), {currObject.id, currObject.kind, currDistance}};
+        if(count == maxNeighbors && !isCloserCandidate(candidate, candidates.front())) continue;
+        //objects stored in several leaves are found once per leaf
+        bool isCandidate = false;
+        for(uint8_t j = 0; j < count && !isCandidate; j++) isCandidate = candidates[j].neighbor.id == currObject.id;
+        if(isCandidate) continue;
+
+        //the heap's front is the furthest candidate, it makes room for a closer one once all maxNeighbors are taken
+        if(count == maxNeighbors) std::pop_heap(candidates.begin(), candidates.begin() + count--, isCloserCandidate);
+        candidates[count++] = candidate;
+        std::push_heap(candidates.begin(), candidates.begin() + count, isCloserCandidate);
+    }
 }
 
-SDL_FRect QuadTree::getRay(const Vec2& direction, const QuadTreeObject& object, float rayDistance) const{
-    assert(rayDistance > object.boundingBox.w && rayDistance > object.boundingBox.h);
-    float x, y;
-    float rayWidth = rayDistance, rayHeight = rayDistance;
+/**
+ * Walks the leaves along the ray nearest first and stops descending once the hits found so far can't be outranked.
+ */
+void QuadTree::rankRayHits(
+    const QuadTreeObject& object,
+    const Vec2& direction,
+    const SDL_FRect& ray,
+    const std::span<RayHit> hits,
+    uint8_t* countPtr
+) const {
+    castRayInternal(root, object, direction, ray, hits, countPtr);
+}
 
-    if(direction.x == 0.0f) {
-        rayWidth *= 0.10f;
-        float potentialX = object.boundingBox.x - ((rayWidth * 0.5f) + (object.boundingBox.w * 0.5f));
-        x = potentialX < bounds.x ? bounds.x : potentialX;
-    }else if(std::signbit(direction.x)) { //left ray
-        float potentialX = object.boundingBox.x - rayDistance;
-        x = potentialX < bounds.x ? bounds.x : potentialX;
-    }else { //right ray
-        x = object.boundingBox.x + object.boundingBox.w;
-        rayWidth = x + rayDistance > bounds.x + bounds.w ? (bounds.x + bounds.w) - x : rayDistance;
+void QuadTree::castRayInternal(
+    const uint32_t nodeIndex,
+    const QuadTreeObject& object,
+    const Vec2& direction,
+    const SDL_FRect& ray,
+    const std::span<RayHit> hits,
+    uint8_t* countPtr
+) const {
+    const Node& node = nodes[nodeIndex];
+    if(node.isDivided()) {
+        ChildOrder children;
+        uint8_t childCount = 0;
+        for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) {
+            const SDL_FRect& childBounds = nodes[child].bounds;
+            if(rangeIntersectsRect(childBounds, ray)) children[childCount++] = {getRayGap(direction, object.boundingBox, childBounds), child};
+        }
+        sortChildren(&children, childCount);
+        for(uint8_t i = 0; i < childCount; i++) {
+            if(areRayHitsFinal(hits, *countPtr, children[i].first)) break;
+            castRayInternal(children[i].second, object, direction, ray, hits, countPtr);
+        }
+        return;
     }
-
-    if(direction.y == 0.0f) {
-        rayHeight *= 0.10f;
-        float potentialY = object.boundingBox.y - ((rayHeight * 0.5f) + (object.boundingBox.h * 0.5f));
-        y = potentialY < bounds.y ? bounds.y : potentialY;
-    }else if(std::signbit(direction.y)) { //up ray
-        float potentialY = object.boundingBox.y - rayDistance;
-        y = potentialY < bounds.y ? bounds.y : potentialY;
-    }else { //down ray
-        y = object.boundingBox.y + object.boundingBox.h;
-        rayHeight = y + rayDistance > bounds.y + bounds.h ? (bounds.y + bounds.h) - y : rayDistance;
+    for(uint32_t i = node.firstObject; i != invalidIndex; i = objectPool[i].next) {
+        const QuadTreeObject& currObject = objectPool[i].object;
+        //the caster isn't one of its own hits
+        if(currObject.id != object.id && rangeIntersectsRect(currObject.boundingBox, ray)) rankRayHit(object, currObject, hits, countPtr);
     }
-
-    return SDL_FRect{x, y, rayWidth, rayHeight};
 }
 
 /**
@@ -249,118 +399,128 @@ SDL_FRect QuadTree::getRay(const Vec2& direction, const QuadTreeObject& object,
  * @param object a SimObject struct containing the position and id of the object to check.
  * @return a vector holding the id's of simulation objects the range is intersecting.
 */
-std::vector<uint64_t> QuadTree::query(const QuadTreeObject& object) const{
-    if(!rangeIntersectsRect(bounds, object.boundingBox)) return {};
-    QuadTreeObjectSet collisions;
-    queryInternal(object, &collisions);
-    std::vector<uint64_t> ids;
-    ids.reserve(collisions.size());
-    std::transform(collisions.begin(), collisions.end(), std::back_inserter(ids),
-                [](const QuadTreeObject& object) {
-                    return object.id;
-                }
-    );
-    return ids;
+void QuadTree::findOverlapping(const QuadTreeObject& object, std::vector<uint64_t>* idsPtr) const {
+    idsPtr->clear();
+    if(!rangeIntersectsRect(nodes[root].bounds, object.boundingBox)) return;
+    queryInternal(root, object, idsPtr);
 }
 
-void QuadTree::queryInternal(const QuadTreeObject& object, QuadTreeObjectSet* collisionsPtr) const{
-    if(divided) {
-        for(const auto& childPtr : children) {
-            if(rangeIntersectsRect(childPtr->bounds, object.boundingBox)) {
-                childPtr->queryInternal(object, collisionsPtr);
+/**
+ * Objects stored in several leaves are found once per leaf, an id already written isn't written again.
+ * Queries hit a handful of objects, so scanning what was written beats keeping a set.
+ */
+void QuadTree::queryInternal(const uint32_t nodeIndex, const QuadTreeObject& object, std::vector<uint64_t>* idsPtr) const {
+    const Node& node = nodes[nodeIndex];
+    if(node.isDivided()) {
+        for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) {
+            if(rangeIntersectsRect(nodes[child].bounds, object.boundingBox)) {
+                queryInternal(child, object, idsPtr);
             }
         }
     }else {
-        for(const auto& [id, boundingBox, highPriority] : objects) {
-            if(id != object.id && rangeIntersectsRect(boundingBox, object.boundingBox)) {
-                collisionsPtr->emplace(id, boundingBox, highPriority);
+        for(uint32_t i = node.firstObject; i != invalidIndex; i = objectPool[i].next) {
+            const QuadTreeObject& currObject = objectPool[i].object;
+            if(currObject.id != object.id && rangeIntersectsRect(currObject.boundingBox, object.boundingBox) &&
+               std::find(idsPtr->begin(), idsPtr->end(), currObject.id) == idsPtr->end()) {
+                idsPtr->push_back(currObject.id);
             }
         }
     }
 }
 
+/**
+ * Turns a leaf into a divided node, its four children are taken from the free list or appended to the node vector.
+ * The leaf's object list is detached, the caller owns its entries afterwards.
+ */
+void QuadTree::subdivide(const uint32_t nodeIndex) {
+    uint32_t firstChild;
+    if(freeNodeGroup != invalidIndex) {
+        firstChild = freeNodeGroup;
+        freeNodeGroup = nodes[firstChild].firstChild;
+    }else {
+        firstChild = static_cast<uint32_t>(nodes.size());
+        nodes.resize(nodes.size() + 4);
+    }
 
-void QuadTree::subdivide() {
-    float newWidth = bounds.w * 0.5f;
-    float newHeight = bounds.h * 0.5f;
-
-    children[0] = std::make_unique<QuadTree>(((SDL_FRect) {bounds.x + newWidth, bounds.y, newWidth, newHeight}), granularity);
-    children[1] = std::make_unique<QuadTree>(((SDL_FRect) {bounds.x, bounds.y, newWidth, newHeight}), granularity);
-    children[2] = std::make_unique<QuadTree>(((SDL_FRect) {bounds.x, bounds.y + newHeight, newWidth, newHeight}), granularity);
-    children[3] = std::make_unique<QuadTree>(((SDL_FRect) {bounds.x + newWidth, bounds.y + newHeight, newWidth, newHeight}), granularity);
+    Node& node = nodes[nodeIndex];
+    const SDL_FRect& bounds = node.bounds;
+    const float newWidth = bounds.w * 0.5f;
+    const float newHeight = bounds.h * 0.5f;
+    nodes[firstChild] = Node{{bounds.x + newWidth, bounds.y, newWidth, newHeight}, nodeIndex};
+    nodes[firstChild + 1] = Node{{bounds.x, bounds.y, newWidth, newHeight}, nodeIndex};
+    nodes[firstChild + 2] = Node{{bounds.x, bounds.y + newHeight, newWidth, newHeight}, nodeIndex};
+    nodes[firstChild + 3] = Node{{bounds.x + newWidth, bounds.y + newHeight, newWidth, newHeight}, nodeIndex};
+
+    node.firstChild = firstChild;
+    node.firstObject = invalidIndex;
+    node.lastObject = invalidIndex;
+    node.objectCount = 0;
 }
 
 /**
- * Checks if the tree from the current instance down needs to be undivided due to insufficient QuadTreeObjects within itself or its children.
+ * Works through the queue until it is empty, a node that merges queues its parent in turn,
+ * so a subtree that emptied out collapses level by level within one call.
  */
 void QuadTree::undivide() {
-    undivideInternal();
-}
-
-std::vector<QuadTree::QuadTreeObject> QuadTree::undivideInternal() {
-    if(divided) {
-        std::unordered_set<QuadTreeObject, QuadTreeObjectHash> subObjects;
-        for(const auto& childPtr : children) {
-            const auto temp = childPtr->undivideInternal();
-            subObjects.insert(temp.begin(), temp.end());
-        }
-        if(subObjects.size() < granularity) {
-            //objects.clear();
-            objects.insert(objects.end(), subObjects.begin(), subObjects.end());
-            for(auto& childPtr : children)
-                childPtr.reset();
-            divided = false;
-        }else {
-            std::vector<QuadTreeObject> result;
-            result.insert(result.end(), subObjects.begin(), subObjects.end());
-            return result;
-        }
+    while(!undivideQueue.empty()) {
+        const uint32_t nodeIndex = undivideQueue.back();
+        undivideQueue.pop_back();
+        nodes[nodeIndex].isQueued = false;
+        if(mergeChildren(nodeIndex)) queueUndivide(nodes[nodeIndex].parent);
     }
-    return objects;
 }
 
-bool QuadTree::rangeIntersectsRect(const SDL_FRect& rect, const SDL_FRect& range) {
-    return !(range.x > rect.x  +  rect.w  ||
-             range.x + range.w <  rect.x  ||
-             range.y > rect.y  +  rect.h  ||
-             range.y + range.h <  rect.y  );
+void QuadTree::queueUndivide(const uint32_t nodeIndex) {
+    if(nodeIndex == invalidIndex || nodes[nodeIndex].isQueued) return;
+    nodes[nodeIndex].isQueued = true;
+    undivideQueue.push_back(nodeIndex);
 }
 
-bool QuadTree::rangeIsNearRect(const SDL_FRect& rect, const SDL_FRect& range) {
-    return !(range.x - (rect.x  +  rect.w) > isNearDistance ||
-             rect.x  - (range.x + range.w) > isNearDistance ||
-             range.y - (rect.y  +  rect.h) > isNearDistance ||
-             rect.y  - (range.y + range.h) > isNearDistance );
-}
+/**
+ * Merges the children of a node back into it when they are all leaves holding fewer than mergeThreshold distinct objects.
+ * Leaves split at granularity, so a node needs to lose about half of its objects before it merges and a node
+ * with close to granularity objects doesn't split and merge again every time one of them comes and goes.
+ * @return true if the node was merged.
+ */
+bool QuadTree::mergeChildren(const uint32_t nodeIndex) {
+    const uint32_t firstChild = nodes[nodeIndex].firstChild;
+    if(firstChild == invalidIndex) return false;
 
-Vec2 QuadTree::getMinDistanceBetweenRects(const SDL_FRect& rect, const SDL_FRect& range) {
-    float distLeft   = rect.x  - (range.x + range.w);
-    float distRight  = range.x - (rect.x  + rect.w );
-    float distTop    = rect.y  - (range.y + range.h);
-    float distBottom = range.y - (rect.y  + rect.h );
-    float distX, distY;
-    if(distLeft < 0.0f && distRight < 0.0f) {
-        distX = 0.0f;
-    }else if(distLeft < 0.0f) {
-        distX = distRight;
-    }else distX = -distLeft;
-    if(distTop < 0.0f && distBottom < 0.0f) {
-        distY = 0.0f;
-    }else if(distTop < 0.0f) {
-        distY = distBottom;
-    }else distY = -distTop;
+    for(uint32_t child = firstChild; child < firstChild + 4; child++) {
+        if(nodes[child].isDivided()) return false;
+    }
+    //objects overlapping a split are in several children, only count them once
+    undivideScratch.clear();
+    for(uint32_t child = firstChild; child < firstChild + 4; child++) {
+        for(uint32_t i = nodes[child].firstObject; i != invalidIndex; i = objectPool[i].next) {
+            const QuadTreeObject& currObject = objectPool[i].object;
+            if(std::find(undivideScratch.begin(), undivideScratch.end(), currObject) != undivideScratch.end()) continue;
+            if(undivideScratch.size() + 1 >= mergeThreshold) return false;
+            undivideScratch.push_back(currObject);
+        }
+    }
 
-    return {distX, distY};
+    for(uint32_t child = firstChild; child < firstChild + 4; child++) freeObjects(child);
+    nodes[firstChild].firstChild = freeNodeGroup;
+    freeNodeGroup = firstChild;
+    nodes[nodeIndex].firstChild = invalidIndex;
+    for(const QuadTreeObject& currObject : undivideScratch) appendObject(nodeIndex, currObject);
+    return true;
 }
 
 void QuadTree::show(SDL_Renderer* rendererPtr) const{
     SDL_SetRenderDrawColor(rendererPtr, 255, 0, 0, 255);
-    SDL_RenderRect(rendererPtr, &bounds);
-    if(divided) {
-        for(const auto& childPtr : children) {
-            childPtr->show(rendererPtr);
+    showInternal(root, rendererPtr);
+}
+
+void QuadTree::showInternal(const uint32_t nodeIndex, SDL_Renderer* rendererPtr) const {
+    const Node& node = nodes[nodeIndex];
+    SDL_RenderRect(rendererPtr, &node.bounds);
+    if(node.isDivided()) {
+        for(uint32_t child = node.firstChild; child < node.firstChild + 4; child++) {
+            showInternal(child, rendererPtr);
         }
     }else {
-        SDL_RenderDebugText(rendererPtr, bounds.x, bounds.y, std::to_string(objects.size()).c_str());
+        SDL_RenderDebugText(rendererPtr, node.bounds.x, node.bounds.y, std::to_string(node.objectCount).c_str());
     }
-}
\ No newline at end of file
+}
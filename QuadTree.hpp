@@ -2,94 +2,60 @@
 #define QUADTREE_HPP
 
 #include "SDL3/SDL.h"
+#include "SpatialIndex.hpp"
 #include "UtilityStructs.hpp"
+#include "SlotMap.hpp"
 #include <vector>
 #include <functional>
 #include <memory>
 #include <cstdint>
+#include <span>
 #include <unordered_set>
 #include <array>
+#include <utility>
 
-class QuadTree {
+/**
+ * The spatial index backend that recursively splits crowded areas into four quads.
+ */
+class QuadTree : public SpatialIndex {
 public:
-    struct QuadTreeObject {
-        uint64_t id;
-        SDL_FRect boundingBox;
-        bool highPriority;
-
-        //QuadTreeObject(const uint64_t id, const bool setHighPriority = false) :
-        //        id(id), boundingBox({0,0,0,0}), highPriority(setHighPriority) {};
-        QuadTreeObject(const SDL_FRect& boundingBox, const bool setHighPriority = false) :
-            id(UINT64_MAX), boundingBox(boundingBox), highPriority(setHighPriority) {};
-        QuadTreeObject(const uint64_t id, const SDL_FRect& boundingBox, const bool setHighPriority = false) :
-            id(id), boundingBox(boundingBox), highPriority(setHighPriority) {};
-
-        bool operator==(const QuadTreeObject& other) const {
-            return this->id == other.id;
-        }
-        bool operator<(const QuadTreeObject& other) const {
-            return this->id < other.id;
-        }
-        bool operator>(const QuadTreeObject& other) const {
-            return this->id > other.id;
-        }
-    };
+    using QuadTreeObject = Object;
+
     /**
     * @param bounds an sdl float rectangle with the x,y members pointing to the top left point of the rectangle
-    * @param granularity the amount of points that can be in a rectangle before it is subdivided further
+    * @param granularity the amount of points that can be in a rectangle before it is subdivided further,
+    * divided nodes are only merged back once their children hold fewer than half of it
     */
-    QuadTree(const SDL_FRect& bounds, uint8_t granularity) : bounds(bounds), granularity(granularity) {objects.reserve(granularity);};
-
-    QuadTree(const QuadTree& other) : bounds(other.bounds), objects(other.objects), granularity(other.granularity), divided(other.divided) {
-        if(divided) {
-            for(int i = 0; i < 4; i++) {
-                children[i] = std::make_unique<QuadTree>(*other.children[i]);
-            }
-        }
-    }
-
-    QuadTree& operator=(const QuadTree& other) {
-        if (this == &other) return *this;
+    QuadTree(const SDL_FRect& bounds, const uint8_t granularity) :
+        granularity(granularity), mergeThreshold(granularity / 2) {nodes.push_back(Node{bounds});};
 
-        bounds = other.bounds;
-        objects = other.objects;
-        granularity = other.granularity;
-        divided = other.divided;
+    //nodes, object entries and the heads of the object chains are plain values in three vectors, so copying a tree is three bulk copies
 
-        for(int i = 0; i < 4; i++) {
-            if(other.children[i]) {
-                children[i] = std::make_unique<QuadTree>(*other.children[i]);
-            }else {
-                children[i].reset();
-            }
-        }
-        return *this;
-    }
-
-    //[[nodiscard]] SDL_FRect getBounds() const{return bounds;}
-
-    void insert(const QuadTreeObject& object);
-    void remove(const QuadTreeObject& object);
+    void insert(const QuadTreeObject& object) override;
+    void remove(const QuadTreeObject& object) override;
+    void move(const QuadTreeObject& object, const SDL_FRect& oldBoundingBox) override;
+    /**
+     * Merges the nodes that lost objects since the last undivide back into leaves where few enough are left,
+     * the rest of the tree isn't visited.
+     */
     void undivide();
+    void compact(ThreadPool* = nullptr) override {undivide();}
+    void reset(const SDL_FRect& bounds) override {*this = QuadTree(bounds, granularity);}
+    [[nodiscard]] std::unique_ptr<SpatialIndex> clone() const override {return std::make_unique<QuadTree>(*this);}
 
-    [[nodiscard]] static bool rangeIntersectsRect(const SDL_FRect& rect, const SDL_FRect& range);
-    [[nodiscard]] static bool rangeIsNearRect(const SDL_FRect& rect, const SDL_FRect& range);
-    [[nodiscard]] static Vec2 getMinDistanceBetweenRects(const SDL_FRect& rect, const SDL_FRect& range);
-    [[nodiscard]] std::vector<uint64_t> query(const QuadTreeObject& object) const;
-    [[nodiscard]] std::vector<std::pair<uint64_t, Vec2>> getNearestNeighbors(const QuadTreeObject& object) const;
-    [[nodiscard]] std::vector<std::pair<uint64_t, Vec2>> raycast(const QuadTreeObject& object, Vec2 velocityCopy) const;
-    [[nodiscard]] std::vector<std::pair<uint64_t, uint64_t>> getIntersections() const;
+    void findOverlapping(const QuadTreeObject& object, std::vector<uint64_t>* idsPtr) const override;
+    uint8_t findNearestNeighbors(const QuadTreeObject& object, std::span<Neighbor> neighbors) const override;
+    [[nodiscard]] std::vector<Intersection> getIntersections() const override;
+    [[nodiscard]] SDL_FRect getBounds() const override {return nodes[root].bounds;}
 
-    void show(SDL_Renderer* rendererPtr) const;
-    [[nodiscard]] size_t size() const;
+    void show(SDL_Renderer* rendererPtr) const override;
+    [[nodiscard]] size_t size() const override;
 
-private:
-    struct QuadTreeObjectHash {
-        std::size_t operator()(const QuadTreeObject& object) const {
-            return std::hash<uint64_t>()(object.id);
-        }
-    };
+protected:
+    void rankRayHits(const QuadTreeObject& object, const Vec2& direction, const SDL_FRect& ray, std::span<RayHit> hits,
+        uint8_t* countPtr) const override;
 
+private:
     struct QuadTreeObjectPair {
         QuadTreeObject first;
         QuadTreeObject second;
@@ -111,18 +77,54 @@ private:
         }
     };
 
-    SDL_FRect bounds;
-    std::vector<QuadTreeObject> objects;
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+    static constexpr uint32_t root = 0;
+
+    /**
+     * A node of the tree, divided nodes own four consecutive nodes starting at firstChild
+     * ordered counterclockwise from quad 0 (ne, nw, sw, se), leaves own a linked list of entries in the object pool.
+     * isQueued marks nodes waiting in the undivide queue.
+     */
+    struct Node {
+        SDL_FRect bounds;
+        uint32_t parent = invalidIndex;
+        uint32_t firstChild = invalidIndex;
+        uint32_t firstObject = invalidIndex;
+        uint32_t lastObject = invalidIndex;
+        uint32_t objectCount = 0;
+        bool isQueued = false;
+
+        [[nodiscard]] bool isDivided() const {return firstChild != invalidIndex;}
+    };
+
+    /**
+     * One leaf's copy of an object. Entries are linked both ways within their leaf's list, and every entry of
+     * the same object is chained through nextOfObject so an object can be found and unlinked without descending the tree.
+     */
+    struct ObjectEntry {
+        QuadTreeObject object;
+        uint32_t next;
+        uint32_t previous;
+        uint32_t node;
+        uint32_t nextOfObject;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<ObjectEntry> objectPool;
+    //the first entry of every object's chain, indexed by getChainSlot
+    std::vector<uint32_t> objectChains;
+    //freed groups of four children are chained through the firstChild of their first node, freed entries through next
+    uint32_t freeNodeGroup = invalidIndex;
+    uint32_t freeObject = invalidIndex;
+    //parents of leaves that lost an entry since the last undivide
+    std::vector<uint32_t> undivideQueue;
+    std::vector<QuadTreeObject> undivideScratch;
+    std::vector<uint32_t> moveScratch;
     uint8_t granularity;
-    bool divided = false;
-    //children are ordered counterclockwise from quad 0 (ne, nw, sw, se);
-    std::array<std::unique_ptr<QuadTree>, 4> children{};
+    uint8_t mergeThreshold;
 
     static constexpr float minWidth = 10.0f;
     static constexpr float minHeight = 10.0f;
-    static constexpr float isNearDistance = 20.0f;
-    static constexpr uint8_t maxNeighborsInQuad = 4;
-    static constexpr uint8_t maxNeighbors = 8;
     static constexpr std::array<Vec2, 8> directions = {
         Vec2(1.0f, -1.0f), //northeast
         Vec2(0.0f, -1.0f), //north
@@ -134,19 +136,55 @@ private:
         Vec2(1.0f, 0.0f), //east
     };
 
+    struct Candidate {
+        float distanceSquared;
+        Neighbor neighbor;
+    };
+
+    /**
+     * The k nearest neighbors found so far as a max heap, ties are broken by id so the result doesn't depend on the order leaves are visited in.
+     */
+    struct NearestSearch {
+        std::array<Candidate, maxNeighbors> candidates;
+        uint8_t count = 0;
+    };
+
     using QuadTreeObjectPairSet = std::unordered_set<QuadTreeObjectPair, QuadTreeObjectPairHash>;
-    using QuadTreeObjectSet = std::unordered_set<QuadTreeObject, QuadTreeObjectHash>;
-
-    void subdivide();
-    std::vector<QuadTreeObject> undivideInternal();
-    void insertIntoSubTree(const QuadTreeObject& object);
-    void getIntersectionsInternal(QuadTreeObjectPairSet* collisionsPtr) const;
-    void queryInternal(const QuadTreeObject& object, QuadTreeObjectSet* collisionsPtr) const;
-    void getNearestNeighborsInternal(const QuadTreeObject& object, QuadTreeObjectSet* neighborsPtr) const;
-    [[nodiscard]] std::vector<std::pair<uint64_t, Vec2>> raycastInternal(
-            const QuadTreeObject& object,
-            const Vec2& velocityCopy,
-            const float rayDistance) const;
-    [[nodiscard]] SDL_FRect getRay(const Vec2& direction, const QuadTreeObject& object, float rayDistance) const;
+
+    void subdivide(uint32_t nodeIndex);
+    void queueUndivide(uint32_t nodeIndex);
+    bool mergeChildren(uint32_t nodeIndex);
+    void insertInternal(uint32_t nodeIndex, const QuadTreeObject& object);
+    void insertIntoSubTree(uint32_t nodeIndex, const QuadTreeObject& object);
+    void appendObject(uint32_t nodeIndex, const QuadTreeObject& object);
+    void unlinkObject(uint32_t entryIndex);
+    void detachFromObjectChain(uint32_t entryIndex);
+    void freeObjects(uint32_t nodeIndex);
+    [[nodiscard]] uint32_t getCommonAncestor(const SDL_FRect& rect) const;
+    void collectLeaves(uint32_t nodeIndex, const SDL_FRect& rect, std::vector<uint32_t>* leavesPtr) const;
+    [[nodiscard]] bool leafContains(uint32_t nodeIndex, uint64_t id) const;
+    /**
+     * Objects are found by the slot index of their handle with the kind folded in, so handles of different slot maps
+     * sharing an index get their own chains.
+     */
+    [[nodiscard]] static size_t getChainSlot(const uint64_t id) {
+        return static_cast<size_t>(SlotHandle::getIndex(id)) * static_cast<size_t>(EntityKind::SIZE) + SlotHandle::getKind(id);
+    }
+    /**
+     * @return the head of the object's chain, nullptr if the object isn't in the tree.
+     */
+    [[nodiscard]] uint32_t* getChainHead(uint64_t id);
+    [[nodiscard]] const uint32_t* getChainHead(uint64_t id) const;
+    [[nodiscard]] size_t sizeInternal(uint32_t nodeIndex) const;
+    void getIntersectionsInternal(uint32_t nodeIndex, QuadTreeObjectPairSet* collisionsPtr) const;
+    void queryInternal(uint32_t nodeIndex, const QuadTreeObject& object, std::vector<uint64_t>* idsPtr) const;
+    [[nodiscard]] static bool isCloserCandidate(const Candidate& candidate1, const Candidate& candidate2);
+    //the children of a node a traversal visits, each with the distance that decides the order they're visited in
+    using ChildOrder = std::array<std::pair<float, uint32_t>, 4>;
+    static void sortChildren(ChildOrder* childrenPtr, uint8_t childCount);
+    void getNearestNeighborsInternal(uint32_t nodeIndex, const QuadTreeObject& object, NearestSearch* searchPtr) const;
+    void castRayInternal(uint32_t nodeIndex, const QuadTreeObject& object, const Vec2& direction, const SDL_FRect& ray,
+        std::span<RayHit> hits, uint8_t* countPtr) const;
+    void showInternal(uint32_t nodeIndex, SDL_Renderer* rendererPtr) const;
 };
 #endif //QUADTREE_HPP
@@ -0,0 +1,113 @@
+#ifndef RENDERSNAPSHOT_HPP
+#define RENDERSNAPSHOT_HPP
+
+#include "SDL3/SDL.h"
+#include "SpatialIndex.hpp"
+#include "UtilityStructs.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * The cells of the heat or atmosphere map, relative to the top left of the simulation bounds.
+ * Rebuilt by the simulation whenever the map changes and shared by every snapshot until then, so the render thread
+ * only redraws its texture of the map when it gets a new one.
+ */
+struct MapImage {
+    int width = 0;
+    int height = 0;
+    std::vector<SDL_FRect> cells;
+    std::vector<SDL_Color> colors;
+};
+
+/**
+ * Everything the render thread draws for one frame, copied out of the simulation so it can be drawn while the simulation keeps stepping.
+ */
+struct RenderSnapshot {
+    struct Shape {
+        SDL_FRect box;
+        SDL_Color color;
+        EntityKind kind;
+    };
+    struct FireSprite {
+        SDL_FRect box;
+        //seconds since the fire started burning, the render thread picks the animation frame from it
+        float animationTime;
+    };
+
+    //food, pheromones then organisms, drawn in this order
+    std::vector<Shape> shapes;
+    //three vertices for the direction triangle of every organism
+    std::vector<SDL_Vertex> triangles;
+    std::vector<FireSprite> fires;
+    SDL_Rect simBounds{};
+    bool showFoodSpawnRange = false;
+    SDL_Rect foodSpawnRange{};
+    //nullptr while hidden
+    std::shared_ptr<const MapImage> heatMapPtr;
+    std::shared_ptr<const MapImage> atmosphereMapPtr;
+    std::shared_ptr<const SpatialIndex> spatialIndexPtr;
+    std::shared_ptr<const SpatialIndex> staticSpatialIndexPtr;
+    uint32_t population = 0;
+    uint64_t generation = 0;
+    size_t quadSize = 0;
+
+    void clear() {
+        shapes.clear();
+        triangles.clear();
+        fires.clear();
+    }
+};
+
+/**
+ * Two snapshots handed between the simulation thread and the render thread.
+ * The simulation fills the back snapshot only once the render thread has drawn the front one, so it never copies
+ * frames nobody draws, and swaps them in publish. The render thread holds the lock only while it draws the front one.
+ */
+class RenderBuffer {
+public:
+    /**
+     * Called on the simulation thread.
+     * @return whether the render thread has drawn the last published snapshot and wants a new one.
+     */
+    [[nodiscard]] bool isWanted() const {return wanted.load(std::memory_order_acquire);}
+    /**
+     * Called on the simulation thread, the snapshot to fill before publish. Only the simulation thread swaps, so it
+     * can read front without the lock.
+     */
+    RenderSnapshot& getBack() {return snapshots[1 - front];}
+    void publish() {
+        const std::lock_guard lock(mutex);
+        front = 1 - front;
+        hasPublished = true;
+        wanted.store(false, std::memory_order_release);
+    }
+
+    /**
+     * Called on the render thread, calls func with the newest snapshot while the simulation can't swap it out.
+     * @return false if nothing was published yet and func wasn't called.
+     */
+    template<typename Func>
+    bool read(Func&& func) {
+        {
+            const std::lock_guard lock(mutex);
+            if(!hasPublished) return false;
+            func(static_cast<const RenderSnapshot&>(snapshots[front]));
+        }
+        wanted.store(true, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<RenderSnapshot, 2> snapshots;
+    size_t front = 0;
+    bool hasPublished = false;
+    std::mutex mutex;
+    std::atomic<bool> wanted = true;
+};
+
+#endif //RENDERSNAPSHOT_HPP
@@ -1,7 +1,6 @@
 #include "SimObject.hpp"
+#include "RenderSnapshot.hpp"
 
-void SimObject::render(SDL_Renderer* renderer) const {
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    const SDL_FRect organismRect = {boundingBox.x, boundingBox.y, boundingBox.w, boundingBox.h};
-    SDL_RenderFillRect(renderer, &organismRect);
-}
\ No newline at end of file
+void SimObject::addToRenderSnapshot(RenderSnapshot* snapshotPtr) const {
+    snapshotPtr->shapes.push_back({boundingBox, color, kind});
+}
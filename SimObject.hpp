@@ -2,35 +2,51 @@
 #define SIMOBJECT_HPP
 
 #include "SimUtils.hpp"
-#include "QuadTree.hpp"
+#include "SpatialIndex.hpp"
 #include "SDL3/SDL.h"
 #include <cstdint>
 #include <memory>
 #include <utility>
 
+struct RenderSnapshot;
+
 class SimObject {
 public:
-    SimObject(const uint64_t id, const SDL_FRect& boundingBox, SimUtils::SimState simState, const bool inQuadTree) :
+    SimObject(const uint64_t id, const EntityKind kind, const SDL_FRect& boundingBox, SimUtils::SimState simState, const bool inQuadTree) :
     id(id),
+    kind(kind),
     color({0, 0, 0, 255}),
     boundingBox(boundingBox),
     simState(std::move(simState)),
     inQuadTree(inQuadTree) {}
-    SimObject(const uint64_t id, const SDL_FRect& boundingBox, const SDL_Color& initialColor, SimUtils::SimState simState, const bool inQuadTree) :
+    SimObject(const uint64_t id, const EntityKind kind, const SDL_FRect& boundingBox, const SDL_Color& initialColor, SimUtils::SimState simState, const bool inQuadTree) :
     id(id),
+    kind(kind),
     boundingBox(boundingBox),
     color(initialColor),
     simState(std::move(simState)),
     inQuadTree(inQuadTree) {}
     virtual ~SimObject() = default;
+    SimObject(const SimObject&) = default;
+    SimObject(SimObject&&) noexcept = default;
+    SimObject& operator=(const SimObject&) = default;
+    SimObject& operator=(SimObject&&) noexcept = default;
 
     [[nodiscard]] uint64_t getID() const {return id;}
+    [[nodiscard]] EntityKind getKind() const {return kind;}
+    [[nodiscard]] SpatialIndex::Object getQuadTreeObject(const bool isHighPriority = false) const {
+        return {id, kind, boundingBox, isHighPriority};
+    }
+    //the entry for this object at a bounding box it doesn't have yet
+    [[nodiscard]] SpatialIndex::Object getQuadTreeObject(const SDL_FRect& atBoundingBox) const {
+        return {id, kind, atBoundingBox};
+    }
     [[nodiscard]] SDL_FRect getBoundingBox() const {return boundingBox;}
     [[nodiscard]] virtual Vec2 getPosition() const {return {boundingBox.x, boundingBox.y};}
     void setBoundingBox(const SDL_FRect& newBoundingBox) {boundingBox = newBoundingBox;}
     [[nodiscard]] SDL_Color getColor() const {return color;}
     void setColor(const SDL_Color& newColor) {color = newColor;}
-    void newQuadTree(const std::shared_ptr<QuadTree>& quadTreePtr) {this->simState.quadTreePtr = quadTreePtr;}
+    void newSpatialIndex(const std::shared_ptr<SpatialIndex>& spatialIndexPtr) {this->simState.spatialIndexPtr = spatialIndexPtr;}
 
     void markForDeletion() {markedForDeletion = true;}
     [[nodiscard]] bool shouldDelete() const {return markedForDeletion;}
@@ -38,11 +54,15 @@ public:
 
     virtual void update(const float deltaTime) {}
     virtual void fixedUpdate() {}
-    virtual void render(SDL_Renderer* rendererPtr) const;
+    /**
+     * Copies what the render thread draws of this object into snapshotPtr, a rectangle in its color by default.
+     */
+    virtual void addToRenderSnapshot(RenderSnapshot* snapshotPtr) const;
 
 protected:
     SimUtils::SimState simState;
     uint64_t id;
+    EntityKind kind;
     SDL_FRect boundingBox;
     SDL_Color color;
     bool markedForDeletion = false;
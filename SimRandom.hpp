@@ -0,0 +1,75 @@
+#ifndef SIMRANDOM_HPP
+#define SIMRANDOM_HPP
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace SimRandom {
+
+    //top level streams split off a simulation's root stream, one per part of the simulation drawing random numbers
+    enum class Subsystem : uint64_t {
+        MAP,
+        FOOD,
+        FIRE,
+        PHEROMONE,
+        ORGANISM,
+        REPRODUCTION,
+        MUTATION,
+        SIZE
+    };
+
+    static constexpr uint64_t golden = 0x9E3779B97F4A7C15ULL;
+
+    //splitmix64 finalizer
+    static constexpr uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    /**
+     * A counter based random number stream, the n-th output is a pure function of the stream key and n.
+     * Streams are split into independent child streams instead of being shared, so each organism and subsystem owns its
+     * own stream, whichever thread draws from it, and a whole simulation can be replayed from a single seed.
+     * Satisfies UniformRandomBitGenerator so it can be used with the std distributions.
+     */
+    class Stream {
+    public:
+        using result_type = uint64_t;
+
+        Stream() = default;
+        explicit Stream(const uint64_t seed) : key(mix(seed)) {}
+
+        [[nodiscard]] Stream split(const uint64_t streamID) const {
+            Stream child;
+            child.key = mix(key ^ mix((streamID + 1) * golden));
+            return child;
+        }
+        [[nodiscard]] Stream split(const Subsystem subsystem) const {
+            return split(static_cast<uint64_t>(subsystem));
+        }
+
+        result_type operator()() {
+            return mix(key + (++counter * golden));
+        }
+        void discard(const uint64_t amount) {counter += amount;}
+
+        static constexpr result_type min() {return std::numeric_limits<result_type>::min();}
+        static constexpr result_type max() {return std::numeric_limits<result_type>::max();}
+
+    private:
+        uint64_t key = 0;
+        uint64_t counter = 0;
+    };
+
+    /**
+     * @return a non-deterministic seed for runs that don't ask for a specific one.
+     */
+    inline uint64_t randomSeed() {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) | static_cast<uint64_t>(device());
+    }
+}
+
+#endif //SIMRANDOM_HPP
@@ -1,7 +0,0 @@
-#include "SimUtils.hpp"
-
-#include <random>
-
-namespace SimUtils {
-    std::mt19937 mt{std::random_device{}()};
-}
\ No newline at end of file
@@ -1,30 +1,24 @@
 #ifndef SIMUTILS_HPP
 #define SIMUTILS_HPP
 
-#include "QuadTree.hpp"
+#include "SpatialIndex.hpp"
 #include <cmath>
 #include <functional>
-#include <random>
 
-class SimObject;
+class EntityStore;
 
 namespace SimUtils {
-    extern std::mt19937 mt;
-
     struct SimState {
-        std::function<void (uint64_t otherID)>* markDeleteFuncPtr;
-        std::function<std::shared_ptr<SimObject> (uint64_t id)>* getFuncPtr;
-        std::shared_ptr<QuadTree> quadTreePtr;
+        EntityStore* entitiesPtr;
+        std::shared_ptr<SpatialIndex> spatialIndexPtr;
         std::shared_ptr<SDL_Rect> simBoundsPtr;
 
         SimState(
-            std::function<void (uint64_t otherID)>* markDeleteFuncPtr,
-            std::function<std::shared_ptr<SimObject> (uint64_t id)>* getFuncPtr,
-            const std::shared_ptr<QuadTree>& quadTreePtr,
+            EntityStore* entitiesPtr,
+            const std::shared_ptr<SpatialIndex>& spatialIndexPtr,
             const std::shared_ptr<SDL_Rect>& initialSimBoundsPtr) :
-            markDeleteFuncPtr(markDeleteFuncPtr),
-            getFuncPtr(getFuncPtr),
-            quadTreePtr(quadTreePtr),
+            entitiesPtr(entitiesPtr),
+            spatialIndexPtr(spatialIndexPtr),
             simBoundsPtr(initialSimBoundsPtr) {}
     };
 
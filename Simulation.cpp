@@ -1,5 +1,5 @@
 #include "Simulation.hpp"
-#include "QuadTree.hpp"
+#include "SpatialIndex.hpp"
 #include "UIStructs.hpp"
 #include "Organism.hpp"
 #include "StaticSimObjects.hpp"
@@ -9,42 +9,42 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <type_traits>
 
-Simulation::Simulation(SDL_Renderer* rendererPtr, const SDL_Rect& simBounds, const uint16_t maxPopulation, const int genomeSize, const float initialMutationFactor = 0.25f) :
-    rendererPtr(rendererPtr),
+Simulation::Simulation(const SDL_Rect& simBounds, const uint32_t maxPopulation, const int genomeSize, const float initialMutationFactor, const uint64_t seed, const SpatialIndexType spatialIndexType, const size_t workerCount) :
+    seed(seed),
+    streams(createStreams(seed)),
     simBoundsPtr(std::make_shared<SDL_Rect>(simBounds)),
     maxPopulation(maxPopulation),
     maxFood(maxPopulation),
     maxPheromones(maxPopulation),
     mutationFactor((initialMutationFactor >= 0.0f && initialMutationFactor <= 1.0f) ? initialMutationFactor : 0.25f),
-    quadTreePtr(std::make_shared<QuadTree>(SimUtils::rectToFRect(simBounds), 10)),
-    simState(&markForDeletionLambda, &getLambda, quadTreePtr, simBoundsPtr),
+    spatialIndexPtr(SpatialIndex::create(spatialIndexType, SimUtils::rectToFRect(simBounds))),
+    staticSpatialIndexPtr(SpatialIndex::create(spatialIndexType, SimUtils::rectToFRect(simBounds))),
+    broadphase(SimUtils::rectToFRect(simBounds)),
+    simState(&entities, spatialIndexPtr, simBoundsPtr),
     foodSpawnRange(SDL_Rect{(simBoundsPtr->x + simBoundsPtr->w) - 150, simBoundsPtr->y, 150, simBoundsPtr->h}),
-    renderFoodSpawnRange(foodSpawnRange)
+    renderFoodSpawnRange(foodSpawnRange),
+    threadPool(workerCount),
+    neighborTasks(&threadPool)
 {
-    static SDL_Color color = {50, 0, 240, 255};
-
-    for (int i = 0; i < maxPopulation; i++) {
-        const uint64_t id = getRandomID();
+    entities.reserveOrganisms(maxPopulation);
+    for (uint32_t i = 0; i < maxPopulation; i++) {
         const Vec2 initialPosition = getRandomPoint();
         const SDL_FRect boundingBox{
             initialPosition.x, initialPosition.y, organismWidth, organismHeight
         };
-        addOrganism(id, genomeSize, color, boundingBox);
-        color.r += 10;
-        color.b += 15;
+        addOrganism(genomeSize, getNextOrganismColor(), boundingBox);
     }
     const uint16_t foodAdded = addFood();
     addFoodSpawnRange(foodAdded);
     generateHeatMap();
     generateAtmosphereMap();
-    startWorkerThread();
 }
 
 Simulation::~Simulation() {
-    if(heatMapTexture) SDL_DestroyTexture(heatMapTexture);
-    if(atmosphereMapTexture) SDL_DestroyTexture(atmosphereMapTexture);
-    stopWorkerThread();
+    //the neighbor task reads this simulation's members, it has to finish before they're destroyed
+    neighborTasks.wait();
 }
 
 SDL_Color Simulation::heatValToColor(uint8_t heatVal) {
@@ -83,273 +83,437 @@ SDL_Color Simulation::atmosphereValToColor(uint8_t atmosphereVal) {
 }
 
 void Simulation::generateAtmosphereMap() {
-    if(atmosphereMapTexture) SDL_DestroyTexture(atmosphereMapTexture);
     if(!atmosphereMap.empty()) atmosphereMap.clear();
-    atmosphereMapTexture = SDL_CreateTexture(rendererPtr, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, simBoundsPtr->w, simBoundsPtr->h);
     std::uniform_int_distribution<uint8_t> distAtmosphere(0, UINT8_MAX);
 
-    SDL_SetRenderTarget(rendererPtr, atmosphereMapTexture);
-    SDL_SetRenderDrawColor(rendererPtr, 255, 255, 255, 100);
-    SDL_RenderClear(rendererPtr);
     for(int x = simBoundsPtr->x; x < simBoundsPtr->x + simBoundsPtr->w; x += atmosphereMapGridSize) { //if simbounds !start at 0 we could miss factors organisms may hash to
         for(int y = simBoundsPtr->y; y < simBoundsPtr->y + simBoundsPtr->h; y += atmosphereMapGridSize) {
             Vec2 position(static_cast<float>(x), static_cast<float>(y), atmosphereMapGridSize);
-            SDL_FRect rect{position.x - static_cast<float>(simBoundsPtr->x), position.y - static_cast<float>(simBoundsPtr->y), atmosphereMapGridSize, atmosphereMapGridSize};
-            uint8_t atmosphereVal = distAtmosphere(SimUtils::mt);
-            SDL_Color color = atmosphereValToColor(atmosphereVal);
-            atmosphereMap.insert(std::make_pair(position, atmosphereVal));
-            SDL_SetRenderDrawColor(rendererPtr, color.r, color.g, color.b, color.a);
-            SDL_RenderFillRect(rendererPtr, &rect);
+            atmosphereMap.insert(std::make_pair(position, distAtmosphere(getStream(SimRandom::Subsystem::MAP))));
         }
     }
-    SDL_SetRenderTarget(rendererPtr, NULL);
+    atmosphereMapImagePtr = createMapImage(atmosphereMap, atmosphereMapGridSize, atmosphereValToColor);
+}
+
+/**
+ * Lays out the cells of a map relative to the top left of the simulation bounds, cells outside of them are clipped when drawn.
+ */
+std::shared_ptr<const MapImage> Simulation::createMapImage(
+        const std::unordered_map<Vec2, uint8_t, Vec2PositionalHash, Vec2PositionalEqual>& map,
+        const float gridSize,
+        SDL_Color (*valToColor)(uint8_t)) const {
+    auto imagePtr = std::make_shared<MapImage>();
+    imagePtr->width = simBoundsPtr->w;
+    imagePtr->height = simBoundsPtr->h;
+    imagePtr->cells.reserve(map.size());
+    imagePtr->colors.reserve(map.size());
+    for(const auto& [position, val] : map) {
+        imagePtr->cells.push_back({
+            position.x - static_cast<float>(simBoundsPtr->x),
+            position.y - static_cast<float>(simBoundsPtr->y),
+            gridSize,
+            gridSize});
+        imagePtr->colors.push_back(valToColor(val));
+    }
+    return imagePtr;
 }
 
 void Simulation::generateHeatMap() {
-    if(heatMapTexture) SDL_DestroyTexture(heatMapTexture);
     if(!heatMap.empty()) heatMap.clear();
-    heatMapTexture = SDL_CreateTexture(rendererPtr, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, simBoundsPtr->w, simBoundsPtr->h);
     std::uniform_int_distribution<uint8_t> distHeat(0, UINT8_MAX);
 
-    SDL_SetRenderTarget(rendererPtr, heatMapTexture);
-    SDL_SetRenderDrawColor(rendererPtr, 255, 255, 255, 100);
-    SDL_RenderClear(rendererPtr);
     for(int x = 0; x < simBoundsPtr->x + simBoundsPtr->w; x += heatMapGridSize) {
         for(int y = 0; y < simBoundsPtr->y + simBoundsPtr->h; y += heatMapGridSize) {
             const Vec2 position(static_cast<float>(x), static_cast<float>(y), heatMapGridSize);
-            const SDL_FRect rect{
-                position.x - static_cast<float>(simBoundsPtr->x),
-                position.y - static_cast<float>(simBoundsPtr->y),
-                heatMapGridSize,
-                heatMapGridSize};
-            uint8_t heatVal = distHeat(SimUtils::mt);
-            const SDL_Color color = heatValToColor(heatVal);
-            heatMap.insert(std::make_pair(position, heatVal));
-            SDL_SetRenderDrawColor(rendererPtr, color.r, color.g, color.b, color.a);
-            SDL_RenderFillRect(rendererPtr, &rect);
+            heatMap.insert(std::make_pair(position, distHeat(getStream(SimRandom::Subsystem::MAP))));
         }
     }
-    SDL_SetRenderTarget(rendererPtr, NULL);
+    heatMapImagePtr = createMapImage(heatMap, heatMapGridSize, heatValToColor);
+}
+
+Simulation::SubsystemStreams Simulation::createStreams(const uint64_t seed) {
+    const SimRandom::Stream root(seed);
+    SubsystemStreams result;
+    for(size_t i = 0; i < result.size(); i++) {
+        result[i] = root.split(static_cast<SimRandom::Subsystem>(i));
+    }
+    return result;
 }
 
-Vec2 Simulation::getRandomPoint() const {
+Vec2 Simulation::getRandomPoint() {
+    SimRandom::Stream& rng = getStream(SimRandom::Subsystem::ORGANISM);
     std::uniform_int_distribution<int> distX(simBoundsPtr->x, simBoundsPtr->x + simBoundsPtr->w);
     std::uniform_int_distribution<int> distY(simBoundsPtr->y, simBoundsPtr->y + simBoundsPtr->h);
-    return {static_cast<float>(distX(SimUtils::mt)), static_cast<float>(distY(SimUtils::mt))};
+    return {static_cast<float>(distX(rng)), static_cast<float>(distY(rng))};
 }
 
-uint64_t Simulation::getRandomID() {
-    static std::uniform_int_distribution<uint64_t> distID(0, UINT64_MAX - 1);
-    return distID(SimUtils::mt);
+bool Simulation::shouldMutate() {
+    std::bernoulli_distribution distBool(mutationFactor);
+    return distBool(getStream(SimRandom::Subsystem::MUTATION));
 }
-bool Simulation::shouldMutate() const {
-    static std::bernoulli_distribution distBool(mutationFactor);
-    return distBool(SimUtils::mt);
+
+SDL_Color Simulation::getNextOrganismColor() {
+    const SDL_Color color = nextOrganismColor;
+    nextOrganismColor.r += 10;
+    nextOrganismColor.b += 15;
+    return color;
 }
 
-void Simulation::render() {
-    SDL_FRect simBoundsFRect = SimUtils::rectToFRect(*simBoundsPtr);
-    if(heatMapVisible) SDL_RenderTexture(rendererPtr, heatMapTexture, NULL, &simBoundsFRect);
-    if(atmosphereMapVisible) SDL_RenderTexture(rendererPtr, atmosphereMapTexture, NULL, &simBoundsFRect);
-    if(currUserAction == UserActionType::CHANGE_FOOD_RANGE) {
-        SDL_SetRenderDrawColor(rendererPtr, 255, 255, 0, 100);
-        SDL_FRect foodSpawnRangeFloat = SimUtils::rectToFRect(renderFoodSpawnRange);
-        SDL_RenderFillRect(rendererPtr, &foodSpawnRangeFloat);
-    }
-    for(const auto & [id, objectPtr]: simObjects) {
-        objectPtr->render(rendererPtr);
-    }
-    if(quadTreeVisible) quadTreePtr->show(rendererPtr);
+void Simulation::writeRenderSnapshot(RenderSnapshot* snapshotPtr) const {
+    snapshotPtr->clear();
+    snapshotPtr->simBounds = *simBoundsPtr;
+    snapshotPtr->heatMapPtr = heatMapVisible ? heatMapImagePtr : nullptr;
+    snapshotPtr->atmosphereMapPtr = atmosphereMapVisible ? atmosphereMapImagePtr : nullptr;
+    snapshotPtr->showFoodSpawnRange = currUserAction == UserActionType::CHANGE_FOOD_RANGE;
+    snapshotPtr->foodSpawnRange = renderFoodSpawnRange;
+    for(const Food& food : entities.foods) food.addToRenderSnapshot(snapshotPtr);
+    for(const Pheromone& pheromone : entities.pheromones) pheromone.addToRenderSnapshot(snapshotPtr);
+    for(const Organism& organism : entities.organisms) organism.addToRenderSnapshot(snapshotPtr);
+    for(const Fire& fire : entities.fires) fire.addToRenderSnapshot(snapshotPtr);
+    //the clones taken for the neighbor task, they're never changed so the render thread can draw them as they are
+    snapshotPtr->spatialIndexPtr = quadTreeVisible ? snapshotSpatialIndexPtr : nullptr;
+    snapshotPtr->staticSpatialIndexPtr = quadTreeVisible ? snapshotStaticSpatialIndexPtr : nullptr;
+    snapshotPtr->population = population;
+    snapshotPtr->generation = generationNum;
+    snapshotPtr->quadSize = getQuadSize();
 }
 
 void Simulation::update(const SDL_Rect& newSimBounds, const float deltaTime) {
+    applyNeighborResults();
     tryUpdateSimBounds(newSimBounds);
     currUserActionFunc();
 
     if(paused) return;
 
-    handleTimers(deltaTime);
-
-    for(auto itr = simObjects.begin(); itr != simObjects.end();) {
-        const uint64_t id = itr->first;
-        std::shared_ptr<SimObject> objectPtr = itr->second;
-        std::shared_ptr<Organism> organismPtr = nullptr;
-        const auto foodPtr = std::dynamic_pointer_cast<Food>(objectPtr);
-        const auto pheromonePtr = std::dynamic_pointer_cast<Pheromone>(objectPtr);
-
-        //if(foodPtr || pheromonePtr) //maybe remove fires from quadtree and check all fire collisions this way
-        //    for(const auto& [fireID, firePtr] : fires)
-        //        if(QuadTree::rangeIntersectsRect(firePtr->getBoundingBox(), objectPtr->getBoundingBox()))
-        //            objectPtr->markForDeletion();
+    {
+        TickProfiler::ScopedTimer timer(profilerPtr.get(), ProfilerPhase::TIMERS);
+        handleTimers(deltaTime);
+    }
 
-        if(organisms.contains(id)) {
-            organismPtr = organisms[id];
-            setMapVals(organismPtr);
+    {
+        TickProfiler::LapTimer lapTimer(profilerPtr.get());
+        OrganismComponents& components = entities.organismComponents;
+        Organism::updateTimers(components, deltaTime);
+        lapTimer.lap(ProfilerPhase::OBJECT_UPDATE);
+
+        //read only phase: every organism only writes its own row and state, so the chunks run on the pool in any order,
+        //the laps of all threads add up so these phases show the time summed over the threads
+        threadPool.parallelFor(entities.organisms.size(), organismChunkSize, [this](const size_t begin, const size_t end) {
+            TickProfiler::LapTimer chunkTimer(profilerPtr.get());
+            for(size_t i = begin; i < end; i++) {
+                Organism& organism = entities.organisms[i];
+                chunkTimer.skip();
+                setMapVals(organism, i);
+                chunkTimer.lap(ProfilerPhase::MAP_VALUES);
+
+                organism.sense(i);
+                chunkTimer.lap(ProfilerPhase::OBJECT_UPDATE);
+            }
+            chunkTimer.skip();
+            entities.neuralBatch.evaluate(begin, end);
+            chunkTimer.lap(ProfilerPhase::NEURAL_NET);
+        });
+
+        //commit phase: eating marks shared food, so organisms act one after another in row order
+        lapTimer.skip();
+        for(size_t i = 0; i < entities.organisms.size(); i++) entities.organisms[i].act(deltaTime, i);
+        lapTimer.lap(ProfilerPhase::OBJECT_UPDATE);
+
+        lapTimer.skip();
+        Organism::applyMoves(components, deltaTime);
+        lapTimer.lap(ProfilerPhase::OBJECT_UPDATE);
+        clampOrganismsToBounds();
+        lapTimer.lap(ProfilerPhase::BOUNDS);
+
+        for(size_t i = 0; i < entities.organisms.size(); i++) {
+            Organism& organism = entities.organisms[i];
+            lapTimer.skip();
+            syncOrganismBoundingBox(organism, i);
+            lapTimer.lap(ProfilerPhase::BOUNDS);
+
+            organism.clearCollisions();
+            tryAddParent(organism);
+            lapTimer.lap(ProfilerPhase::PARENTS);
+            if(organism.isEmittingDangerPheromone()) addPheromones(organism);
+            lapTimer.lap(ProfilerPhase::PHEROMONES);
         }
 
-        objectPtr->update(deltaTime);
+        auto updateObjects = [this, deltaTime, &lapTimer](auto& store, const bool canMove) {
+            for(SimObject& object : store) {
+                lapTimer.skip();
+                object.update(deltaTime);
+                lapTimer.lap(ProfilerPhase::OBJECT_UPDATE);
+                if(!canMove) continue;
+                checkBounds(object);
+                lapTimer.lap(ProfilerPhase::BOUNDS);
+            }
+        };
+        //food, fires and food spawn ranges never move, their bounds are only checked when the simulation bounds change
+        updateObjects(entities.foods, false);
+        updateObjects(entities.pheromones, true);
+        updateObjects(entities.fires, false);
+        updateObjects(entities.foodSpawnRanges, false);
+    }
+
+    {
+        TickProfiler::ScopedTimer timer(profilerPtr.get(), ProfilerPhase::DELETION);
+        removeMarkedObjects();
+    }
 
-        if(organisms.contains(id)) {
-            organismPtr->clearCollisionIDs();
-            tryAddParent(organismPtr);
-            if(organismPtr->isEmittingDangerPheromone()) addPheromones(organismPtr);
+    TickProfiler::ScopedTimer timer(profilerPtr.get(), ProfilerPhase::COLLISIONS);
+    for(const SpatialIndex::Intersection& intersection : broadphase.getIntersections()) {
+        handleCollision(intersection);
+    }
+    staticSpatialIndexPtr->compact();
+    //static objects only touch each other when one is placed, a food spawn range added onto a fire burns like anything else
+    if(staticCollisionsDue) {
+        for(const SpatialIndex::Intersection& intersection : staticSpatialIndexPtr->getIntersections()) {
+            handleCollision(intersection);
+        }
+        staticCollisionsDue = false;
+    }
+    //organisms against the static objects
+    for(const Organism& organism : entities.organisms) {
+        if(!organism.isInQuadTree()) continue;
+        staticSpatialIndexPtr->findOverlapping(organism.getQuadTreeObject(), &staticOverlapScratch);
+        for(const uint64_t id : staticOverlapScratch) {
+            const SimObject* staticObjectPtr = entities.get(id);
+            if(!staticObjectPtr) continue;
+            handleCollision({organism.getID(), EntityKind::ORGANISM, id, staticObjectPtr->getKind()});
         }
-        checkBounds(objectPtr);
-
-        SDL_LockMutex(workerMutex);
-        if (objectPtr->shouldDelete()) {
-            quadTreePtr->remove(QuadTree::QuadTreeObject(id, objectPtr->getBoundingBox()));
-            if (organismPtr) {
-                organisms.erase(id);
-                population--;
-            }
-            if (foodPtr) {
-                removeFromFoodMap(foodPtr);
-                decrementFoodSpawnRange(foodPtr->getBoundingBox());
-                foodAmount--;
-            }
-            if(pheromonePtr) {
-                removeFromPheromoneMap(pheromonePtr);
-                pheromoneAmount--;
-            }
-            itr = simObjects.erase(itr);
-        }else ++itr;
-        SDL_UnlockMutex(workerMutex);
     }
+}
 
-    for(const auto& [id1, id2] : quadTreePtr->getIntersections()) {
-        handleCollision(id1, id2);
+/**
+ * Erases every object marked for deletion during this update, values are swapped out of the dense storage
+ * so the stores stay contiguous.
+ */
+template<typename SimObjectType, typename OnRemove>
+void Simulation::removeMarked(SlotMap<SimObjectType>& store, OnRemove&& onRemove) {
+    for(size_t i = 0; i < store.size();) {
+        SimObjectType& object = store[i];
+        if(!object.shouldDelete()) {
+            i++;
+            continue;
+        }
+        if(object.isInQuadTree()) removeFromSpatialIndex(object);
+        onRemove(object);
+        if constexpr(std::is_same_v<SimObjectType, Organism>) entities.eraseOrganismAt(i);
+        else store.eraseAt(i);
     }
 }
 
-void Simulation::tryAddParent(const std::shared_ptr<Organism> &organismPtr) {
+void Simulation::removeMarkedObjects() {
+    removeMarked(entities.organisms, [this](const Organism&) {population--;});
+    removeMarked(entities.foods, [this](const Food& food) {
+        removeFromFoodMap(food);
+        decrementFoodSpawnRange(food.getBoundingBox());
+        foodAmount--;
+    });
+    removeMarked(entities.pheromones, [this](const Pheromone& pheromone) {
+        removeFromPheromoneMap(pheromone);
+        pheromoneAmount--;
+    });
+    removeMarked(entities.fires, [](const Fire&) {});
+    removeMarked(entities.foodSpawnRanges, [](const FoodSpawnRange&) {});
+}
+
+void Simulation::tryAddParent(const Organism& organism) {
     if (
-        organismPtr->shouldReproduce() &&
-        std::find(nextGenParents.begin(), nextGenParents.end(), organismPtr) == nextGenParents.end()
+        organism.shouldReproduce() &&
+        std::none_of(nextGenParents.begin(), nextGenParents.end(), [&organism](const Organism::Parent& parent) {
+            return parent.id == organism.getID();
+        })
     ) {
-        nextGenParents.push_back(organismPtr);
+        nextGenParents.push_back(organism.copyAsParent());
     }
 }
 
-void Simulation::setMapVals(const std::shared_ptr<Organism>& organismPtr) {
-    const Vec2 organismPosition = organismPtr->getPosition();
+void Simulation::setMapVals(Organism& organism, const size_t row) {
+    const Vec2 organismPosition = organism.getPosition();
     const Vec2 organismPositionHeatMap(organismPosition.x, organismPosition.y, heatMapGridSize);
     const Vec2 organismPositionAtmosphereMap(organismPosition.x, organismPosition.y, atmosphereMapGridSize);
     if(foodMap.contains(organismPosition)) {
         auto range = foodMap.equal_range(organismPosition);
         for(auto foodItr = range.first; foodItr != range.second; ++foodItr){
-            organismPtr->addCollisionID(foodItr->second->getID());
+            organism.addCollision(foodItr->second, EntityKind::FOOD);
         }
-        slowInFood(organismPtr);
+        slowInFood(row);
     }
-    if(pheromoneMap.contains(organismPosition)) {organismPtr->setDetectedDangerPheromone(true);}
-    if(heatMap.contains(organismPositionHeatMap))
-        organismPtr->setTemperature(heatMap[organismPositionHeatMap]);
+    if(pheromoneMap.contains(organismPosition)) {organism.setDetectedDangerPheromone(true);}
+    //find rather than operator[], which may modify the map and isn't safe while other threads read it
+    if(const auto heatItr = heatMap.find(organismPositionHeatMap); heatItr != heatMap.end())
+        organism.setTemperature(heatItr->second);
     else SDL_Log("No heat map value for organism position");
-    if(atmosphereMap.contains(organismPositionAtmosphereMap)) {
-        const uint8_t atmosphereVal = atmosphereMap[organismPositionAtmosphereMap];
+    if(const auto atmosphereItr = atmosphereMap.find(organismPositionAtmosphereMap); atmosphereItr != atmosphereMap.end()) {
+        const uint8_t atmosphereVal = atmosphereItr->second;
         if(atmosphereVal > 128) {
-            organismPtr->setOxygenSat(static_cast<float>(atmosphereVal - 128) / 127.0f);
-            organismPtr->setHydrogenSat(0.0f);
+            organism.setOxygenSat(static_cast<float>(atmosphereVal - 128) / 127.0f);
+            organism.setHydrogenSat(0.0f);
         }else {
-            organismPtr->setHydrogenSat(static_cast<float>(atmosphereVal) / 128.0f);
-            organismPtr->setOxygenSat(0.0f);
+            organism.setHydrogenSat(static_cast<float>(atmosphereVal) / 128.0f);
+            organism.setOxygenSat(0.0f);
         }
     }else SDL_Log("No atmosphere map value for organism position");
 }
 
-void Simulation::startWorkerThread() {
-    workerMutex = SDL_CreateMutex();
-    workerCondition = SDL_CreateCondition();
+/**
+ * Starts the neighbor task on the thread pool unless it's still running, in which case it picks up the new snapshot itself.
+ */
+void Simulation::launchNeighborTask() {
+    if(neighborTaskRunning.exchange(true)) return;
+    neighborTasks.run([this]() {runNeighborTask();});
+    //without workers nobody else would ever run it
+    if(threadPool.getWorkerCount() == 0) neighborTasks.wait();
+}
+
+/**
+ * Finds the neighbors of the newest snapshot until no newer one was published, snapshots published in between are skipped.
+ */
+void Simulation::runNeighborTask() {
+    while(true) {
+        while(processedEpoch < publishedEpoch.load()) {
+            const std::shared_ptr<const WorldSnapshot> snapshotPtr = publishedSnapshot.load();
+            processedEpoch = snapshotPtr->epoch;
+            auto resultsIt = std::find_if(neighborResultsPool.begin(), neighborResultsPool.end(),
+                [](const std::shared_ptr<NeighborResults>& resultsPtr) {return resultsPtr.use_count() == 1;});
+            if(resultsIt == neighborResultsPool.end()) {
+                neighborResultsPool.push_back(std::make_shared<NeighborResults>());
+                resultsIt = std::prev(neighborResultsPool.end());
+            }
+            //pairs with the release of the last other owner, their reads of the old results happen before these writes
+            std::atomic_thread_fence(std::memory_order_acquire);
+            findNeighbors(*snapshotPtr, resultsIt->get(), &neighborOrderScratch, &threadPool);
+            publishedResults.store(*resultsIt);
+        }
+        neighborTaskRunning.store(false);
+        //a snapshot published after the check above saw the task still running and didn't launch another one
+        if(processedEpoch >= publishedEpoch.load() || neighborTaskRunning.exchange(true)) return;
+    }
+}
+
+/**
+ * Swaps the profiler phases are timed into, the neighbor task picks it up with the next snapshot.
+ */
+void Simulation::setProfiler(const std::shared_ptr<TickProfiler>& newProfilerPtr) {
+    if(!newProfilerPtr) return;
+    profilerPtr = newProfilerPtr;
+}
+
+/**
+ * Blocks until the neighbor task has finished the last snapshot published by fixedUpdate, helping it on this thread.
+ * Only needed when every update has to see the neighbors of the step before it, update itself never waits.
+ */
+void Simulation::waitForNeighborTask() {
+    neighborTasks.wait();
+}
 
-    threadData = std::make_shared<ThreadData>(
-        [this](){
-            while(true) {
-                SDL_LockMutex(workerMutex);
+/**
+ * Advances the simulation by one fixed step without rendering.
+ * The neighbor task is waited on so every update sees the neighbors computed for this step.
+ */
+void Simulation::step(const float fixedDeltaTime) {
+    step(fixedDeltaTime, *simBoundsPtr);
+}
 
-                while(!workAvailable && workerRunning) {
-                    SDL_WaitCondition(workerCondition, workerMutex);
-                }
+void Simulation::step(const float fixedDeltaTime, const SDL_Rect& simBounds) {
+    fixedUpdate();
+    waitForNeighborTask();
+    update(simBounds, fixedDeltaTime);
+}
 
-                if(!workerRunning) {
-                    SDL_UnlockMutex(workerMutex);
-                    break;
-                }
+/**
+ * Runs in the neighbor task, reads nothing but the snapshot and writes into results nobody else holds.
+ */
+void Simulation::findNeighbors(const WorldSnapshot& snapshot, NeighborResults* resultsPtr, std::vector<uint64_t>* orderPtr,
+    ThreadPool* threadPoolPtr) {
+    TickProfiler::ScopedTimer timer(snapshot.profilerPtr.get(), ProfilerPhase::NEIGHBOR_TASK);
+
+    resultsPtr->epoch = snapshot.epoch;
+    resultsPtr->organismIDs.assign(snapshot.organismIDs.begin(), snapshot.organismIDs.end());
+    resultsPtr->resize(snapshot.organismIDs.size());
+    snapshot.spatialIndexPtr->findAllNeighbors(snapshot.organismObjects, snapshot.organismVelocities, resultsPtr->getRows(), orderPtr,
+        snapshot.staticSpatialIndexPtr.get(), threadPoolPtr);
+}
 
-                neighborTask();
-                workAvailable = false;
-                SDL_UnlockMutex(workerMutex);
-            }
-        }
-    );
-
-    workerThread = SDL_CreateThread(
-            [](void* data) -> int{
-                auto* td(static_cast<ThreadData*>(data));
-                td->threadFunc();
-                return 0;
-            },
-            "NeighborsThread", static_cast<void*>(threadData.get()));
-}
-
-void Simulation::stopWorkerThread() {
-    SDL_LockMutex(workerMutex);
-    workerRunning = false;
-    SDL_SignalCondition(workerCondition);
-    SDL_UnlockMutex(workerMutex);
-
-    if(workerThread) SDL_WaitThread(workerThread, nullptr);
-    if(workerMutex) SDL_DestroyMutex(workerMutex);
-    if(workerCondition) SDL_DestroyCondition(workerCondition);
-    workerThread = nullptr, workerMutex = nullptr, workerCondition = nullptr;
-}
-
-void Simulation::neighborTask() {
-    if(!workerThreadQuadTreeCopy) return;
-
-    for(auto & [id, objectPtr]: simObjects) {
-        objectPtr->fixedUpdate();
-        if(organisms.contains(id)) {
-            const std::shared_ptr<Organism> organismPtr = organisms[id];
-            std::vector<std::pair<uint64_t, Vec2>> neighbors = workerThreadQuadTreeCopy->getNearestNeighbors(
-                    QuadTree::QuadTreeObject(
-                            organismPtr->getID(),
-                            organismPtr->getBoundingBox()));
-            std::vector<std::pair<uint64_t, Vec2>> raycastNeighbors = workerThreadQuadTreeCopy->raycast(
-                    QuadTree::QuadTreeObject(
-                            organismPtr->getID(),
-                            organismPtr->getBoundingBox()), organismPtr->getVelocity());
-            organismPtr->addNeighbors(neighbors);
-            organismPtr->addRaycastNeighbors(raycastNeighbors);
-        }
+/**
+ * Points every organism at its neighbors in the newest results the neighbor task published, if they're newer than the ones in use.
+ * Organisms born after the results' snapshot have no neighbors until the next results, organisms that died since are skipped.
+ */
+void Simulation::applyNeighborResults() {
+    std::shared_ptr<const NeighborResults> resultsPtr = publishedResults.load();
+    if(!resultsPtr || resultsPtr == neighborResultsPtr) return;
+
+    //organisms still point into the old results, which are released below
+    for(Organism& organism : entities.organisms) organism.clearNeighbors();
+    neighborResultsPtr = std::move(resultsPtr);
+    for(size_t row = 0; row < neighborResultsPtr->organismIDs.size(); row++) {
+        Organism* organismPtr = entities.organisms.get(neighborResultsPtr->organismIDs[row]);
+        if(!organismPtr) continue;
+        organismPtr->setNeighbors(neighborResultsPtr->getNeighbors(row), neighborResultsPtr->getRaycastNeighbors(row));
+    }
+}
+
+/**
+ * Copies what the neighbor task needs into a new snapshot, hands it over with an atomic swap and makes sure the task runs.
+ * The task may still be using an older snapshot, it is freed when the task lets go of it.
+ */
+void Simulation::publishSnapshot() {
+    auto snapshotPtr = std::make_shared<WorldSnapshot>();
+    snapshotPtr->epoch = publishedEpoch.load() + 1;
+    snapshotPtr->spatialIndexPtr = snapshotSpatialIndexPtr;
+    snapshotPtr->staticSpatialIndexPtr = snapshotStaticSpatialIndexPtr;
+    snapshotPtr->profilerPtr = profilerPtr;
+
+    const OrganismComponents& components = entities.organismComponents;
+    snapshotPtr->organismIDs.reserve(entities.organisms.size());
+    snapshotPtr->organismObjects.reserve(entities.organisms.size());
+    snapshotPtr->organismVelocities.reserve(entities.organisms.size());
+    for(size_t i = 0; i < entities.organisms.size(); i++) {
+        const Organism& organism = entities.organisms[i];
+        snapshotPtr->organismIDs.push_back(organism.getID());
+        snapshotPtr->organismObjects.push_back(organism.getQuadTreeObject());
+        snapshotPtr->organismVelocities.emplace_back(components.velocityX[i], components.velocityY[i]);
     }
+
+    publishedSnapshot.store(std::move(snapshotPtr));
+    publishedEpoch++;
+    launchNeighborTask();
 }
 
 void Simulation::fixedUpdate() {
     if(paused) return;
-    static int calls = 2;
-    SDL_LockMutex(workerMutex);
-    quadTreePtr->undivide();
-    if(calls >= 2) {
-        workerThreadQuadTreeCopy = std::make_unique<QuadTree>(*quadTreePtr);
-        calls = 0;
-    }else calls++;
-    workAvailable = true;
-    SDL_SignalCondition(workerCondition);
-    SDL_UnlockMutex(workerMutex);
+    TickProfiler::ScopedTimer timer(profilerPtr.get(), ProfilerPhase::FIXED_UPDATE);
+    Organism::decayVelocities(entities.organismComponents);
+    spatialIndexPtr->compact(&threadPool);
+    if(fixedUpdateCalls >= 2) {
+        snapshotSpatialIndexPtr = spatialIndexPtr->clone();
+        fixedUpdateCalls = 0;
+    }else fixedUpdateCalls++;
+    if(staticIndexChanged) {
+        staticSpatialIndexPtr->compact(&threadPool);
+        snapshotStaticSpatialIndexPtr = staticSpatialIndexPtr->clone();
+        staticIndexChanged = false;
+    }
+    for(Food& food : entities.foods) food.fixedUpdate();
+    for(Pheromone& pheromone : entities.pheromones) pheromone.fixedUpdate();
+    for(Fire& fire : entities.fires) fire.fixedUpdate();
+    for(FoodSpawnRange& foodSpawnRange : entities.foodSpawnRanges) foodSpawnRange.fixedUpdate();
+    publishSnapshot();
 }
 
 void Simulation::randomizeFoodParams() {
+    SimRandom::Stream& rng = getStream(SimRandom::Subsystem::FOOD);
     std::uniform_int_distribution<int> distX(simBoundsPtr->x, (simBoundsPtr->x + simBoundsPtr->w));
     std::uniform_int_distribution<int> distY(simBoundsPtr->y, (simBoundsPtr->y + simBoundsPtr->h));
 
     std::uniform_int_distribution<int> distFoodAmount(50, 100);
-    foodSpawnAmount = distFoodAmount(SimUtils::mt);
+    foodSpawnAmount = distFoodAmount(rng);
     if(foodAmount + foodSpawnAmount > maxFood) {
-        foodSpawnAmount = maxFood - foodAmount;
+        foodSpawnAmount = static_cast<uint16_t>(maxFood - foodAmount);
     }
 
-    int foodSpawnRangeX1 = distX(SimUtils::mt), foodSpawnRangeX2 = distX(SimUtils::mt) , foodSpawnRangeY1 = distY(SimUtils::mt), foodSpawnRangeY2 = distY(SimUtils::mt);
+    int foodSpawnRangeX1 = distX(rng), foodSpawnRangeX2 = distX(rng) , foodSpawnRangeY1 = distY(rng), foodSpawnRangeY2 = distY(rng);
     int foodSpawnRangeXMin = std::min(foodSpawnRangeX1, foodSpawnRangeX2), foodSpawnRangeXMax = std::max(foodSpawnRangeX1, foodSpawnRangeX2);
     int foodSpawnRangeYMin = std::min(foodSpawnRangeY1, foodSpawnRangeY2), foodSpawnRangeYMax = std::max(foodSpawnRangeY1, foodSpawnRangeY2);
     int foodSpawnRangeWidth = foodSpawnRangeXMax - foodSpawnRangeXMin, foodSpawnRangeHeight = foodSpawnRangeYMax - foodSpawnRangeYMin;
@@ -402,26 +566,26 @@ void Simulation::handleTimers(const float deltaTime) {
 }
 
 void Simulation::mutateOrganisms() {
-    for(const auto& [id, organismPtr] : organisms) {
+    for(Organism& organism : entities.organisms) {
         if(shouldMutate())
-            organismPtr->mutateGenome();
+            organism.mutateGenome();
     }
 }
 
-void Simulation::removeFromPheromoneMap(const std::shared_ptr<Pheromone>& pheromonePtr) {
-    auto range = pheromoneMap.equal_range(pheromonePtr->getPosition());
+void Simulation::removeFromPheromoneMap(const Pheromone& pheromone) {
+    auto range = pheromoneMap.equal_range(pheromone.getPosition());
     for(auto pheromoneItr = range.first; pheromoneItr != range.second; ++pheromoneItr) {
-        if(pheromonePtr->getID() == pheromoneItr->second->getID()) {
+        if(pheromone.getID() == pheromoneItr->second) {
             pheromoneMap.erase(pheromoneItr);
             break;
         }
     }
 }
 
-void Simulation::removeFromFoodMap(const std::shared_ptr<Food>& foodPtr) {
-    auto range = foodMap.equal_range(foodPtr->getPosition());
+void Simulation::removeFromFoodMap(const Food& food) {
+    auto range = foodMap.equal_range(food.getPosition());
     for(auto foodItr = range.first; foodItr != range.second; ++foodItr) {
-        if(foodPtr->getID() == foodItr->second->getID()) {
+        if(food.getID() == foodItr->second) {
             foodMap.erase(foodItr);
             break;
         }
@@ -429,46 +593,51 @@ void Simulation::removeFromFoodMap(const std::shared_ptr<Food>& foodPtr) {
 }
 
 void Simulation::incrementFoodSpawnRange(const SDL_FRect& foodBoundingBox) {
-    for(const auto& [foodSpawnAreaID, foodSpawnAreaPtr] : foodSpawnRanges) {
-        if(QuadTree::rangeIntersectsRect(foodBoundingBox, foodSpawnAreaPtr->getBoundingBox())) {
-            foodSpawnAreaPtr->incrementFoodAmount();
+    for(FoodSpawnRange& foodSpawnArea : entities.foodSpawnRanges) {
+        if(SpatialIndex::rangeIntersectsRect(foodBoundingBox, foodSpawnArea.getBoundingBox())) {
+            foodSpawnArea.incrementFoodAmount();
         }
     }
 }
 
 void Simulation::decrementFoodSpawnRange(const SDL_FRect& foodBoundingBox) {
-    for(const auto& [foodSpawnAreaID, foodSpawnAreaPtr] : foodSpawnRanges) {
-        if(QuadTree::rangeIntersectsRect(foodBoundingBox, foodSpawnAreaPtr->getBoundingBox())) {
-            foodSpawnAreaPtr->decrementFoodAmount();
+    for(FoodSpawnRange& foodSpawnArea : entities.foodSpawnRanges) {
+        if(SpatialIndex::rangeIntersectsRect(foodBoundingBox, foodSpawnArea.getBoundingBox())) {
+            foodSpawnArea.decrementFoodAmount();
         }
     }
 }
 
-void Simulation::addPheromones(const std::shared_ptr<Organism>& organismPtr) {
+void Simulation::addPheromones(const Organism& organism) {
     if(pheromoneAmount + pheromoneSpawnAmount > maxPheromones) return;
     pheromoneAmount += pheromoneSpawnAmount;
 
-    SDL_Rect boundingBox = SimUtils::fRecttoRect(organismPtr->getBoundingBox());
+    SimRandom::Stream& rng = getStream(SimRandom::Subsystem::PHEROMONE);
+    SDL_Rect boundingBox = SimUtils::fRecttoRect(organism.getBoundingBox());
     std::uniform_int_distribution<int> distVariance(10, 50);
-    std::uniform_int_distribution<int> distX(boundingBox.x - distVariance(SimUtils::mt), boundingBox.x + boundingBox.w + distVariance(SimUtils::mt)); //we should account for simbounds here but also probably doesn't matter
-    std::uniform_int_distribution<int> distY(boundingBox.y - distVariance(SimUtils::mt), boundingBox.y + boundingBox.h + distVariance(SimUtils::mt));
+    std::uniform_int_distribution<int> distX(boundingBox.x - distVariance(rng), boundingBox.x + boundingBox.w + distVariance(rng)); //we should account for simbounds here but also probably doesn't matter
+    std::uniform_int_distribution<int> distY(boundingBox.y - distVariance(rng), boundingBox.y + boundingBox.h + distVariance(rng));
 
     for(int i = 0; i < pheromoneSpawnAmount; i++) {
-        const uint64_t id = getRandomID();
-        const auto pheromonePtr = std::make_shared<Pheromone>(
-            id,
-            SDL_FRect{
-                static_cast<float>(distX(SimUtils::mt)),
-                static_cast<float>(distY(SimUtils::mt)),
-                pheromoneWidth,
-                pheromoneHeight
-            },
-            organismPtr->getColor(),
-            simState,
-            false
-        );
-        addSimObject(pheromonePtr);
-        pheromoneMap.insert(std::make_pair(pheromonePtr->getPosition(), pheromonePtr));
+        const SDL_FRect pheromoneBoundingBox{
+            static_cast<float>(distX(rng)),
+            static_cast<float>(distY(rng)),
+            pheromoneWidth,
+            pheromoneHeight
+        };
+        const uint64_t id = entities.pheromones.emplace([&](const uint64_t newID) {
+            return Pheromone(
+                newID,
+                pheromoneBoundingBox,
+                organism.getColor(),
+                simState,
+                rng.split(pheromonesSpawned++),
+                false
+            );
+        });
+        const Pheromone& pheromone = *entities.pheromones.get(id);
+        addToSpatialIndex(pheromone);
+        pheromoneMap.insert(std::make_pair(pheromone.getPosition(), id));
     }
 }
 
@@ -477,166 +646,205 @@ void Simulation::addFire() {
     std::uniform_int_distribution<int> distX(simBoundsPtr->x, (simBoundsPtr->x + simBoundsPtr->w) - 100);
     std::uniform_int_distribution<int> distY(simBoundsPtr->y, (simBoundsPtr->y + simBoundsPtr->h) - 100);
 
-    auto x = static_cast<float>(distX(SimUtils::mt)), y = static_cast<float>(distY(SimUtils::mt));
+    SimRandom::Stream& rng = getStream(SimRandom::Subsystem::FIRE);
+    auto x = static_cast<float>(distX(rng)), y = static_cast<float>(distY(rng));
     const SDL_FRect boundingBox{x, y, 100, 100};
-    for(const auto& [foodSpawnRangeID, foodSpawnRangePtr] : foodSpawnRanges) {
-        if(QuadTree::rangeIntersectsRect(boundingBox, foodSpawnRangePtr->getBoundingBox())) return;
+    for(const FoodSpawnRange& foodSpawnRange : entities.foodSpawnRanges) {
+        if(SpatialIndex::rangeIntersectsRect(boundingBox, foodSpawnRange.getBoundingBox())) return;
     }
     Vec2 heatMapPos(boundingBox.x + (boundingBox.w * 0.5f), boundingBox.y + (boundingBox.h * 0.5f), heatMapGridSize);
     if(heatMap.contains(heatMapPos)) {
         heatMap[heatMapPos] = 255;
-        SDL_SetRenderTarget(rendererPtr, heatMapTexture);
-        const SDL_FRect rect{
-            (std::floor(heatMapPos.x / heatMapGridSize) * heatMapGridSize) - static_cast<float>(simBoundsPtr->x),
-            (std::floor(heatMapPos.y / heatMapGridSize) * heatMapGridSize) - static_cast<float>(simBoundsPtr->y),
-            heatMapGridSize,
-            heatMapGridSize
-        };
-        const SDL_Color color = heatValToColor(255);
-        SDL_SetRenderDrawColor(rendererPtr, 255, 255, 255, 255);
-        SDL_RenderFillRect(rendererPtr, &rect);
-        SDL_SetRenderDrawColor(rendererPtr, color.r, color.g, color.b, color.a);
-        SDL_RenderFillRect(rendererPtr, &rect);
-        SDL_SetRenderTarget(rendererPtr, NULL);
+        heatMapImagePtr = createMapImage(heatMap, heatMapGridSize, heatValToColor);
     }
 
-    const uint64_t id = getRandomID();
     SDL_Color color{252, 119, 3, 255};
-    const auto firePtr = std::make_shared<Fire>(id, boundingBox, color, simState, rendererPtr, true);
-    addSimObject(firePtr);
-    fires.insert(std::make_pair(id, firePtr));
+    const uint64_t id = entities.fires.emplace([&](const uint64_t newID) {
+        return Fire(newID, boundingBox, color, simState, true);
+    });
+    addToSpatialIndex(*entities.fires.get(id));
     fireAmount++;
 }
 
 uint16_t Simulation::addFood() {
     uint16_t foodSpawnAmountLocal = foodSpawnAmount;
     if(foodAmount + foodSpawnAmount > maxFood) {
-        foodSpawnAmountLocal = maxFood - foodAmount;
+        foodSpawnAmountLocal = static_cast<uint16_t>(maxFood - foodAmount);
     }
 
     foodAmount += foodSpawnAmountLocal;
 
+    SimRandom::Stream& rng = getStream(SimRandom::Subsystem::FOOD);
     std::uniform_int_distribution<int> distX(foodSpawnRange.x, (foodSpawnRange.x + foodSpawnRange.w) - (int)foodWidth);
     std::uniform_int_distribution<int> distY(foodSpawnRange.y, (foodSpawnRange.y + foodSpawnRange.h) - (int)foodHeight);
 
     for(int i = 0; i < foodSpawnAmountLocal; i++) {
         const SDL_FRect foodBoundingBox{
-                static_cast<float>(distX(SimUtils::mt)), static_cast<float>(distY(SimUtils::mt)), foodWidth, foodHeight
+                static_cast<float>(distX(rng)), static_cast<float>(distY(rng)), foodWidth, foodHeight
         };
         SDL_Color color{0, 255, 0, 200};
-        const uint64_t foodID = getRandomID();
-        const auto foodPtr = std::make_shared<Food>(
-                foodID,
+        const uint64_t foodID = entities.foods.emplace([&](const uint64_t newID) {
+            return Food(
+                newID,
                 foodBoundingBox,
                 color,
                 100,
                 simState,
                 false);
-        addSimObject(foodPtr);
-        foodMap.insert(std::make_pair(foodPtr->getPosition(), foodPtr));
+        });
+        const Food& food = *entities.foods.get(foodID);
+        addToSpatialIndex(food);
+        foodMap.insert(std::make_pair(food.getPosition(), foodID));
         incrementFoodSpawnRange(foodBoundingBox);
     }
     return foodSpawnAmountLocal;
 }
 
-void Simulation::addSimObject(const std::shared_ptr<SimObject>& simObjectPtr, const bool isHighPriority) {
-    if(simObjectPtr->isInQuadTree()) quadTreePtr->insert(QuadTree::QuadTreeObject(simObjectPtr->getID(), simObjectPtr->getBoundingBox(), isHighPriority));
-    simObjects.insert(std::make_pair(simObjectPtr->getID(), simObjectPtr));
+void Simulation::addToSpatialIndex(const SimObject& object, const bool isHighPriority) {
+    if(!object.isInQuadTree()) return;
+    if(isStatic(object)) {
+        staticSpatialIndexPtr->insert(object.getQuadTreeObject(isHighPriority));
+        staticIndexChanged = true;
+        staticCollisionsDue = true;
+        return;
+    }
+    spatialIndexPtr->insert(object.getQuadTreeObject(isHighPriority));
+    broadphase.insert(object.getQuadTreeObject(isHighPriority));
+}
+
+void Simulation::removeFromSpatialIndex(const SimObject& object) {
+    if(isStatic(object)) {
+        staticSpatialIndexPtr->remove(object.getQuadTreeObject());
+        staticIndexChanged = true;
+        return;
+    }
+    spatialIndexPtr->remove(object.getQuadTreeObject());
+    broadphase.remove(object.getQuadTreeObject());
 }
 
 void Simulation::addFoodSpawnRange(const uint16_t foodAdded) {
-    const uint64_t id = getRandomID();
-    foodSpawnRanges.insert(std::make_pair(id, std::make_shared<FoodSpawnRange>(
-        id,
-        SimUtils::rectToFRect(foodSpawnRange),
-        foodAdded,
-        simState,
-        true))
-    );
-    addSimObject(foodSpawnRanges[id], true);
+    const uint64_t id = entities.foodSpawnRanges.emplace([&](const uint64_t newID) {
+        return FoodSpawnRange(
+            newID,
+            SimUtils::rectToFRect(foodSpawnRange),
+            foodAdded,
+            simState,
+            true);
+    });
+    addToSpatialIndex(*entities.foodSpawnRanges.get(id), true);
 }
 
 void Simulation::addOrganism(
-        const uint64_t id,
         const uint16_t genomeSize,
         const SDL_Color& initialColor,
         const SDL_FRect& boundingBox) {
 
-    organisms.emplace(id, std::move(std::make_shared<Organism>(id, genomeSize, initialColor, boundingBox, simState, true)));
-    addSimObject(organisms[id]);
+    const SimRandom::Stream organismRng = getStream(SimRandom::Subsystem::ORGANISM).split(organismsSpawned++);
+    const uint64_t id = entities.emplaceOrganism([&](const uint64_t newID) {
+        return Organism(newID, genomeSize, initialColor, boundingBox, simState, organismRng, true);
+    }, boundingBox);
+    addToSpatialIndex(*entities.organisms.get(id));
 
     population++;
 }
-void Simulation::addOrganism(
-        const uint64_t id,
-        const Organism& parent1,
-        const Organism& parent2,
-        const SDL_Color& initialColor,
-        const SDL_FRect& boundingBox) {
-
-    organisms.emplace(id, std::move(std::make_shared<Organism>(id, parent1, parent2, initialColor, boundingBox, simState, true)));
-    addSimObject(organisms[id]);
-
-    population++;
+/**
+ * Breeds every planned child on the thread pool, then adds them to the store and the spatial index in one pass.
+ */
+void Simulation::addChildren() {
+    if(childPlans.empty()) return;
+    childInheritances.clear();
+    childInheritances.resize(childPlans.size());
+    threadPool.parallelFor(childPlans.size(), childChunkSize, [this](const size_t begin, const size_t end) {
+        for(size_t i = begin; i < end; i++) {
+            const ChildPlan& plan = childPlans[i];
+            const Organism::Parent& parent1 = nextGenParents[plan.parent1Index];
+            const Organism::Parent& parent2 = nextGenParents[plan.parent2Index];
+            childInheritances[i].emplace(Organism::inherit(parent1, parent2, plan.rng));
+        }
+    });
+
+    entities.reserveOrganisms(entities.organisms.size() + childPlans.size());
+    for(size_t i = 0; i < childPlans.size(); i++) {
+        const ChildPlan& plan = childPlans[i];
+        const uint64_t id = entities.emplaceOrganism([&](const uint64_t newID) {
+            return Organism(newID, std::move(*childInheritances[i]), plan.color, plan.boundingBox, simState, true);
+        }, plan.boundingBox);
+        addToSpatialIndex(*entities.organisms.get(id));
+    }
+    population += static_cast<uint32_t>(childPlans.size());
+    childPlans.clear();
+    childInheritances.clear();
 }
 
 void Simulation::createNextGeneration() {
-    size_t size = nextGenParents.size();
+    const size_t size = nextGenParents.size();
     if(size < 2) return;
 
-    for(int i = 0; i < size - 1; i += 2)
-        reproduceOrganisms(nextGenParents[i], nextGenParents[i + 1]);
+    for(size_t i = 0; i < size - 1; i += 2)
+        planChildren(i, i + 1);
 
     if((size & 1) != 0)
-        reproduceOrganisms(nextGenParents[size - 2], nextGenParents[size - 1]);
+        planChildren(size - 2, size - 1);
+    addChildren();
 
     generationNum++;
 
     nextGenParents.clear();
 }
 
-void Simulation::slowInFood(const std::shared_ptr<Organism>& organismPtr) {
-    Vec2 velocity = organismPtr->getVelocity();
-    organismPtr->setVelocity({velocity.x * 0.80f,velocity.y * 0.80f});
+void Simulation::slowInFood(const size_t row) {
+    OrganismComponents& components = entities.organismComponents;
+    components.velocityX[row] *= 0.80f;
+    components.velocityY[row] *= 0.80f;
 }
 
-void Simulation::reproduceOrganisms(const std::shared_ptr<Organism>& organism1Ptr, const std::shared_ptr<Organism>& organism2Ptr) {
-    static SDL_Color color = {50, 0, 240, 255};
+/**
+ * Decides how many children two parents have and where, every random draw happens here in the order of the pairs
+ * so the children come out the same however addChildren splits the breeding.
+ * Parents breed from the copies taken when they were picked, those that died since still have children.
+ */
+void Simulation::planChildren(const size_t parent1Index, const size_t parent2Index) {
+    Organism::Parent& parent1 = nextGenParents[parent1Index];
+    Organism::Parent& parent2 = nextGenParents[parent2Index];
+    SimRandom::Stream& rng = getStream(SimRandom::Subsystem::REPRODUCTION);
     std::bernoulli_distribution whichFertility(0.50);
     float fertility = 0.0f;
-    if(whichFertility(SimUtils::mt)) {
-        fertility = organism1Ptr->getFertility();
+    if(whichFertility(rng)) {
+        fertility = parent1.fertility;
     }else {
-        fertility = organism2Ptr->getFertility();
+        fertility = parent2.fertility;
     }
-    if(population + static_cast<int>(fertility * static_cast<float>(birthRate.second)) >= maxPopulation) return;
-    if(!organism1Ptr->shouldReproduce() || !organism2Ptr->shouldReproduce()) return;
+    //children planned so far count as born
+    const auto plannedPopulation = static_cast<uint32_t>(population + childPlans.size());
+    if(plannedPopulation + static_cast<int>(fertility * static_cast<float>(birthRate.second)) >= maxPopulation) return;
+    if(parent1.bred || parent2.bred) return;
 
     std::uniform_int_distribution<uint8_t> distNumChildren(
             static_cast<int>(fertility * static_cast<float>(birthRate.first)),
             static_cast<int>(fertility * static_cast<float>(birthRate.second)));
     std::uniform_int_distribution<int> distX(simBoundsPtr->x, (simBoundsPtr->x + simBoundsPtr->w) - (int)organismWidth);
     std::uniform_int_distribution<int> distY(simBoundsPtr->y, (simBoundsPtr->y + simBoundsPtr->h) - (int)organismHeight);
-    const uint8_t numChildren = distNumChildren(SimUtils::mt);
+    const uint8_t numChildren = distNumChildren(rng);
 
-    organism1Ptr->reproduce();
-    organism2Ptr->reproduce();
+    parent1.bred = true;
+    parent2.bred = true;
+    //parents that died have no energy left to pay for it
+    if(Organism* organism1Ptr = entities.organisms.get(parent1.id)) organism1Ptr->reproduce();
+    if(Organism* organism2Ptr = entities.organisms.get(parent2.id)) organism2Ptr->reproduce();
     for(int i = 0; i < numChildren; i++) {
-        const uint64_t newID = getRandomID();
-        addOrganism(
-            newID,
-            *organism1Ptr,
-            *organism2Ptr,
+        const SDL_Color color = getNextOrganismColor();
+        const SDL_FRect boundingBox{
+            randomizeSpawn ? static_cast<float>(distX(rng)) : parent1.position.x,
+            randomizeSpawn ? static_cast<float>(distY(rng)) : parent1.position.y,
+            organismWidth,
+            organismHeight
+        };
+        childPlans.push_back({
+            parent1Index,
+            parent2Index,
             color,
-            {
-                randomizeSpawn ? static_cast<float>(distX(SimUtils::mt)) : organism1Ptr->getPosition().x,
-                randomizeSpawn ? static_cast<float>(distY(SimUtils::mt)) : organism1Ptr->getPosition().y,
-                organismWidth,
-                organismHeight
-            }
-        );
-        color.r += 10;
-        color.b += 15;
+            boundingBox,
+            getStream(SimRandom::Subsystem::ORGANISM).split(organismsSpawned++)});
     }
 }
 
@@ -647,19 +855,32 @@ void Simulation::tryUpdateSimBounds(const SDL_Rect& newSimBounds) {
        simBoundsPtr->h != newSimBounds.h) {
 
         *simBoundsPtr = newSimBounds;
-        *quadTreePtr = QuadTree(SimUtils::rectToFRect(*simBoundsPtr), 10);
+        spatialIndexPtr->reset(SimUtils::rectToFRect(*simBoundsPtr));
+        broadphase.reset(SimUtils::rectToFRect(*simBoundsPtr));
+        //static objects skip the bounds check every update, so they are checked here and put back into their emptied index
+        staticSpatialIndexPtr->reset(SimUtils::rectToFRect(*simBoundsPtr));
+        auto reinsertStaticObjects = [this](auto& store) {
+            for(SimObject& object : store) {
+                checkBounds(object);
+                addToSpatialIndex(object);
+            }
+        };
+        reinsertStaticObjects(entities.foods);
+        reinsertStaticObjects(entities.fires);
+        reinsertStaticObjects(entities.foodSpawnRanges);
+        staticIndexChanged = true;
         generateHeatMap();
         generateAtmosphereMap();
     }
 }
 
-void Simulation::checkBounds(const std::shared_ptr<SimObject>& objectPtr) const{
+void Simulation::checkBounds(SimObject& object) {
     const SDL_FRect simBoundsFloat = SimUtils::rectToFRect(*simBoundsPtr);
     const auto leftBound = simBoundsFloat.x;
     const auto rightBound = simBoundsFloat.x + simBoundsFloat.w;
     const auto topBound = simBoundsFloat.y;
     const auto bottomBound = simBoundsFloat.y + simBoundsFloat.h;
-    SDL_FRect boundingBox = objectPtr->getBoundingBox();
+    SDL_FRect boundingBox = object.getBoundingBox();
     SDL_FRect oldBoundingBox = boundingBox;
 
     if(boundingBox.x < leftBound)
@@ -672,132 +893,170 @@ void Simulation::checkBounds(const std::shared_ptr<SimObject>& objectPtr) const{
         boundingBox.y = bottomBound - boundingBox.h;
 
     if(boundingBox.x != oldBoundingBox.x || boundingBox.y != oldBoundingBox.y) {
-        objectPtr->markForDeletion(); //todo maybe remove
-        if(objectPtr->isInQuadTree()) quadTreePtr->remove(QuadTree::QuadTreeObject(objectPtr->getID(), oldBoundingBox));
-        if(objectPtr->isInQuadTree()) quadTreePtr->insert(QuadTree::QuadTreeObject(objectPtr->getID(), boundingBox));
+        object.markForDeletion(); //todo maybe remove
+        //static objects are only checked right after their index was reset, the caller puts them back
+        if(object.isInQuadTree() && !isStatic(object)) {
+            spatialIndexPtr->move(object.getQuadTreeObject(boundingBox), oldBoundingBox);
+            broadphase.move(object.getQuadTreeObject(boundingBox));
+        }
     }
-    objectPtr->setBoundingBox(boundingBox);
+    object.setBoundingBox(boundingBox);
 }
 
-void Simulation::resolveCollision(const uint64_t id1, const uint64_t id2) {
-    if(!simObjects.contains(id1) || !simObjects.contains(id2) &&
-       !organisms.contains(id1)  && !organisms.contains(id2)) return;
-
-    std::shared_ptr<SimObject> object1Ptr = simObjects[id1], object2Ptr = simObjects[id2];
-
-    SDL_FRect boundingBox1 = object1Ptr->getBoundingBox(), boundingBox2 = object2Ptr->getBoundingBox();
-
-    if(organisms.contains(id1) && organisms.contains(id2)) {
-        Vec2 velocity1 = organisms[id1]->getVelocity(), velocity2 = organisms[id2]->getVelocity();
-
-        //from https://www.plasmaphysics.org.uk/programs/coll2d_cpp.htm
-        float mass1 = 10.0f, mass2 = 10.0f, R = 0.95f;
-        float massRatio = mass2 / mass1;
-        float xDiff = boundingBox2.x - boundingBox1.x, yDiff = boundingBox2.y - boundingBox1.y;
-        float xVelocityDiff = velocity2.x - velocity1.x, yVelocityDiff = velocity2.y - velocity1.y;
-        float xVelocityCM = (mass1 * velocity1.x + mass2 * velocity2.x) / (mass1 + mass2);
-        float yVelocityCM = (mass1 * velocity1.y + mass2 * velocity2.y) / (mass1 + mass2);
+/**
+ * Clamps every organism into the simulation bounds, organisms that had to be clamped are flagged for deletion like in checkBounds.
+ */
+void Simulation::clampOrganismsToBounds() {
+    OrganismComponents& components = entities.organismComponents;
+    const SDL_FRect simBoundsFloat = SimUtils::rectToFRect(*simBoundsPtr);
+    const float leftBound = simBoundsFloat.x;
+    const float rightBound = simBoundsFloat.x + simBoundsFloat.w;
+    const float topBound = simBoundsFloat.y;
+    const float bottomBound = simBoundsFloat.y + simBoundsFloat.h;
+
+    const size_t size = components.size();
+    float* x = components.x.data();
+    float* y = components.y.data();
+    const float* w = components.w.data();
+    const float* h = components.h.data();
+    uint8_t* clamped = components.clamped.data();
+    for(size_t i = 0; i < size; i++) {
+        const float clampedX = std::min(std::max(x[i], leftBound), rightBound - w[i]);
+        const float clampedY = std::min(std::max(y[i], topBound), bottomBound - h[i]);
+        clamped[i] = (clampedX != x[i]) | (clampedY != y[i]);
+        x[i] = clampedX;
+        y[i] = clampedY;
+    }
+}
 
-        //don't update velocities if bounding boxes not approaching
-        if((xVelocityDiff * xDiff + yVelocityDiff * yDiff) >= 0) return;
+/**
+ * Copies the bounding box the organism passes left in the components to the organism and moves its spatial index entry if it changed.
+ */
+void Simulation::syncOrganismBoundingBox(Organism& organism, const size_t row) {
+    OrganismComponents& components = entities.organismComponents;
+    if(components.clamped[row]) organism.markForDeletion(); //todo maybe remove
+    const SDL_FRect boundingBox = components.getBoundingBox(row);
+    const SDL_FRect oldBoundingBox = organism.getBoundingBox();
+    if(boundingBox.x == oldBoundingBox.x && boundingBox.y == oldBoundingBox.y &&
+       boundingBox.w == oldBoundingBox.w && boundingBox.h == oldBoundingBox.h) return;
+
+    organism.setBoundingBox(boundingBox);
+    if(!organism.isInQuadTree()) return;
+    spatialIndexPtr->move(organism.getQuadTreeObject(), oldBoundingBox);
+    broadphase.move(organism.getQuadTreeObject());
+}
 
-        float yDiffF = 1.0E-6F * std::fabs(yDiff);
-        if(std::fabs(xDiff) < yDiffF) {
-            float sign;
-            if(xDiff < 0.0f) sign = -1.0f;
-            else sign = 1.0f;
-            xDiff = yDiffF * sign;
-        }
+void Simulation::resolveCollision(const uint64_t id1, const uint64_t id2) {
+    Organism* organism1Ptr = entities.organisms.get(id1);
+    Organism* organism2Ptr = entities.organisms.get(id2);
+    if(!organism1Ptr || !organism2Ptr) return;
+
+    SDL_FRect boundingBox1 = organism1Ptr->getBoundingBox(), boundingBox2 = organism2Ptr->getBoundingBox();
+
+    Vec2 velocity1 = organism1Ptr->getVelocity(), velocity2 = organism2Ptr->getVelocity();
+
+    //from https://www.plasmaphysics.org.uk/programs/coll2d_cpp.htm
+    float mass1 = 10.0f, mass2 = 10.0f, R = 0.95f;
+    float massRatio = mass2 / mass1;
+    float xDiff = boundingBox2.x - boundingBox1.x, yDiff = boundingBox2.y - boundingBox1.y;
+    float xVelocityDiff = velocity2.x - velocity1.x, yVelocityDiff = velocity2.y - velocity1.y;
+    float xVelocityCM = (mass1 * velocity1.x + mass2 * velocity2.x) / (mass1 + mass2);
+    float yVelocityCM = (mass1 * velocity1.y + mass2 * velocity2.y) / (mass1 + mass2);
+
+    //don't update velocities if bounding boxes not approaching
+    if((xVelocityDiff * xDiff + yVelocityDiff * yDiff) >= 0) return;
+
+    float yDiffF = 1.0E-6F * std::fabs(yDiff);
+    if(std::fabs(xDiff) < yDiffF) {
+        float sign;
+        if(xDiff < 0.0f) sign = -1.0f;
+        else sign = 1.0f;
+        xDiff = yDiffF * sign;
+    }
 
-        //update velocities
-        float slope = yDiff / xDiff;
-        float dxVelocity2 = -2.0f * (xVelocityDiff + slope * yVelocityDiff) / ((1 + slope * slope) * (1 + massRatio));
-        velocity2.x = velocity2.x + dxVelocity2;
-        velocity2.y = velocity2.y + slope * dxVelocity2;
-        velocity1.x = velocity1.x - massRatio * dxVelocity2;
-        velocity1.y = velocity1.y - slope * massRatio * dxVelocity2;
-
-        //velocity correction for inelastic collisions
-        velocity1.x = (velocity1.x - xVelocityCM) * R + xVelocityCM;
-        velocity1.y = (velocity1.y - yVelocityCM) * R + yVelocityCM;
-        velocity2.x = (velocity2.x - xVelocityCM) * R + xVelocityCM;
-        velocity2.y = (velocity2.y - yVelocityCM) * R + yVelocityCM;
-
-        if(abs(velocity1.x) <= Organism::velocityMax && abs(velocity1.y) <= Organism::velocityMax) {
-            organisms[id1]->setVelocity(velocity1);
-        }
-        if(abs(velocity2.x) <= Organism::velocityMax && abs(velocity2.y) <= Organism::velocityMax) {
-            organisms[id2]->setVelocity(velocity2);
-        }
+    //update velocities
+    float slope = yDiff / xDiff;
+    float dxVelocity2 = -2.0f * (xVelocityDiff + slope * yVelocityDiff) / ((1 + slope * slope) * (1 + massRatio));
+    velocity2.x = velocity2.x + dxVelocity2;
+    velocity2.y = velocity2.y + slope * dxVelocity2;
+    velocity1.x = velocity1.x - massRatio * dxVelocity2;
+    velocity1.y = velocity1.y - slope * massRatio * dxVelocity2;
+
+    //velocity correction for inelastic collisions
+    velocity1.x = (velocity1.x - xVelocityCM) * R + xVelocityCM;
+    velocity1.y = (velocity1.y - yVelocityCM) * R + yVelocityCM;
+    velocity2.x = (velocity2.x - xVelocityCM) * R + xVelocityCM;
+    velocity2.y = (velocity2.y - yVelocityCM) * R + yVelocityCM;
+
+    if(abs(velocity1.x) <= Organism::velocityMax && abs(velocity1.y) <= Organism::velocityMax) {
+        organism1Ptr->setVelocity(velocity1);
+    }
+    if(abs(velocity2.x) <= Organism::velocityMax && abs(velocity2.y) <= Organism::velocityMax) {
+        organism2Ptr->setVelocity(velocity2);
     }
 }
 
-void Simulation::handleCollision(const uint64_t id1, const uint64_t id2) {
-    if(!simObjects.contains(id1) || !simObjects.contains(id2)) return;
+void Simulation::handleCollision(const SpatialIndex::Intersection& intersection) {
+    const auto& [id1, kind1, id2, kind2] = intersection;
+    SimObject* object1Ptr = entities.get(id1);
+    SimObject* object2Ptr = entities.get(id2);
+    if(!object1Ptr || !object2Ptr) return;
 
-    resolveCollision(id1, id2);
+    if(kind1 == EntityKind::ORGANISM && kind2 == EntityKind::ORGANISM) resolveCollision(id1, id2);
 
-    std::shared_ptr<SimObject> object1Ptr(simObjects[id1]), object2Ptr(simObjects[id2]);
-    if(organisms.contains(id1)) organisms[id1]->addCollisionID(id2);
-    if(organisms.contains(id2)) organisms[id2]->addCollisionID(id1);
-    std::shared_ptr<Fire> fire1Ptr = std::dynamic_pointer_cast<Fire>(object1Ptr), fire2Ptr = std::dynamic_pointer_cast<Fire>(object2Ptr);
+    if(kind1 == EntityKind::ORGANISM) entities.organisms.get(id1)->addCollision(id2, kind2);
+    if(kind2 == EntityKind::ORGANISM) entities.organisms.get(id2)->addCollision(id1, kind1);
 
-    if(fire1Ptr && !fire2Ptr) object2Ptr->markForDeletion();
-    if(fire2Ptr && !fire1Ptr) object1Ptr->markForDeletion();
+    if(kind1 == EntityKind::FIRE && kind2 != EntityKind::FIRE) object2Ptr->markForDeletion();
+    if(kind2 == EntityKind::FIRE && kind1 != EntityKind::FIRE) object1Ptr->markForDeletion();
 }
 
 SimObjectData Simulation::userClicked(const float mouseX, const float mouseY) {
     SimObjectData result{};
 
-    std::vector<uint64_t> objectsClicked = quadTreePtr->query(
-        QuadTree::QuadTreeObject(
+    std::vector<uint64_t> objectsClicked = spatialIndexPtr->query(
+        SpatialIndex::Object(
             SDL_FRect{mouseX, mouseY, clickWidth, clickHeight}));
-    std::shared_ptr<Organism> organismPtr = nullptr;
+    const Organism* organismPtr = nullptr;
 
     for(const uint64_t id : objectsClicked) {
-        if(organisms.contains(id)) {
-            organismPtr = organisms[id];
-            break;
-        }
+        organismPtr = entities.organisms.get(id);
+        if(organismPtr) break;
     }
-    if(organismPtr) result = getOrganismData(organismPtr);
+    if(organismPtr) result = getOrganismData(*organismPtr);
 
     return result;
 }
 
 SimObjectData Simulation::getFocusedSimObjectData() {
-    if(focusedSimObjectID == UINT64_MAX || !simObjects.contains(focusedSimObjectID)) return {};
-
-    const std::shared_ptr<SimObject> objectPtr = simObjects[focusedSimObjectID];
-
-    if(organisms.contains(focusedSimObjectID)) {
-        const std::shared_ptr<Organism> organismPtr = organisms[focusedSimObjectID];
+    if(focusedSimObjectID == SlotHandle::invalid || !entities.contains(focusedSimObjectID)) return {};
 
-        return getOrganismData(organismPtr);
+    if(const Organism* organismPtr = entities.organisms.get(focusedSimObjectID)) {
+        return getOrganismData(*organismPtr);
     }
 
     return {}; //todo add more get methods for other types
 }
 
-OrganismData Simulation::getOrganismData(const std::shared_ptr<Organism>& organismPtr) {
+OrganismData Simulation::getOrganismData(const Organism& organism) {
     std::stringstream organismInfoStream;
     std::stringstream neuralNetInputStream;
     std::stringstream neuralNetOutputStream;
     std::stringstream traitInfoStream;
-    std::vector<std::pair<NeuronInputType, float>> inputActivations = organismPtr->getInputActivations();
-    std::vector<std::pair<NeuronOutputType, float>> outputActivations = organismPtr->getOutputActivations();
-    Vec2 velocity = organismPtr->getVelocity();
+    std::vector<std::pair<NeuronInputType, float>> inputActivations = organism.getInputActivations();
+    std::vector<std::pair<NeuronOutputType, float>> outputActivations = organism.getOutputActivations();
+    Vec2 velocity = organism.getVelocity();
 
-    organismInfoStream << "ID: " << organismPtr->getID() << std::endl <<
+    organismInfoStream << "ID: " << organism.getID() << std::endl <<
         "Velocity: (" << std::fixed << std::setprecision(2) << velocity.x <<
         ", " << std::fixed << std::setprecision(2) << velocity.y << ")" << std::endl <<
-        "Hunger: " << static_cast<int>(organismPtr->getHunger()) << "%" << std::endl <<
-        "Age: " << static_cast<int>(organismPtr->getAge()) << std::endl <<
-        "Energy: " << static_cast<int>(organismPtr->getEnergy()) << std::endl <<
-        "Temperature: " << static_cast<int>(organismPtr->getTemperature()) << "°F" << std::endl <<
-        "Breath: " << static_cast<int>(organismPtr->getBreath()) << "%" << std::endl <<
-        "Oxygen Sat: " << static_cast<int>(organismPtr->getOxygenSat() * 100) << "%" << std::endl <<
-        "Hydrogen Sat: " << static_cast<int>(organismPtr->getHydrogenSat() * 100) << "%" << std::endl;
+        "Hunger: " << static_cast<int>(organism.getHunger()) << "%" << std::endl <<
+        "Age: " << static_cast<int>(organism.getAge()) << std::endl <<
+        "Energy: " << static_cast<int>(organism.getEnergy()) << std::endl <<
+        "Temperature: " << static_cast<int>(organism.getTemperature()) << "°F" << std::endl <<
+        "Breath: " << static_cast<int>(organism.getBreath()) << "%" << std::endl <<
+        "Oxygen Sat: " << static_cast<int>(organism.getOxygenSat() * 100) << "%" << std::endl <<
+        "Hydrogen Sat: " << static_cast<int>(organism.getHydrogenSat() * 100) << "%" << std::endl;
 
     neuralNetInputStream << "Neural Net Inputs: " << std::endl;
     for(const auto& [neuronID, activation] : inputActivations) {
@@ -810,15 +1069,15 @@ OrganismData Simulation::getOrganismData(const std::shared_ptr<Organism>& organi
             << std::fixed << std::setprecision(2) << activation << std::endl;
     }
 
-    const auto traitValues = organismPtr->getTraitValues();
+    const auto traitValues = organism.getTraitValues();
     traitInfoStream << "Traits: " << std::endl;
     for(int i = 0; i < traitValues.size(); i++) {
         traitInfoStream << traitsStrValues[i] << " : " << std::fixed << std::setprecision(2) << traitValues[i] << std::endl;
     }
 
     return {
-            organismPtr->getID(),
-            organismPtr->getHunger(), organismPtr->getAge(),
+            organism.getID(),
+            organism.getHunger(), organism.getAge(),
             organismInfoStream.str(),
             neuralNetInputStream.str(),
             neuralNetOutputStream.str(),
@@ -834,20 +1093,18 @@ void Simulation::setUserAction(const UserActionType& userActionType, const UIDat
 
 void Simulation::handleChangeFoodRange(const UIData &uiData) {
     static bool returnPressedLastFrame = false;
-    int keyStatesLength;
-    const bool* keyStates = SDL_GetKeyboardState(&keyStatesLength);
 
-    if(returnPressedLastFrame && !keyStates[SDL_SCANCODE_RETURN]) {
+    if(returnPressedLastFrame && !inputState.returnDown) {
         randomizeFoodParams();
         const uint16_t foodAdded = addFood();
         addFoodSpawnRange(foodAdded);
         foodSpawnRandom = true;
-    }else if(keyStates[SDL_SCANCODE_BACKSPACE]) {
+    }else if(inputState.backspaceDown) {
         foodSpawnRandom = false;
         foodSpawnAmount = 1000;
     }
 
-    if(keyStates[SDL_SCANCODE_RETURN])
+    if(inputState.returnDown)
         returnPressedLastFrame = true;
     else returnPressedLastFrame = false;
 
@@ -855,9 +1112,8 @@ void Simulation::handleChangeFoodRange(const UIData &uiData) {
 
     static bool clickedLastFrame = false;
     static float lastFloatX = NAN, lastFloatY = NAN;
-    float floatX, floatY;
-    const SDL_MouseButtonFlags mouseState = SDL_GetMouseState(&floatX, &floatY);
-    const bool leftClicked = mouseState & SDL_BUTTON_LMASK;
+    const float floatX = inputState.mouseX, floatY = inputState.mouseY;
+    const bool leftClicked = inputState.leftMouseDown;
     int x = static_cast<int>(floatX);
     int y = static_cast<int>(floatY);
     if(x < simBoundsPtr->x) return;
@@ -893,19 +1149,19 @@ void Simulation::handleChangeFoodRange(const UIData &uiData) {
 
 void Simulation::handleFocus(const UIData& uiData) {
     const uint64_t* simObjectIDPtr = std::get_if<SimObjectID>(&uiData);
-    if(!simObjectIDPtr || !simObjects.contains(*simObjectIDPtr)) return;
-    if(focusedSimObjectID != UINT64_MAX && simObjects.contains(focusedSimObjectID)) {
-        simObjects[focusedSimObjectID]->setColor({0, 0, 0, 255});
+    if(!simObjectIDPtr || !entities.contains(*simObjectIDPtr)) return;
+    if(SimObject* focusedObjectPtr = entities.get(focusedSimObjectID)) {
+        focusedObjectPtr->setColor({0, 0, 0, 255});
     }
     focusedSimObjectID = *simObjectIDPtr;
-    simObjects[*simObjectIDPtr]->setColor({255,192, 203, 255});
+    entities.get(*simObjectIDPtr)->setColor({255,192, 203, 255});
     setUserAction(UserActionType::NONE, uiData);
 }
 
 void Simulation::handleUnfocus(const UIData& uiData) {
     setUserAction(UserActionType::NONE, uiData);
-    if(simObjects.contains(focusedSimObjectID)) {
-        simObjects[focusedSimObjectID]->setColor({0,0, 0, 255});
+    if(SimObject* focusedObjectPtr = entities.get(focusedSimObjectID)) {
+        focusedObjectPtr->setColor({0,0, 0, 255});
     }
-    focusedSimObjectID = UINT64_MAX;
+    focusedSimObjectID = SlotHandle::invalid;
 }
\ No newline at end of file
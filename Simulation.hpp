@@ -4,45 +4,86 @@
 #include "SimObject.hpp"
 #include "StaticSimObjects.hpp"
 #include "Organism.hpp"
+#include "EntityStore.hpp"
 #include "SimUtils.hpp"
+#include "SpatialIndex.hpp"
+#include "SweepAndPrune.hpp"
+#include "ThreadPool.hpp"
+#include "SimRandom.hpp"
+#include "Profiler.hpp"
+#include "RenderSnapshot.hpp"
 #include "UIStructs.hpp"
 #include "UtilityStructs.hpp"
+#include "WorldSnapshot.hpp"
 #include "SDL3/SDL.h"
+#include <atomic>
 #include <functional>
 #include <unordered_map>
 #include <memory>
+#include <optional>
+#include <vector>
 
 class Simulation{
 public:
-    Simulation(SDL_Renderer* rendererPtr, const SDL_Rect& simBounds, uint16_t maxPopulation, int genomeSize, float initialMutationFactor);
+    /**
+     * @param seed every random decision in the simulation is derived from this seed, the same seed replays the same run.
+     * @param spatialIndexType the backend answering collision, neighbor and raycast lookups.
+     * @param workerCount the threads the simulation's stages are split across besides the calling one.
+     */
+    Simulation(
+        const SDL_Rect& simBounds,
+        uint32_t maxPopulation,
+        int genomeSize,
+        float initialMutationFactor,
+        uint64_t seed,
+        SpatialIndexType spatialIndexType = SpatialIndexType::QUADTREE,
+        size_t workerCount = ThreadPool::getDefaultWorkerCount());
     ~Simulation();
     void update(const SDL_Rect& simBounds, float deltaTime);
     void fixedUpdate();
-    void render();
-    void setRenderer(SDL_Renderer* newRendererPtr) {rendererPtr = newRendererPtr;}
+    void step(float fixedDeltaTime);
+    void step(float fixedDeltaTime, const SDL_Rect& simBounds);
+    void waitForNeighborTask();
+    /**
+     * Copies everything drawn for one frame into snapshotPtr, reusing its buffers.
+     */
+    void writeRenderSnapshot(RenderSnapshot* snapshotPtr) const;
+    //the mouse and keys the food spawn range is drawn with, the simulation doesn't read them from SDL itself
+    void setInputState(const InputState& newInputState) {inputState = newInputState;}
+    void setProfiler(const std::shared_ptr<TickProfiler>& newProfilerPtr);
+    [[nodiscard]] const std::shared_ptr<TickProfiler>& getProfiler() const {return profilerPtr;}
 
     SimObjectData userClicked(float mouseX, float mouseY);
     SimObjectData getFocusedSimObjectData();
     UserActionType getCurrentUserAction() {return currUserAction;}
     void setUserAction(const UserActionType& userActionType, const UIData& uiData);
 
+    uint64_t getSeed() const {return seed;}
     uint64_t getCurrentGeneration() const {return generationNum;}
-    uint16_t getCurrentPopulation() const {return population;}
+    uint32_t getCurrentPopulation() const {return population;}
     void showQuadTree(bool setQuadTreeVisible) {quadTreeVisible = setQuadTreeVisible;}
     //[[nodiscard]] bool quadTreeIsShown() const {return quadTreeVisible;}
-    [[nodiscard]] size_t getQuadSize() const {return quadTreePtr->size();}
+    [[nodiscard]] size_t getQuadSize() const {return spatialIndexPtr->size() + staticSpatialIndexPtr->size();}
     void showHeatMap(bool setHeatMapVisible) {heatMapVisible = setHeatMapVisible;}
     void showAtmosphereMap(bool setAtmosphereMapVisible) {atmosphereMapVisible = setAtmosphereMapVisible;}
     //[[nodiscard]] bool heatMapIsShown() const {return heatMapVisible;}
-    bool contains(const uint64_t id) {return simObjects.contains(id);}
+    bool contains(const uint64_t id) {return entities.contains(id);}
 
 private:
-    SDL_Renderer* rendererPtr;
+    using SubsystemStreams = std::array<SimRandom::Stream, static_cast<size_t>(SimRandom::Subsystem::SIZE)>;
+
+    std::shared_ptr<TickProfiler> profilerPtr = std::make_shared<TickProfiler>();
+    const uint64_t seed;
+    SubsystemStreams streams;
+    uint64_t organismsSpawned = 0;
+    uint64_t pheromonesSpawned = 0;
+    uint8_t fixedUpdateCalls = 2;
+    SDL_Color nextOrganismColor = {50, 0, 240, 255};
     uint64_t generationNum = 0;
-    uint16_t population = 0;
-    const uint16_t maxPopulation;
-    const uint16_t maxFood;
-    const uint16_t maxPheromones;
+    uint32_t population = 0;
+    const uint32_t maxPopulation;
+    const uint32_t maxFood;
+    const uint32_t maxPheromones;
     static constexpr uint8_t maxFires = 5;
     float foodTimer = 0.0f;
     float foodRandomizeTimer = 0.0f;
@@ -53,34 +94,45 @@ private:
     float mutationFactor;
 
     UserActionType currUserAction = UserActionType::NONE;
+    InputState inputState;
 
-    uint64_t focusedSimObjectID = UINT64_MAX;
+    uint64_t focusedSimObjectID = SlotHandle::invalid;
 
-    std::unordered_map<uint64_t, std::shared_ptr<SimObject>> simObjects;
-    std::unordered_map<uint64_t, std::shared_ptr<Organism>> organisms;
-    std::unordered_map<uint64_t, std::shared_ptr<FoodSpawnRange>> foodSpawnRanges;
-    std::unordered_map<uint64_t, std::shared_ptr<Fire>> fires;
-    std::unordered_multimap<Vec2, std::shared_ptr<Food>, Vec2PositionalHash, Vec2PositionalEqual> foodMap;
-    std::unordered_multimap<Vec2, std::shared_ptr<Pheromone>, Vec2PositionalHash, Vec2PositionalEqual> pheromoneMap;
+    EntityStore entities;
+    std::unordered_multimap<Vec2, uint64_t, Vec2PositionalHash, Vec2PositionalEqual> foodMap;
+    std::unordered_multimap<Vec2, uint64_t, Vec2PositionalHash, Vec2PositionalEqual> pheromoneMap;
     std::unordered_map<Vec2, uint8_t, Vec2PositionalHash, Vec2PositionalEqual> heatMap;
     std::unordered_map<Vec2, uint8_t, Vec2PositionalHash, Vec2PositionalEqual> atmosphereMap;
-    SDL_Texture* heatMapTexture = nullptr;
-    SDL_Texture* atmosphereMapTexture = nullptr;
-    std::vector<std::shared_ptr<Organism>> nextGenParents;
-    void markForDeletion(const uint64_t id) {simObjects[id]->markForDeletion();}
-    std::shared_ptr<SimObject> get(const uint64_t id) {
-        if(!simObjects.contains(id)) return nullptr;
-        return simObjects[id];
-    }
-    std::function<void (uint64_t id)> markForDeletionLambda = [this] (const uint64_t id) {this->markForDeletion(id);};
-    std::function<std::shared_ptr<SimObject> (uint64_t id)> getLambda = [this] (const uint64_t id) {return this->get(id);};
+    //rebuilt whenever the maps change, snapshots share them until then
+    std::shared_ptr<const MapImage> heatMapImagePtr;
+    std::shared_ptr<const MapImage> atmosphereMapImagePtr;
+    std::vector<Organism::Parent> nextGenParents;
+    //a child decided on in the serial part of createNextGeneration, bred from the parent copies in nextGenParents
+    struct ChildPlan {
+        size_t parent1Index;
+        size_t parent2Index;
+        SDL_Color color;
+        SDL_FRect boundingBox;
+        SimRandom::Stream rng;
+    };
+    std::vector<ChildPlan> childPlans;
+    std::vector<std::optional<Organism::Inheritance>> childInheritances;
     std::shared_ptr<SDL_Rect> simBoundsPtr;
-    std::shared_ptr<QuadTree> quadTreePtr;
+    //organisms, the only indexed objects that move
+    std::shared_ptr<SpatialIndex> spatialIndexPtr;
+    //fires and food spawn ranges never move, so they get an index that only changes when one is added or removed
+    std::unique_ptr<SpatialIndex> staticSpatialIndexPtr;
+    bool staticIndexChanged = true;
+    //set when a static object is added, the static objects are checked against each other in the next update
+    bool staticCollisionsDue = true;
+    std::vector<uint64_t> staticOverlapScratch;
+    //mirrors the objects in the dynamic spatial index, only used to find collisions between them
+    SweepAndPrune broadphase;
     SimUtils::SimState simState;
     SDL_Rect foodSpawnRange;
     SDL_Rect renderFoodSpawnRange;
-    uint16_t foodAmount = 0;
-    uint16_t pheromoneAmount = 0;
+    uint32_t foodAmount = 0;
+    uint32_t pheromoneAmount = 0;
     uint16_t pheromoneSpawnAmount = 20;
     uint8_t fireAmount = 0;
     uint16_t foodSpawnAmount = 1000;
@@ -100,57 +152,79 @@ private:
     static constexpr float generationLength = 10.0f;
     static constexpr float heatMapGridSize = 200.0f;
     static constexpr float atmosphereMapGridSize = 200.0f;
-    std::unique_ptr<QuadTree> workerThreadQuadTreeCopy = nullptr;
-    std::shared_ptr<ThreadData> threadData = nullptr;
-    SDL_Thread* workerThread = nullptr;
-    SDL_Mutex* workerMutex = nullptr;
-    SDL_Condition* workerCondition = nullptr;
-    bool workerRunning = true;
-    bool workAvailable = false;
+    //the neighbor task and the main thread only share these, snapshots and results are immutable once published
+    std::shared_ptr<const SpatialIndex> snapshotSpatialIndexPtr = nullptr;
+    std::shared_ptr<const SpatialIndex> snapshotStaticSpatialIndexPtr = nullptr;
+    std::atomic<std::shared_ptr<const WorldSnapshot>> publishedSnapshot;
+    std::atomic<std::shared_ptr<const NeighborResults>> publishedResults;
+    std::atomic<uint64_t> publishedEpoch = 0;
+    std::atomic<bool> neighborTaskRunning = false;
+    //the results organisms currently point into
+    std::shared_ptr<const NeighborResults> neighborResultsPtr = nullptr;
+    //only touched by the neighbor task: every results object it published, reused once the main thread and publishedResults let go of it
+    std::vector<std::shared_ptr<NeighborResults>> neighborResultsPool;
+    std::vector<uint64_t> neighborOrderScratch;
+    uint64_t processedEpoch = 0;
+    //runs the read only part of the organism tick, a multiple of NeuralBatch::laneCount so no batch group is split between chunks
+    static constexpr size_t organismChunkSize = 32 * NeuralBatch::laneCount;
+    //breeding one child crosses two genomes and compiles a net, a few of them are already worth a task
+    static constexpr size_t childChunkSize = 4;
+    //declared last so every stage's tasks are done before the members they use are destroyed
+    ThreadPool threadPool;
+    ThreadPool::TaskGroup neighborTasks;
 
     static SDL_Color heatValToColor(uint8_t heatVal);
     static SDL_Color atmosphereValToColor(uint8_t atmosphereVal);
-    static void slowInFood(const std::shared_ptr<Organism>& organismPtr);
-    static uint64_t getRandomID();
-    static OrganismData getOrganismData(const std::shared_ptr<Organism>& organismPtr);
+    void slowInFood(size_t row);
+    static SubsystemStreams createStreams(uint64_t seed);
+    SimRandom::Stream& getStream(SimRandom::Subsystem subsystem) {return streams[static_cast<size_t>(subsystem)];}
+    SDL_Color getNextOrganismColor();
+    static OrganismData getOrganismData(const Organism& organism);
 
-    void setMapVals(const std::shared_ptr<Organism>& organismPtr);
+    void setMapVals(Organism& organism, size_t row);
     void generateHeatMap();
     void generateAtmosphereMap();
-    void neighborTask();
-    void startWorkerThread();
-    void stopWorkerThread();
+    [[nodiscard]] std::shared_ptr<const MapImage> createMapImage(
+        const std::unordered_map<Vec2, uint8_t, Vec2PositionalHash, Vec2PositionalEqual>& map,
+        float gridSize,
+        SDL_Color (*valToColor)(uint8_t)) const;
+    void publishSnapshot();
+    static void findNeighbors(const WorldSnapshot& snapshot, NeighborResults* resultsPtr, std::vector<uint64_t>* orderPtr,
+        ThreadPool* threadPoolPtr);
+    void applyNeighborResults();
+    void launchNeighborTask();
+    void runNeighborTask();
     void handleTimers(float deltaTIme);
     void createNextGeneration();
     void randomizeFoodParams();
-    void addPheromones(const std::shared_ptr<Organism>& organismPtr);
-    void removeFromPheromoneMap(const std::shared_ptr<Pheromone>& pheromonePtr);
-    void removeFromFoodMap(const std::shared_ptr<Food>& foodPtr);
+    void addPheromones(const Organism& organism);
+    void removeFromPheromoneMap(const Pheromone& pheromone);
+    void removeFromFoodMap(const Food& food);
+    void removeMarkedObjects();
+    template<typename SimObjectType, typename OnRemove> void removeMarked(SlotMap<SimObjectType>& store, OnRemove&& onRemove);
     void incrementFoodSpawnRange(const SDL_FRect& foodBoundingBox);
     void decrementFoodSpawnRange(const SDL_FRect& foodBoundingBox);
     void addFire();
     uint16_t addFood();
-    void addSimObject(const std::shared_ptr<SimObject>& simObjectPtr, bool isHighPriority = true);
+    [[nodiscard]] static bool isStatic(const SimObject& object) {return object.getKind() != EntityKind::ORGANISM;}
+    void addToSpatialIndex(const SimObject& object, bool isHighPriority = true);
+    void removeFromSpatialIndex(const SimObject& object);
     void addOrganism(
-            uint64_t id,
             uint16_t genomeSize,
             const SDL_Color& initialColor,
             const SDL_FRect& boundingBox);
-    void addOrganism(
-            uint64_t id,
-            const Organism& parent1,
-            const Organism& parent2,
-            const SDL_Color& initialColor,
-            const SDL_FRect& boundingBox);
+    void addChildren();
     void addFoodSpawnRange(uint16_t foodAdded);
-    void tryAddParent(const std::shared_ptr<Organism>& organismPtr);
-    void reproduceOrganisms(const std::shared_ptr<Organism>& organism1Ptr, const std::shared_ptr<Organism>& organism2Ptr);
+    void tryAddParent(const Organism& organism);
+    void planChildren(size_t parent1Index, size_t parent2Index);
     void mutateOrganisms();
-    void handleCollision(uint64_t id1, uint64_t id2);
+    void handleCollision(const SpatialIndex::Intersection& intersection);
     void resolveCollision(uint64_t id1, uint64_t id2);
     void tryUpdateSimBounds(const SDL_Rect& newSimBounds);
-    void checkBounds(const std::shared_ptr<SimObject>& objectPtr) const;
-    bool shouldMutate() const;
+    void checkBounds(SimObject& object);
+    void clampOrganismsToBounds();
+    void syncOrganismBoundingBox(Organism& organism, size_t row);
+    bool shouldMutate();
     void setMutationFactor(float newMutationFactor) {
         if(newMutationFactor >= 0.0f && newMutationFactor <= 1.0f)
             mutationFactor = newMutationFactor;
@@ -184,7 +258,7 @@ private:
     };
 
     std::function<void()> currUserActionFunc = [this] () {userActionFuncMapping[0](UIData());};
-    Vec2 getRandomPoint() const;
+    Vec2 getRandomPoint();
 };
 
 #endif //SIMULATION_HPP
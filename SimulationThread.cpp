@@ -0,0 +1,59 @@
+#include "SimulationThread.hpp"
+#include "Profiler.hpp"
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+SimulationThread::SimulationThread(std::shared_ptr<Simulation> simPtr, const SDL_Rect& simBounds) :
+    simPtr(std::move(simPtr)),
+    simBounds(simBounds),
+    thread([this](const std::stop_token& stopToken) {run(stopToken);}) {}
+
+std::unique_lock<std::mutex> SimulationThread::lock() {
+    lockRequests.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock simLock(simMutex);
+    lockRequests.fetch_sub(1, std::memory_order_relaxed);
+    return simLock;
+}
+
+void SimulationThread::run(const std::stop_token& stopToken) {
+    const auto counterFrequency = static_cast<float>(SDL_GetPerformanceFrequency());
+    FixedStepScheduler scheduler;
+    uint64_t last = SDL_GetPerformanceCounter();
+
+    while(!stopToken.stop_requested()) {
+        scheduler.setSpeed(speed.load(std::memory_order_relaxed));
+        const uint64_t frameStart = SDL_GetPerformanceCounter();
+        scheduler.addRealTime(static_cast<float>(frameStart - last) / counterFrequency);
+        last = frameStart;
+
+        //one step per lock so the ui can get in between them
+        while(scheduler.isStepDue() && !stopToken.stop_requested()) {
+            {
+                const std::lock_guard lock(simMutex);
+                simPtr->step(scheduler.getFixedDeltaTime(), simBounds);
+                scheduler.consumeStep();
+                const uint64_t tick = ticks.fetch_add(1, std::memory_order_relaxed) + 1;
+
+                //only copied once the last one was drawn, ticks in between cost nothing extra
+                if(tick % renderInterval.load(std::memory_order_relaxed) == 0 && renderBuffer.isWanted()) {
+                    TickProfiler::ScopedTimer timer(simPtr->getProfiler().get(), ProfilerPhase::RENDER_SNAPSHOT);
+                    simPtr->writeRenderSnapshot(&renderBuffer.getBack());
+                    renderBuffer.publish();
+                }
+            }
+
+            while(lockRequests.load(std::memory_order_relaxed) > 0) std::this_thread::yield();
+
+            const float frameSeconds = static_cast<float>(SDL_GetPerformanceCounter() - frameStart) / counterFrequency;
+            if(frameSeconds >= scheduler.getMaxCatchUpSeconds()) {
+                scheduler.dropBacklog();
+                break;
+            }
+        }
+
+        const float secondsUntilNextStep = scheduler.getSecondsUntilNextStep();
+        if(secondsUntilNextStep > 0.0f) SDL_DelayNS(static_cast<uint64_t>(secondsUntilNextStep * 1e9f));
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SIMULATIONTHREAD_HPP
+#define SIMULATIONTHREAD_HPP
+
+#include "Simulation.hpp"
+#include "RenderSnapshot.hpp"
+#include "FixedStepScheduler.hpp"
+#include "SDL3/SDL.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+/**
+ * Steps a simulation on its own thread so drawing and the ui never wait for a tick and a slow tick never drops frames.
+ * Ticks are fixed steps scheduled by a FixedStepScheduler at the chosen speed. Every render interval ticks, if the
+ * render thread has drawn the last snapshot, the simulation copies the next one into the render buffer.
+ * Every other call into the simulation has to hold lock(), the thread only lets go of it between ticks.
+ */
+class SimulationThread {
+public:
+    SimulationThread(std::shared_ptr<Simulation> simPtr, const SDL_Rect& simBounds);
+    //stops and joins the thread before the simulation is released
+    ~SimulationThread() = default;
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    /**
+     * Waits for the current tick to finish, the thread doesn't start the next one until the lock is released.
+     */
+    [[nodiscard]] std::unique_lock<std::mutex> lock();
+    //only use the simulation while holding lock()
+    [[nodiscard]] const std::shared_ptr<Simulation>& getSimulation() const {return simPtr;}
+    //hold lock() while calling, the bounds are passed to the next update
+    void setSimBounds(const SDL_Rect& newSimBounds) {simBounds = newSimBounds;}
+    RenderBuffer& getRenderBuffer() {return renderBuffer;}
+
+    void setSpeed(const SimulationSpeed newSpeed) {speed.store(newSpeed, std::memory_order_relaxed);}
+    [[nodiscard]] SimulationSpeed getSpeed() const {return speed.load(std::memory_order_relaxed);}
+    /**
+     * @param newRenderInterval only every newRenderInterval-th tick may copy a snapshot, fast forwarding skips the copies.
+     */
+    void setRenderInterval(const uint32_t newRenderInterval) {renderInterval.store(std::max(newRenderInterval, 1u), std::memory_order_relaxed);}
+    [[nodiscard]] uint32_t getRenderInterval() const {return renderInterval.load(std::memory_order_relaxed);}
+    [[nodiscard]] uint64_t getTicks() const {return ticks.load(std::memory_order_relaxed);}
+
+private:
+    std::shared_ptr<Simulation> simPtr;
+    std::mutex simMutex;
+    //threads waiting in lock(), the mutex isn't fair so the simulation thread steps aside for them between ticks
+    std::atomic<uint32_t> lockRequests = 0;
+    SDL_Rect simBounds;
+    RenderBuffer renderBuffer;
+    std::atomic<SimulationSpeed> speed = SimulationSpeed::X1;
+    std::atomic<uint32_t> renderInterval = 1;
+    std::atomic<uint64_t> ticks = 0;
+    //declared last so it's joined before the members it uses are destroyed
+    std::jthread thread;
+
+    void run(const std::stop_token& stopToken);
+};
+
+#endif //SIMULATIONTHREAD_HPP
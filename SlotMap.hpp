@@ -0,0 +1,134 @@
+#ifndef SLOTMAP_HPP
+#define SLOTMAP_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SlotHandle {
+    static constexpr uint64_t invalid = UINT64_MAX;
+    static constexpr uint32_t generationMask = 0x00FFFFFF;
+
+    [[nodiscard]] static constexpr uint32_t getIndex(const uint64_t handle) {return static_cast<uint32_t>(handle);}
+    [[nodiscard]] static constexpr uint32_t getGeneration(const uint64_t handle) {return static_cast<uint32_t>(handle >> 32) & generationMask;}
+    [[nodiscard]] static constexpr uint8_t getKind(const uint64_t handle) {return static_cast<uint8_t>(handle >> 56);}
+    [[nodiscard]] static constexpr uint64_t make(const uint8_t kind, const uint32_t index, const uint32_t generation) {
+        return (static_cast<uint64_t>(kind) << 56) | (static_cast<uint64_t>(generation & generationMask) << 32) | index;
+    }
+}
+
+/**
+ * Stores values contiguously and hands out generational handles to them.
+ * Iterating the values is a linear walk over one vector, erasing swaps the last value into the hole,
+ * and a handle goes stale (get returns nullptr) as soon as the value it points to is erased.
+ * A handle packs the slot index (low 32 bits), the slot generation (next 24 bits) and the map's kind (top 8 bits),
+ * so handles from maps with different kinds never collide and the owning map can be found from the handle alone.
+ */
+template<typename T>
+class SlotMap {
+public:
+    explicit SlotMap(const uint8_t kind) : kind(kind) {}
+
+    /**
+     * @param create called with the new value's handle, returns the value to store.
+     * Values are constructed before the storage grows, so create may read other values of this map,
+     * but pointers and references to values are invalidated once emplace returns.
+     * @return the handle of the new value.
+     */
+    template<typename Factory>
+    uint64_t emplace(Factory&& create) {
+        uint32_t slotIndex;
+        if(freeSlots.empty()) {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back({0, 0});
+        }else {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        const uint64_t handle = SlotHandle::make(kind, slotIndex, slots[slotIndex].generation);
+        dense.push_back(create(handle));
+        denseToSlot.push_back(slotIndex);
+        slots[slotIndex].denseIndex = static_cast<uint32_t>(dense.size() - 1);
+        return handle;
+    }
+
+    /**
+     * @return the position of the handle's value in the dense storage, or -1 if it has been erased.
+     */
+    [[nodiscard]] int64_t indexOf(const uint64_t handle) const {
+        const uint32_t slotIndex = SlotHandle::getIndex(handle);
+        if(SlotHandle::getKind(handle) != kind || slotIndex >= slots.size()) return -1;
+        const Slot& slot = slots[slotIndex];
+        //a freed slot has already moved on to the next generation, so its old handles fail here
+        if(slot.generation != SlotHandle::getGeneration(handle)) return -1;
+        return slot.denseIndex;
+    }
+
+    [[nodiscard]] T* get(const uint64_t handle) {
+        const int64_t denseIndex = indexOf(handle);
+        return denseIndex >= 0 ? &dense[denseIndex] : nullptr;
+    }
+    [[nodiscard]] const T* get(const uint64_t handle) const {
+        const int64_t denseIndex = indexOf(handle);
+        return denseIndex >= 0 ? &dense[denseIndex] : nullptr;
+    }
+    [[nodiscard]] bool contains(const uint64_t handle) const {return indexOf(handle) >= 0;}
+
+    bool erase(const uint64_t handle) {
+        const int64_t denseIndex = indexOf(handle);
+        if(denseIndex < 0) return false;
+        eraseAt(static_cast<size_t>(denseIndex));
+        return true;
+    }
+
+    /**
+     * Erases the value at a position of the dense storage, the last value is moved into its place.
+     */
+    void eraseAt(const size_t denseIndex) {
+        const uint32_t slotIndex = denseToSlot[denseIndex];
+        const size_t lastIndex = dense.size() - 1;
+        if(denseIndex != lastIndex) {
+            dense[denseIndex] = std::move(dense[lastIndex]);
+            denseToSlot[denseIndex] = denseToSlot[lastIndex];
+            slots[denseToSlot[denseIndex]].denseIndex = static_cast<uint32_t>(denseIndex);
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+
+        slots[slotIndex].generation = (slots[slotIndex].generation + 1) & SlotHandle::generationMask;
+        freeSlots.push_back(slotIndex);
+    }
+
+    [[nodiscard]] uint64_t handleAt(const size_t denseIndex) const {
+        const uint32_t slotIndex = denseToSlot[denseIndex];
+        return SlotHandle::make(kind, slotIndex, slots[slotIndex].generation);
+    }
+
+    void reserve(const size_t capacity) {
+        dense.reserve(capacity);
+        denseToSlot.reserve(capacity);
+        slots.reserve(capacity);
+    }
+    [[nodiscard]] size_t size() const {return dense.size();}
+    [[nodiscard]] bool empty() const {return dense.empty();}
+    T& operator[](const size_t denseIndex) {return dense[denseIndex];}
+    const T& operator[](const size_t denseIndex) const {return dense[denseIndex];}
+    typename std::vector<T>::iterator begin() {return dense.begin();}
+    typename std::vector<T>::iterator end() {return dense.end();}
+    typename std::vector<T>::const_iterator begin() const {return dense.begin();}
+    typename std::vector<T>::const_iterator end() const {return dense.end();}
+
+private:
+    struct Slot {
+        uint32_t denseIndex;
+        uint32_t generation;
+    };
+
+    uint8_t kind;
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+};
+
+#endif //SLOTMAP_HPP
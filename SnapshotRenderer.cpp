@@ -0,0 +1,134 @@
+#include "SnapshotRenderer.hpp"
+#include "SimUtils.hpp"
+#include "SDL3_image/SDL_image.h"
+#include <cmath>
+#include <filesystem>
+#include <string>
+
+SnapshotRenderer::SnapshotRenderer(SDL_Renderer* rendererPtr) : rendererPtr(rendererPtr) {
+    loadFireAnimation();
+}
+
+SnapshotRenderer::~SnapshotRenderer() {
+    for(SDL_Texture* frame : fireFrames) SDL_DestroyTexture(frame);
+    if(heatMap.texture) SDL_DestroyTexture(heatMap.texture);
+    if(atmosphereMap.texture) SDL_DestroyTexture(atmosphereMap.texture);
+}
+
+void SnapshotRenderer::loadFireAnimation() {
+    const char* basePath = SDL_GetBasePath();
+    std::filesystem::path base(basePath);
+    std::filesystem::path imagesPath = base / "../resources/images/";
+    std::filesystem::path firePath = imagesPath / "fire.gif";
+    std::string firePathStr = firePath.lexically_normal().string();
+
+    SDL_IOStream* stream = SDL_IOFromFile(firePathStr.c_str(), "r");
+    if(!stream) {
+        SDL_Log("%s", SDL_GetError());
+        return;
+    }
+    IMG_Animation* animation = IMG_LoadGIFAnimation_IO(stream);
+    if(!animation) SDL_Log("%s", SDL_GetError());
+    if(!SDL_CloseIO(stream)) SDL_Log("%s", SDL_GetError());
+    if(!animation) return;
+
+    float animationLength = 0.0f;
+    for(int i = 0; i < animation->count; i++) {
+        SDL_Texture* frame = SDL_CreateTextureFromSurface(rendererPtr, animation->frames[i]);
+        if(!frame) {
+            SDL_Log("%s", SDL_GetError());
+            continue;
+        }
+        animationLength += static_cast<float>(animation->delays[i]) / 1000.0f;
+        fireFrames.push_back(frame);
+        fireFrameEnds.push_back(animationLength);
+    }
+    IMG_FreeAnimation(animation);
+}
+
+SDL_Texture* SnapshotRenderer::getFireFrame(const float animationTime) const {
+    if(fireFrames.empty()) return nullptr;
+    const float animationLength = fireFrameEnds.back();
+    if(animationLength <= 0.0f) return fireFrames.front();
+    const float time = std::fmod(animationTime, animationLength);
+    for(size_t i = 0; i < fireFrames.size(); i++) {
+        if(time < fireFrameEnds[i]) return fireFrames[i];
+    }
+    return fireFrames.back();
+}
+
+/**
+ * Redraws the map's texture if the simulation rebuilt the map since the last frame, then draws it over the simulation bounds.
+ */
+void SnapshotRenderer::drawMap(const std::shared_ptr<const MapImage>& imagePtr, MapTexture* mapTexturePtr, const SDL_FRect& destination) {
+    if(!imagePtr) return;
+    if(mapTexturePtr->imagePtr != imagePtr) {
+        if(mapTexturePtr->texture) SDL_DestroyTexture(mapTexturePtr->texture);
+        mapTexturePtr->imagePtr = imagePtr;
+        mapTexturePtr->texture = SDL_CreateTexture(rendererPtr, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, imagePtr->width, imagePtr->height);
+        if(!mapTexturePtr->texture) {
+            SDL_Log("%s", SDL_GetError());
+            return;
+        }
+
+        SDL_SetRenderTarget(rendererPtr, mapTexturePtr->texture);
+        SDL_SetRenderDrawColor(rendererPtr, 255, 255, 255, 100);
+        SDL_RenderClear(rendererPtr);
+        for(size_t i = 0; i < imagePtr->cells.size(); i++) {
+            const SDL_Color& color = imagePtr->colors[i];
+            SDL_SetRenderDrawColor(rendererPtr, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRect(rendererPtr, &imagePtr->cells[i]);
+        }
+        SDL_SetRenderTarget(rendererPtr, NULL);
+    }
+    if(mapTexturePtr->texture) SDL_RenderTexture(rendererPtr, mapTexturePtr->texture, NULL, &destination);
+}
+
+/**
+ * Fills the shapes in order, consecutive shapes of the same color are drawn with one call.
+ */
+void SnapshotRenderer::drawShapes(const std::vector<RenderSnapshot::Shape>& shapes) {
+    for(size_t begin = 0; begin < shapes.size();) {
+        const SDL_Color color = shapes[begin].color;
+        rectBatch.clear();
+        size_t end = begin;
+        for(; end < shapes.size(); end++) {
+            const SDL_Color& shapeColor = shapes[end].color;
+            if(shapeColor.r != color.r || shapeColor.g != color.g || shapeColor.b != color.b || shapeColor.a != color.a) break;
+            rectBatch.push_back(shapes[end].box);
+        }
+        SDL_SetRenderDrawColor(rendererPtr, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRects(rendererPtr, rectBatch.data(), static_cast<int>(rectBatch.size()));
+        begin = end;
+    }
+}
+
+void SnapshotRenderer::draw(const RenderSnapshot& snapshot) {
+    const SDL_FRect simBoundsFRect = SimUtils::rectToFRect(snapshot.simBounds);
+    drawMap(snapshot.heatMapPtr, &heatMap, simBoundsFRect);
+    drawMap(snapshot.atmosphereMapPtr, &atmosphereMap, simBoundsFRect);
+    if(snapshot.showFoodSpawnRange) {
+        SDL_SetRenderDrawColor(rendererPtr, 255, 255, 0, 100);
+        const SDL_FRect foodSpawnRangeFloat = SimUtils::rectToFRect(snapshot.foodSpawnRange);
+        SDL_RenderFillRect(rendererPtr, &foodSpawnRangeFloat);
+    }
+
+    drawShapes(snapshot.shapes);
+    if(!snapshot.triangles.empty() && !SDL_RenderGeometry(
+            rendererPtr,
+            NULL,
+            snapshot.triangles.data(),
+            static_cast<int>(snapshot.triangles.size()),
+            NULL,
+            0))
+        SDL_Log("%s", SDL_GetError());
+
+    for(const RenderSnapshot::FireSprite& fire : snapshot.fires) {
+        SDL_Texture* frame = getFireFrame(fire.animationTime);
+        if(!frame) break;
+        SDL_RenderTexture(rendererPtr, frame, NULL, &fire.box);
+    }
+
+    if(snapshot.spatialIndexPtr) snapshot.spatialIndexPtr->show(rendererPtr);
+    if(snapshot.staticSpatialIndexPtr) snapshot.staticSpatialIndexPtr->show(rendererPtr);
+}
@@ -0,0 +1,43 @@
+#ifndef SNAPSHOTRENDERER_HPP
+#define SNAPSHOTRENDERER_HPP
+
+#include "RenderSnapshot.hpp"
+#include "SDL3/SDL.h"
+#include <memory>
+#include <vector>
+
+/**
+ * Draws render snapshots on the thread owning the renderer. Owns every texture the simulation used to create itself:
+ * the fire animation, loaded once and shared by every fire, and the heat and atmosphere map textures, which are only
+ * redrawn when the simulation hands over a new map image.
+ */
+class SnapshotRenderer {
+public:
+    explicit SnapshotRenderer(SDL_Renderer* rendererPtr);
+    ~SnapshotRenderer();
+    SnapshotRenderer(const SnapshotRenderer&) = delete;
+    SnapshotRenderer& operator=(const SnapshotRenderer&) = delete;
+
+    void draw(const RenderSnapshot& snapshot);
+
+private:
+    struct MapTexture {
+        std::shared_ptr<const MapImage> imagePtr;
+        SDL_Texture* texture = nullptr;
+    };
+
+    SDL_Renderer* rendererPtr;
+    std::vector<SDL_Texture*> fireFrames;
+    //seconds from the start of the animation to the end of every frame
+    std::vector<float> fireFrameEnds;
+    MapTexture heatMap;
+    MapTexture atmosphereMap;
+    std::vector<SDL_FRect> rectBatch;
+
+    void loadFireAnimation();
+    [[nodiscard]] SDL_Texture* getFireFrame(float animationTime) const;
+    void drawMap(const std::shared_ptr<const MapImage>& imagePtr, MapTexture* mapTexturePtr, const SDL_FRect& destination);
+    void drawShapes(const std::vector<RenderSnapshot::Shape>& shapes);
+};
+
+#endif //SNAPSHOTRENDERER_HPP
@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "SDL3/SDL.h"
+#include "SpatialIndex.hpp"
+#include "LinearQuadTree.hpp"
+#include "QuadTree.hpp"
+#include "ThreadPool.hpp"
+#include "UniformGrid.hpp"
+#include "UtilityStructs.hpp"
+
+std::unique_ptr<SpatialIndex> SpatialIndex::create(const SpatialIndexType type, const SDL_FRect& bounds) {
+    switch(type) {
+        case SpatialIndexType::GRID:
+            return std::make_unique<UniformGrid>(bounds, 32.0f);
+        case SpatialIndexType::LINEAR_QUADTREE:
+            return std::make_unique<LinearQuadTree>(bounds);
+        case SpatialIndexType::QUADTREE:
+        default:
+            return std::make_unique<QuadTree>(bounds, 10);
+    }
+}
+
+SpatialIndexType SpatialIndex::parseType(const char* name) {
+    for(uint8_t i = 0; i < static_cast<uint8_t>(SpatialIndexType::SIZE); i++) {
+        const auto type = static_cast<SpatialIndexType>(i);
+        if(strcmp(name, getTypeName(type)) == 0) return type;
+    }
+    return SpatialIndexType::SIZE;
+}
+
+const char* SpatialIndex::getTypeName(const SpatialIndexType type) {
+    switch(type) {
+        case SpatialIndexType::QUADTREE: return "quadtree";
+        case SpatialIndexType::GRID: return "grid";
+        case SpatialIndexType::LINEAR_QUADTREE: return "linear";
+        default: return "unknown";
+    }
+}
+
+Vec2 SpatialIndex::getRayDirection(Vec2 velocityCopy) {
+    if(std::max(std::abs(velocityCopy.x), std::abs(velocityCopy.y)) == std::abs(velocityCopy.x)) {
+        velocityCopy.y = 0.0f;
+    }else velocityCopy.x = 0.0f;
+    return velocityCopy;
+}
+
+SDL_FRect SpatialIndex::getRay(const Vec2& direction, const Object& object, float rayDistance, const SDL_FRect& bounds) {
+    assert(rayDistance > object.boundingBox.w && rayDistance > object.boundingBox.h);
+    float x, y;
+    float rayWidth = rayDistance, rayHeight = rayDistance;
+
+    if(direction.x == 0.0f) {
+        rayWidth *= 0.10f;
+        float potentialX = object.boundingBox.x - ((rayWidth * 0.5f) + (object.boundingBox.w * 0.5f));
+        x = potentialX < bounds.x ? bounds.x : potentialX;
+    }else if(std::signbit(direction.x)) { //left ray
+        float potentialX = object.boundingBox.x - rayDistance;
+        x = potentialX < bounds.x ? bounds.x : potentialX;
+    }else { //right ray
+        x = object.boundingBox.x + object.boundingBox.w;
+        rayWidth = x + rayDistance > bounds.x + bounds.w ? (bounds.x + bounds.w) - x : rayDistance;
+    }
+
+    if(direction.y == 0.0f) {
+        rayHeight *= 0.10f;
+        float potentialY = object.boundingBox.y - ((rayHeight * 0.5f) + (object.boundingBox.h * 0.5f));
+        y = potentialY < bounds.y ? bounds.y : potentialY;
+    }else if(std::signbit(direction.y)) { //up ray
+        float potentialY = object.boundingBox.y - rayDistance;
+        y = potentialY < bounds.y ? bounds.y : potentialY;
+    }else { //down ray
+        y = object.boundingBox.y + object.boundingBox.h;
+        rayHeight = y + rayDistance > bounds.y + bounds.h ? (bounds.y + bounds.h) - y : rayDistance;
+    }
+
+    return SDL_FRect{x, y, rayWidth, rayHeight};
+}
+
+void SpatialIndex::rankRayHit(const Object& object, const Object& hit, const std::span<RayHit> hits, uint8_t* countPtr) {
+    for(uint8_t i = 0; i < *countPtr; i++) {
+        if(hits[i].neighbor.id == hit.id) return;
+    }
+    const Vec2 distance = getMinDistanceBetweenRects(object.boundingBox, hit.boundingBox);
+    const RayHit rayHit = {{hit.id, hit.kind, distance}, distance.x * distance.x + distance.y * distance.y, hit.highPriority};
+    insertRanked(hits, countPtr, rayHit, [](const RayHit& hit1, const RayHit& hit2) -> bool {
+        if(hit1.highPriority != hit2.highPriority) return hit1.highPriority;
+        //send hits with 0 distance to our object (collisions) behind the others, so they don't take up space of actual neighbors
+        const bool isTouching1 = hit1.distanceSquared == 0.0f;
+        const bool isTouching2 = hit2.distanceSquared == 0.0f;
+        if(isTouching1 != isTouching2) return isTouching2;
+        return isCloser(hit1.distanceSquared, hit1.neighbor.id, hit2.distanceSquared, hit2.neighbor.id);
+    });
+}
+
+uint8_t SpatialIndex::copyRayHits(const std::span<const RayHit> hits, const uint8_t count, const std::span<Neighbor> neighbors) {
+    for(uint8_t i = 0; i < count; i++) neighbors[i] = hits[i].neighbor;
+    return count;
+}
+
+float SpatialIndex::getRayGap(const Vec2& direction, const SDL_FRect& box, const SDL_FRect& range) {
+    if(direction.x != 0.0f) {
+        return std::signbit(direction.x) ? box.x - (range.x + range.w) : range.x - (box.x + box.w);
+    }
+    if(direction.y != 0.0f) {
+        return std::signbit(direction.y) ? box.y - (range.y + range.h) : range.y - (box.y + box.h);
+    }
+    return 0.0f;
+}
+
+bool SpatialIndex::areRayHitsFinal(const std::span<const RayHit> hits, const uint8_t count, const float gap) {
+    if(count < hits.size()) return false;
+    const RayHit& last = hits[count - 1];
+    return last.highPriority && last.distanceSquared > 0.0f && gap > 0.0f && last.distanceSquared < gap * gap;
+}
+
+std::vector<uint64_t> SpatialIndex::query(const Object& object) const {
+    std::vector<uint64_t> ids;
+    findOverlapping(object, &ids);
+    return ids;
+}
+
+std::vector<SpatialIndex::Neighbor> SpatialIndex::getNearestNeighbors(const Object& object) const {
+    std::vector<Neighbor> neighbors(maxNeighbors);
+    neighbors.resize(findNearestNeighbors(object, neighbors));
+    return neighbors;
+}
+
+uint8_t SpatialIndex::findRayHits(const Object& object, const Vec2 velocityCopy, const std::span<Neighbor> hits) const {
+    std::array<RayHit, maxNeighbors> ranked;
+    uint8_t count = 0;
+    castRay(object, velocityCopy, ranked, &count);
+    return copyRayHits(ranked, count, hits);
+}
+
+void SpatialIndex::castRay(const Object& object, const Vec2 velocityCopy, const std::span<RayHit> hits, uint8_t* countPtr) const {
+    const Vec2 direction = getRayDirection(velocityCopy);
+    const SDL_FRect bounds = getBounds();
+    const SDL_FRect ray = getRay(direction, object, rayDistance, bounds);
+    if(rangeIntersectsRect(bounds, ray)) rankRayHits(object, direction, ray, hits, countPtr);
+}
+
+std::vector<SpatialIndex::Neighbor> SpatialIndex::raycast(const Object& object, const Vec2 velocityCopy) const {
+    std::vector<Neighbor> hits(maxNeighbors);
+    hits.resize(findRayHits(object, velocityCopy, hits));
+    return hits;
+}
+
+/**
+ * Spreads the low 16 bits of value out to the even bits.
+ */
+static uint32_t spreadBits(uint32_t value) {
+    value &= 0x0000FFFF;
+    value = (value | (value << 8)) & 0x00FF00FF;
+    value = (value | (value << 4)) & 0x0F0F0F0F;
+    value = (value | (value << 2)) & 0x33333333;
+    value = (value | (value << 1)) & 0x55555555;
+    return value;
+}
+
+uint32_t SpatialIndex::getMortonCode(const uint32_t column, const uint32_t row) {
+    return spreadBits(column) | (spreadBits(row) << 1);
+}
+
+void SpatialIndex::findAllNeighbors(
+    const std::span<const Object> objects,
+    const std::span<const Vec2> velocities,
+    const NeighborRows& rows,
+    std::vector<uint64_t>* orderPtr,
+    const SpatialIndex* otherIndexPtr,
+    ThreadPool* threadPoolPtr
+) const {
+    assert(velocities.size() == objects.size());
+    assert(rows.neighbors.size() >= objects.size() * maxNeighbors && rows.raycastNeighbors.size() >= objects.size() * maxNeighbors);
+    assert(rows.neighborCounts.size() >= objects.size() && rows.raycastCounts.size() >= objects.size());
+
+    //one pixel per Morton cell, the code sits above the object's index so sorting the keys sorts the indices
+    const SDL_FRect bounds = getBounds();
+    const auto toCell = [](const float offset) -> uint32_t {
+        return static_cast<uint32_t>(std::clamp(offset, 0.0f, static_cast<float>(UINT16_MAX)));
+    };
+    orderPtr->clear();
+    for(uint32_t i = 0; i < objects.size(); i++) {
+        const SDL_FRect& box = objects[i].boundingBox;
+        const uint32_t column = toCell(box.x + box.w * 0.5f - bounds.x);
+        const uint32_t row = toCell(box.y + box.h * 0.5f - bounds.y);
+        const uint64_t code = getMortonCode(column, row);
+        orderPtr->push_back((code << 32) | i);
+    }
+    std::sort(orderPtr->begin(), orderPtr->end());
+
+    const auto findRange = [&](const size_t begin, const size_t end) {
+        for(size_t k = begin; k < end; k++) findObjectNeighbors(objects, velocities, rows, static_cast<uint32_t>((*orderPtr)[k]), otherIndexPtr);
+    };
+    //each chunk is a run of nearby objects, so a worker still walks the same nodes or cells from one lookup to the next
+    if(threadPoolPtr) threadPoolPtr->parallelFor(orderPtr->size(), neighborChunkSize, findRange);
+    else findRange(0, orderPtr->size());
+}
+
+void SpatialIndex::findObjectNeighbors(
+    const std::span<const Object> objects,
+    const std::span<const Vec2> velocities,
+    const NeighborRows& rows,
+    const uint32_t i,
+    const SpatialIndex* otherIndexPtr
+) const {
+    const size_t rowStart = static_cast<size_t>(i) * maxNeighbors;
+    const std::span<Neighbor> neighborRow = rows.neighbors.subspan(rowStart, maxNeighbors);
+    uint8_t neighborCount = findNearestNeighbors(objects[i], neighborRow);
+    std::array<RayHit, maxNeighbors> ranked;
+    uint8_t rayCount = 0;
+    if(otherIndexPtr) {
+        std::array<Neighbor, maxNeighbors> otherNeighbors;
+        const uint8_t otherCount = otherIndexPtr->findNearestNeighbors(objects[i], otherNeighbors);
+        for(uint8_t j = 0; j < otherCount; j++) {
+            insertRanked(neighborRow, &neighborCount, otherNeighbors[j],
+                [](const Neighbor& neighbor1, const Neighbor& neighbor2) {return neighbor1.distance < neighbor2.distance;});
+        }
+        otherIndexPtr->castRay(objects[i], velocities[i], ranked, &rayCount);
+    }
+    castRay(objects[i], velocities[i], ranked, &rayCount);
+    rows.neighborCounts[i] = neighborCount;
+    rows.raycastCounts[i] = copyRayHits(ranked, rayCount, rows.raycastNeighbors.subspan(rowStart, maxNeighbors));
+}
+
+bool SpatialIndex::rangeIntersectsRect(const SDL_FRect& rect, const SDL_FRect& range) {
+    return !(range.x > rect.x  +  rect.w  ||
+             range.x + range.w <  rect.x  ||
+             range.y > rect.y  +  rect.h  ||
+             range.y + range.h <  rect.y  );
+}
+
+bool SpatialIndex::rangeIsNearRect(const SDL_FRect& rect, const SDL_FRect& range) {
+    return !(range.x - (rect.x  +  rect.w) > isNearDistance ||
+             rect.x  - (range.x + range.w) > isNearDistance ||
+             range.y - (rect.y  +  rect.h) > isNearDistance ||
+             rect.y  - (range.y + range.h) > isNearDistance );
+}
+
+Vec2 SpatialIndex::getMinDistanceBetweenRects(const SDL_FRect& rect, const SDL_FRect& range) {
+    float distLeft   = rect.x  - (range.x + range.w);
+    float distRight  = range.x - (rect.x  + rect.w );
+    float distTop    = rect.y  - (range.y + range.h);
+    float distBottom = range.y - (rect.y  + rect.h );
+    float distX, distY;
+    if(distLeft < 0.0f && distRight < 0.0f) {
+        distX = 0.0f;
+    }else if(distLeft < 0.0f) {
+        distX = distRight;
+    }else distX = -distLeft;
+    if(distTop < 0.0f && distBottom < 0.0f) {
+        distY = 0.0f;
+    }else if(distTop < 0.0f) {
+        distY = distBottom;
+    }else distY = -distTop;
+
+    return {distX, distY};
+}
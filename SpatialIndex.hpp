@@ -0,0 +1,235 @@
+#ifndef SPATIALINDEX_HPP
+#define SPATIALINDEX_HPP
+
+#include "SDL3/SDL.h"
+#include "UtilityStructs.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class ThreadPool;
+
+enum class SpatialIndexType : uint8_t {
+    QUADTREE,
+    GRID,
+    LINEAR_QUADTREE,
+    SIZE
+};
+
+/**
+ * The spatial queries the simulation and organisms need, answered by one of the backends in SpatialIndexType.
+ * Every backend follows the same rules: neighbors are the nearest objects within isNearDistance ranked by isCloser,
+ * rays are the same axis aligned rectangle and intersections touch inclusively, only the data structure and the
+ * lookup cost differ.
+ */
+class SpatialIndex {
+public:
+    struct Object {
+        uint64_t id;
+        SDL_FRect boundingBox;
+        EntityKind kind;
+        bool highPriority;
+
+        Object(const SDL_FRect& boundingBox, const bool setHighPriority = false) :
+            id(UINT64_MAX), boundingBox(boundingBox), kind(EntityKind::SIZE), highPriority(setHighPriority) {};
+        Object(const uint64_t id, const EntityKind kind, const SDL_FRect& boundingBox, const bool setHighPriority = false) :
+            id(id), boundingBox(boundingBox), kind(kind), highPriority(setHighPriority) {};
+
+        bool operator==(const Object& other) const {
+            return this->id == other.id;
+        }
+        bool operator<(const Object& other) const {
+            return this->id < other.id;
+        }
+        bool operator>(const Object& other) const {
+            return this->id > other.id;
+        }
+    };
+    struct Neighbor {
+        uint64_t id;
+        EntityKind kind;
+        Vec2 distance; //min distance from the searching object's bounding box to this neighbor's
+    };
+
+    struct Intersection {
+        uint64_t id1;
+        EntityKind kind1;
+        uint64_t id2;
+        EntityKind kind2;
+    };
+
+    static constexpr uint8_t maxNeighbors = 8;
+
+    /**
+     * Where findAllNeighbors writes, row i of both buffers starts at i * maxNeighbors and holds counts[i] entries.
+     */
+    struct NeighborRows {
+        std::span<Neighbor> neighbors;
+        std::span<uint8_t> neighborCounts;
+        std::span<Neighbor> raycastNeighbors;
+        std::span<uint8_t> raycastCounts;
+    };
+
+    /**
+     * @param bounds the area objects can be inserted into, objects entirely outside of it are ignored.
+     */
+    static std::unique_ptr<SpatialIndex> create(SpatialIndexType type, const SDL_FRect& bounds);
+    /**
+     * @return the type named by name ("quadtree", "grid" or "linear"), SpatialIndexType::SIZE if there is none.
+     */
+    static SpatialIndexType parseType(const char* name);
+    static const char* getTypeName(SpatialIndexType type);
+
+    virtual ~SpatialIndex() = default;
+
+    virtual void insert(const Object& object) = 0;
+    virtual void remove(const Object& object) = 0;
+    /**
+     * Updates an object that was inserted with oldBoundingBox to object.boundingBox, same as remove then insert.
+     */
+    virtual void move(const Object& object, const SDL_FRect& oldBoundingBox) = 0;
+    /**
+     * Called once every fixed step after the step's removals, lets a backend shrink structures that emptied out.
+     * @param threadPoolPtr lets a backend split the work across its workers, may be nullptr.
+     */
+    virtual void compact(ThreadPool* /*threadPoolPtr*/ = nullptr) {}
+    /**
+     * Removes every object and moves the index to new bounds.
+     */
+    virtual void reset(const SDL_FRect& bounds) = 0;
+    /**
+     * @return a copy that can be read on another thread while this index keeps changing.
+     */
+    [[nodiscard]] virtual std::unique_ptr<SpatialIndex> clone() const = 0;
+
+    [[nodiscard]] std::vector<uint64_t> query(const Object& object) const;
+    /**
+     * Writes the ids of every other object intersecting object into *idsPtr, replacing what it held,
+     * so a caller keeping the vector between lookups doesn't allocate once it has grown.
+     */
+    virtual void findOverlapping(const Object& object, std::vector<uint64_t>* idsPtr) const = 0;
+    [[nodiscard]] std::vector<Neighbor> getNearestNeighbors(const Object& object) const;
+    [[nodiscard]] std::vector<Neighbor> raycast(const Object& object, Vec2 velocityCopy) const;
+    /**
+     * Finds the nearest neighbors and ray hits of every object in one pass without allocating once orderPtr has grown.
+     * Objects are visited in the Morton order of their centers, so consecutive lookups walk the same nodes or cells
+     * while they're still cached, the results still land in the row of each object's position in objects.
+     * @param orderPtr scratch space, kept by the caller between passes.
+     * @param otherIndexPtr another index whose objects are ranked in as if they were in this one, may be nullptr.
+     * @param threadPoolPtr splits the lookups into runs of the Morton order across its workers, may be nullptr.
+     * Lookups only read the index and every object writes its own rows, so the results don't depend on the split.
+     */
+    void findAllNeighbors(std::span<const Object> objects, std::span<const Vec2> velocities, const NeighborRows& rows,
+        std::vector<uint64_t>* orderPtr, const SpatialIndex* otherIndexPtr = nullptr, ThreadPool* threadPoolPtr = nullptr) const;
+    /**
+     * Writes the nearest neighbors of object into neighbors, sorted by isCloserNeighbor.
+     * Objects touching it are collisions rather than neighbors.
+     * @return the amount of neighbors written, at most maxNeighbors.
+     */
+    virtual uint8_t findNearestNeighbors(const Object& object, std::span<Neighbor> neighbors) const = 0;
+    /**
+     * Writes the objects the ray cast along velocityCopy hits into hits, ranked like rankRayHit.
+     * @return the amount of hits written, at most maxNeighbors.
+     */
+    uint8_t findRayHits(const Object& object, Vec2 velocityCopy, std::span<Neighbor> hits) const;
+    [[nodiscard]] virtual std::vector<Intersection> getIntersections() const = 0;
+    [[nodiscard]] virtual SDL_FRect getBounds() const = 0;
+
+    virtual void show(SDL_Renderer* rendererPtr) const = 0;
+    /**
+     * @return the amount of stored entries, objects stored in several cells or leaves count once per cell or leaf.
+     */
+    [[nodiscard]] virtual size_t size() const = 0;
+
+    [[nodiscard]] static bool rangeIntersectsRect(const SDL_FRect& rect, const SDL_FRect& range);
+    [[nodiscard]] static bool rangeIsNearRect(const SDL_FRect& rect, const SDL_FRect& range);
+    [[nodiscard]] static Vec2 getMinDistanceBetweenRects(const SDL_FRect& rect, const SDL_FRect& range);
+
+protected:
+    static constexpr float isNearDistance = 20.0f;
+    static constexpr float rayDistance = 400.0f;
+    //objects per chunk when findAllNeighbors is split across a thread pool
+    static constexpr size_t neighborChunkSize = 256;
+
+    [[nodiscard]] static float getDistanceSquared(const Vec2& distance) {return distance.x * distance.x + distance.y * distance.y;}
+    /**
+     * The order every backend ranks neighbors and ray hits of the same priority in: nearest first, ties broken by id
+     * so the result doesn't depend on the order a backend visits objects in.
+     */
+    [[nodiscard]] static bool isCloser(const float distanceSquared1, const uint64_t id1, const float distanceSquared2, const uint64_t id2) {
+        if(distanceSquared1 != distanceSquared2) return distanceSquared1 < distanceSquared2;
+        return id1 < id2;
+    }
+    [[nodiscard]] static bool isCloserNeighbor(const Neighbor& neighbor1, const Neighbor& neighbor2) {
+        return isCloser(getDistanceSquared(neighbor1.distance), neighbor1.id, getDistanceSquared(neighbor2.distance), neighbor2.id);
+    }
+
+    struct RayHit {
+        Neighbor neighbor;
+        //compared instead of the distance's length, 0 for objects touching the caster
+        float distanceSquared;
+        bool highPriority;
+    };
+
+    /**
+     * Interleaves the bits of a 16 bit column and row, row in the odd bits, so sorting by code walks the cells quad by quad.
+     */
+    [[nodiscard]] static uint32_t getMortonCode(uint32_t column, uint32_t row);
+    /**
+     * Snaps a velocity to the axis it moves fastest along, rays are only cast horizontally or vertically.
+     */
+    [[nodiscard]] static Vec2 getRayDirection(Vec2 velocityCopy);
+    [[nodiscard]] static SDL_FRect getRay(const Vec2& direction, const Object& object, float rayDistance, const SDL_FRect& bounds);
+    /**
+     * Finds the neighbors and ray hits of objects[i] and writes them into its rows, one step of findAllNeighbors.
+     */
+    void findObjectNeighbors(std::span<const Object> objects, std::span<const Vec2> velocities, const NeighborRows& rows,
+        uint32_t i, const SpatialIndex* otherIndexPtr) const;
+    /**
+     * Casts the ray along velocityCopy and ranks what it hits into the first *countPtr entries of hits.
+     */
+    void castRay(const Object& object, Vec2 velocityCopy, std::span<RayHit> hits, uint8_t* countPtr) const;
+    /**
+     * Ranks every object ray hits into hits with rankRayHit. hits may already hold the hits of another index,
+     * a backend walking the ray nearest first can stop on them too. Only called for rays inside getBounds.
+     */
+    virtual void rankRayHits(const Object& object, const Vec2& direction, const SDL_FRect& ray, std::span<RayHit> hits,
+        uint8_t* countPtr) const = 0;
+    /**
+     * Adds hit to the best hits of a ray so far, kept in order: high priority objects first, then by distance with
+     * objects touching the caster last. Hits already among them are skipped, so a backend can report an object twice.
+     */
+    static void rankRayHit(const Object& object, const Object& hit, std::span<RayHit> hits, uint8_t* countPtr);
+    static uint8_t copyRayHits(std::span<const RayHit> hits, uint8_t count, std::span<Neighbor> neighbors);
+    /**
+     * @return how far past the caster's edge range starts along the ray, 0 for rays without a direction since they have no order.
+     */
+    [[nodiscard]] static float getRayGap(const Vec2& direction, const SDL_FRect& box, const SDL_FRect& range);
+    /**
+     * A ray walked nearest first can stop once every hit is a high priority object closer than everything left to
+     * walk: lower priority objects rank behind them and the rest are at least gap away, an object exactly gap away
+     * could still win the tie on id.
+     * @param gap the smallest getRayGap of the part of the ray not walked yet.
+     */
+    [[nodiscard]] static bool areRayHitsFinal(std::span<const RayHit> hits, uint8_t count, float gap);
+
+    /**
+     * Inserts entry into the first *countPtr entries of ranked, which stay sorted by isBefore with ties in the order
+     * they were added. Once ranked is full the last entry is dropped, or entry if it comes after all of them.
+     */
+    template<typename Entry, typename IsBefore>
+    static void insertRanked(const std::span<Entry> ranked, uint8_t* countPtr, const Entry& entry, IsBefore&& isBefore) {
+        uint8_t position = *countPtr;
+        while(position > 0 && isBefore(entry, ranked[position - 1])) position--;
+        if(position >= ranked.size()) return;
+        const auto last = static_cast<uint8_t>(std::min<size_t>(*countPtr, ranked.size() - 1));
+        for(uint8_t i = last; i > position; i--) ranked[i] = ranked[i - 1];
+        ranked[position] = entry;
+        if(*countPtr < ranked.size()) (*countPtr)++;
+    }
+};
+
+#endif //SPATIALINDEX_HPP
@@ -2,22 +2,23 @@
 #define STATICSIMOBJECTS_HPP
 
 #include "SimObject.hpp"
+#include "RenderSnapshot.hpp"
 #include "SimUtils.hpp"
+#include "SimRandom.hpp"
 #include "SDL3/SDL.h"
 #include "SDL3_image/SDL_image.h"
-#include <filesystem>
 #include <random>
 
 class Food : public SimObject {
 public:
-    Food(const uint64_t id, const SDL_FRect& boundingBox, const SimUtils::SimState& simState, const bool inQuadTree) : SimObject(id, boundingBox, simState, inQuadTree) {}
+    Food(const uint64_t id, const SDL_FRect& boundingBox, const SimUtils::SimState& simState, const bool inQuadTree) : SimObject(id, EntityKind::FOOD, boundingBox, simState, inQuadTree) {}
     Food(const uint64_t id,
         const SDL_FRect& boundingBox,
         const SDL_Color& color,
         const int nutritionalValue,
         const SimUtils::SimState& simState,
         const bool inQuadTree) :
-        SimObject(id, boundingBox, color, simState, inQuadTree) {
+        SimObject(id, EntityKind::FOOD, boundingBox, color, simState, inQuadTree) {
         if(nutritionalValue <= 100 && nutritionalValue > 0)
             this->nutritionalValue = nutritionalValue;
     }
@@ -53,7 +54,7 @@ public:
         const uint16_t initialFoodAmount,
         const SimUtils::SimState& simState,
         const bool inQuadTree) :
-        SimObject(id, boundingBox, {0, 0, 0, 0}, simState, inQuadTree),
+        SimObject(id, EntityKind::FOOD_SPAWN_RANGE, boundingBox, {0, 0, 0, 0}, simState, inQuadTree),
         foodAmount(initialFoodAmount) {}
 
     [[nodiscard]] uint16_t getFoodAmount() const{return foodAmount;}
@@ -68,7 +69,7 @@ public:
         if(foodAmount == 0) markedForDeletion = true;
     }
 
-    void render(SDL_Renderer* rendererPtr) const override {} //dont render
+    void addToRenderSnapshot(RenderSnapshot* snapshotPtr) const override {} //dont render
 
 private:
     uint16_t foodAmount;
@@ -76,10 +77,11 @@ private:
 
 class Fire : public SimObject {
 public:
-    Fire(const uint64_t id, const SDL_FRect& boundingBox, const SimUtils::SimState& simState, SDL_Renderer* rendererPtr, const bool inQuadTree) :
+    Fire(const uint64_t id, const SDL_FRect& boundingBox, const SimUtils::SimState& simState, const bool inQuadTree) :
         renderBoundingBox(boundingBox),
         SimObject(
             id,
+            EntityKind::FIRE,
             {
                 boundingBox.x + 30,
                 boundingBox.y + 40,
@@ -87,18 +89,16 @@ public:
                 static_cast<float>(boundingBox.h)
             },
             simState,
-            inQuadTree) {
-        initializeTexture(rendererPtr);
-    }
+            inQuadTree) {}
     Fire(const uint64_t id,
          const SDL_FRect& boundingBox,
          const SDL_Color& color,
          const SimUtils::SimState& simState,
-         SDL_Renderer* rendererPtr,
          const bool inQuadTree) :
         renderBoundingBox(boundingBox),
         SimObject(
             id,
+            EntityKind::FIRE,
             {
                 boundingBox.x + 30,
                 boundingBox.y + 40,
@@ -106,64 +106,20 @@ public:
                 static_cast<float>(boundingBox.h) - 40
             },
             simState,
-            inQuadTree) {
-        initializeTexture(rendererPtr);
-    }
-    ~Fire() override {
-        SDL_DestroyTexture(texture);
-        IMG_FreeAnimation(animation);
-    }
+            inQuadTree) {}
 
     void update(const float deltaTime) override {
-        handleTimers(deltaTime);
-        SDL_Surface* writeableSurface;
-        SDL_LockTextureToSurface(texture, NULL, &writeableSurface);
-        SDL_memcpy(writeableSurface->pixels, animation->frames[framePos]->pixels, animation->frames[framePos]->h * animation->frames[framePos]->pitch);
-        SDL_UnlockTexture(texture);
+        animationTime += deltaTime;
     }
 
-    void render(SDL_Renderer* rendererPtr) const override {
-        const SDL_FRect rect{0, 0, static_cast<float>(texture->w), static_cast<float>(texture->h)};
-        SDL_RenderTexture(rendererPtr, texture, &rect, &renderBoundingBox);
+    //the flames are drawn over the whole box, the hitbox is only their lower middle
+    void addToRenderSnapshot(RenderSnapshot* snapshotPtr) const override {
+        snapshotPtr->fires.push_back({renderBoundingBox, animationTime});
     }
 
 private:
-    void initializeTexture(SDL_Renderer* rendererPtr) {
-        const char* basePath = SDL_GetBasePath();
-        std::filesystem::path base(basePath);
-        std::filesystem::path imagesPath = base / "../resources/images/";
-        std::filesystem::path firePath = imagesPath / "fire.gif";
-        std::string firePathStr = firePath.lexically_normal().string();
-
-
-        SDL_IOStream* stream = SDL_IOFromFile(firePathStr.c_str(), "r");
-        if(!stream) SDL_Log("%s", SDL_GetError());
-        animation = IMG_LoadGIFAnimation_IO(stream);
-        if(!animation) SDL_Log("%s", SDL_GetError());
-        if(!SDL_CloseIO(stream)) SDL_Log("%s", SDL_GetError());
-        texture = SDL_CreateTexture(
-            rendererPtr,
-            (*animation->frames)->format,
-            SDL_TEXTUREACCESS_STREAMING,
-            animation->w,
-            animation->h);
-    }
-
-    void handleTimers(const float deltaTime) {
-        if(frameTimer >= static_cast<float>(animation->delays[framePos]) / 1000.0f) {
-            framePos++;
-            if(framePos >= animation->count) {
-                framePos = 0;
-            }
-            frameTimer = 0.0f;
-        }else frameTimer += deltaTime;
-    }
-
-    uint8_t framePos = 0;
-    SDL_Texture* texture;
-    IMG_Animation* animation;
     SDL_FRect renderBoundingBox;
-    float frameTimer = 0.0f;
+    float animationTime = 0.0f;
 };
 
 class Water : public SimObject {
@@ -174,7 +130,7 @@ public:
         const std::vector<SDL_Vertex>& vertexVec,
         const SimUtils::SimState& simState,
         const bool inQuadTree) :
-            SimObject(id, boundingBox, {0, 0, 0, 0}, simState, inQuadTree),
+            SimObject(id, EntityKind::WATER, boundingBox, {0, 0, 0, 0}, simState, inQuadTree),
             vertices(vertexVec) {}
 
 private:
@@ -188,8 +144,9 @@ public:
          const SDL_FRect& boundingBox,
          const SDL_Color& color,
          const SimUtils::SimState& simState,
+         const SimRandom::Stream& rng,
         const bool inQuadTree) :
-            SimObject(id, boundingBox, color, simState, inQuadTree), originalPosition(boundingBox.x, boundingBox.y) {}
+            SimObject(id, EntityKind::PHEROMONE, boundingBox, color, simState, inQuadTree), originalPosition(boundingBox.x, boundingBox.y), rng(rng) {}
 
     void update(const float deltaTime) override {
         handleTimers(deltaTime);
@@ -200,16 +157,17 @@ private:
     static constexpr uint8_t maxAge = 20;
     float ageTimer = 0.0f;
     Vec2 originalPosition;
+    SimRandom::Stream rng;
 
     void handleTimers(const float deltaTime) {
         if(ageTimer >= 1.0f) {
             std::bernoulli_distribution distDriftChance(0.05);
-            if(distDriftChance(SimUtils::mt)) {
+            if(distDriftChance(rng)) {
                 std::bernoulli_distribution distDriftDirectionX(0.50);
                 std::bernoulli_distribution distDriftDirectionY(0.50);
-                if(distDriftDirectionX(SimUtils::mt)) boundingBox.x += 2.0f;
+                if(distDriftDirectionX(rng)) boundingBox.x += 2.0f;
                 else boundingBox.x -= 2.0f;
-                if(distDriftDirectionY(SimUtils::mt)) boundingBox.y += 2.0f;
+                if(distDriftDirectionY(rng)) boundingBox.y += 2.0f;
                 else boundingBox.y -= 2.0f;
             }
             age++;
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "SDL3/SDL.h"
+#include "SweepAndPrune.hpp"
+#include "SpatialIndex.hpp"
+
+uint64_t SweepAndPrune::getPairKey(const uint32_t proxy1, const uint32_t proxy2) {
+    return (static_cast<uint64_t>(std::min(proxy1, proxy2)) << 32) | std::max(proxy1, proxy2);
+}
+
+bool SweepAndPrune::overlaps(const uint32_t proxy1, const uint32_t proxy2) const {
+    return SpatialIndex::rangeIntersectsRect(boxes[proxy1], boxes[proxy2]);
+}
+
+void SweepAndPrune::setEndpointValues(const uint32_t proxyIndex) {
+    const Proxy& proxy = proxies[proxyIndex];
+    const SDL_FRect& box = boxes[proxyIndex];
+    axes[axisX][proxy.endpoints[axisX][0]].value = box.x;
+    axes[axisX][proxy.endpoints[axisX][1]].value = box.x + box.w;
+    axes[axisY][proxy.endpoints[axisY][0]].value = box.y;
+    axes[axisY][proxy.endpoints[axisY][1]].value = box.y + box.h;
+}
+
+/**
+ * Appends the object's endpoints to the end of the lists, the next sort moves them into place.
+ */
+void SweepAndPrune::insert(const SpatialIndex::Object& object) {
+    if(proxyOf.contains(object.id)) {
+        move(object);
+        return;
+    }
+    if(!SpatialIndex::rangeIntersectsRect(bounds, object.boundingBox)) return;
+
+    uint32_t proxyIndex;
+    if(!freeProxies.empty()) {
+        proxyIndex = freeProxies.back();
+        freeProxies.pop_back();
+    }else {
+        proxyIndex = static_cast<uint32_t>(proxies.size());
+        proxies.emplace_back();
+        boxes.emplace_back();
+    }
+    Proxy& proxy = proxies[proxyIndex];
+    proxy = {object.id, object.kind, true, 0, {}};
+    boxes[proxyIndex] = object.boundingBox;
+    for(size_t axis = 0; axis < axes.size(); axis++) {
+        for(uint32_t isMax = 0; isMax < 2; isMax++) {
+            proxy.endpoints[axis][isMax] = static_cast<uint32_t>(axes[axis].size());
+            axes[axis].push_back({0.0f, (proxyIndex << 1) | isMax});
+        }
+    }
+    setEndpointValues(proxyIndex);
+    proxyOf.emplace(object.id, proxyIndex);
+    insertedProxies++;
+}
+
+/**
+ * Moves the object's endpoints past every other endpoint, the next sort carries them to the end of the lists and drops its pairs.
+ */
+void SweepAndPrune::remove(const SpatialIndex::Object& object) {
+    const auto it = proxyOf.find(object.id);
+    if(it == proxyOf.end()) return;
+    const uint32_t proxyIndex = it->second;
+    constexpr float infinity = std::numeric_limits<float>::infinity();
+    proxies[proxyIndex].alive = false;
+    boxes[proxyIndex] = {infinity, infinity, 0.0f, 0.0f};
+    setEndpointValues(proxyIndex);
+    removedProxies.push_back(proxyIndex);
+    proxyOf.erase(it);
+}
+
+/**
+ * Updates the endpoints of an object to its current bounding box, objects that left the bounds are removed.
+ */
+void SweepAndPrune::move(const SpatialIndex::Object& object) {
+    const auto it = proxyOf.find(object.id);
+    if(it == proxyOf.end()) {
+        insert(object);
+        return;
+    }
+    if(!SpatialIndex::rangeIntersectsRect(bounds, object.boundingBox)) {
+        remove(object);
+        return;
+    }
+    boxes[it->second] = object.boundingBox;
+    setEndpointValues(it->second);
+}
+
+void SweepAndPrune::reset(const SDL_FRect& newBounds) {
+    *this = SweepAndPrune(newBounds);
+}
+
+void SweepAndPrune::addPair(const uint32_t proxy1, const uint32_t proxy2) {
+    const uint64_t key = getPairKey(proxy1, proxy2);
+    if(!pairIndex.try_emplace(key, static_cast<uint32_t>(pairs.size())).second) return;
+    pairs.push_back(key);
+    proxies[proxy1].pairCount++;
+    proxies[proxy2].pairCount++;
+}
+
+void SweepAndPrune::removePair(const uint32_t proxy1, const uint32_t proxy2) {
+    if(proxies[proxy1].pairCount == 0 || proxies[proxy2].pairCount == 0) return;
+    const auto it = pairIndex.find(getPairKey(proxy1, proxy2));
+    if(it == pairIndex.end()) return;
+    const uint32_t index = it->second;
+    pairIndex.erase(it);
+    proxies[proxy1].pairCount--;
+    proxies[proxy2].pairCount--;
+    const uint64_t lastKey = pairs.back();
+    pairs.pop_back();
+    if(index == pairs.size()) return;
+    pairs[index] = lastKey;
+    pairIndex[lastKey] = index;
+}
+
+void SweepAndPrune::updateEndpointPositions(const size_t axis) {
+    const std::vector<Endpoint>& endpoints = axes[axis];
+    for(uint32_t i = 0; i < endpoints.size(); i++) {
+        proxies[endpoints[i].getProxy()].endpoints[axis][endpoints[i].isMax()] = i;
+    }
+}
+
+/**
+ * Insertion sorts one axis' endpoints. A start passing an end means the two intervals overlap on this axis now,
+ * they become a pair if their boxes intersect, and an end passing a start means they stopped overlapping.
+ */
+void SweepAndPrune::sortAxis(const size_t axis) {
+    std::vector<Endpoint>& endpoints = axes[axis];
+    bool sorted = true;
+    for(uint32_t i = 1; i < endpoints.size(); i++) {
+        const Endpoint endpoint = endpoints[i];
+        if(!endpoint.isBefore(endpoints[i - 1])) continue;
+
+        sorted = false;
+        const uint32_t proxy = endpoint.getProxy();
+        uint32_t hole = i;
+        for(; hole > 0 && endpoint.isBefore(endpoints[hole - 1]); hole--) {
+            const Endpoint& previous = endpoints[hole - 1];
+            const uint32_t otherProxy = previous.getProxy();
+            if(!endpoint.isMax() && previous.isMax()) {
+                if(overlaps(proxy, otherProxy) && proxies[proxy].alive && proxies[otherProxy].alive) addPair(proxy, otherProxy);
+            }else if(endpoint.isMax() && !previous.isMax()) {
+                removePair(proxy, otherProxy);
+            }
+            endpoints[hole] = previous;
+        }
+        endpoints[hole] = endpoint;
+    }
+    //positions are only needed to update values between sorts, one pass is cheaper than tracking every swap
+    if(!sorted) updateEndpointPositions(axis);
+}
+
+/**
+ * Sorts both axes from scratch and finds every pair with one sweep over the x axis,
+ * cheaper than insertion sorting when many objects were inserted at once.
+ */
+void SweepAndPrune::rebuild() {
+    for(size_t axis = 0; axis < axes.size(); axis++) {
+        std::vector<Endpoint>& endpoints = axes[axis];
+        std::erase_if(endpoints, [this](const Endpoint& endpoint) {return !proxies[endpoint.getProxy()].alive;});
+        std::sort(endpoints.begin(), endpoints.end(),
+            [](const Endpoint& endpoint1, const Endpoint& endpoint2) {return endpoint1.isBefore(endpoint2);});
+        updateEndpointPositions(axis);
+    }
+
+    pairs.clear();
+    pairIndex.clear();
+    for(Proxy& proxy : proxies) proxy.pairCount = 0;
+    //the proxies whose x interval contains the current endpoint, every new start overlaps all of them on x
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> activePosition(proxies.size(), invalidIndex);
+    for(const Endpoint& endpoint : axes[axisX]) {
+        const uint32_t proxy = endpoint.getProxy();
+        if(endpoint.isMax()) {
+            const uint32_t position = activePosition[proxy];
+            active[position] = active.back();
+            activePosition[active[position]] = position;
+            active.pop_back();
+            continue;
+        }
+        for(const uint32_t otherProxy : active) {
+            if(overlaps(proxy, otherProxy)) addPair(proxy, otherProxy);
+        }
+        activePosition[proxy] = static_cast<uint32_t>(active.size());
+        active.push_back(proxy);
+    }
+}
+
+/**
+ * Drops the endpoints of removed proxies, sorted to the end of the lists, and any pair between two removed proxies
+ * since their endpoints never pass each other.
+ */
+void SweepAndPrune::freeRemovedProxies() {
+    if(removedProxies.empty()) return;
+    for(std::vector<Endpoint>& endpoints : axes) {
+        while(!endpoints.empty() && !proxies[endpoints.back().getProxy()].alive) endpoints.pop_back();
+    }
+    for(uint32_t i = 0; i < pairs.size();) {
+        const auto proxy1 = static_cast<uint32_t>(pairs[i] >> 32);
+        const auto proxy2 = static_cast<uint32_t>(pairs[i]);
+        if(proxies[proxy1].alive && proxies[proxy2].alive) i++;
+        else removePair(proxy1, proxy2);
+    }
+    freeProxies.insert(freeProxies.end(), removedProxies.begin(), removedProxies.end());
+    removedProxies.clear();
+}
+
+std::vector<SpatialIndex::Intersection> SweepAndPrune::getIntersections() {
+    //every inserted object's endpoints travel from the end of the lists, past about half of the others
+    if(insertedProxies > 2 * static_cast<size_t>(std::bit_width(proxyOf.size()))) {
+        rebuild();
+    }else {
+        sortAxis(axisX);
+        sortAxis(axisY);
+    }
+    insertedProxies = 0;
+    freeRemovedProxies();
+
+    std::vector<SpatialIndex::Intersection> intersections;
+    intersections.reserve(pairs.size());
+    for(const uint64_t key : pairs) {
+        const Proxy& proxy1 = proxies[key >> 32];
+        const Proxy& proxy2 = proxies[static_cast<uint32_t>(key)];
+        intersections.push_back({proxy1.id, proxy1.kind, proxy2.id, proxy2.kind});
+    }
+    return intersections;
+}
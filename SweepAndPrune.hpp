@@ -0,0 +1,92 @@
+#ifndef SWEEPANDPRUNE_HPP
+#define SWEEPANDPRUNE_HPP
+
+#include "SDL3/SDL.h"
+#include "SpatialIndex.hpp"
+#include "UtilityStructs.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A collision broadphase that keeps the start and end of every object's interval on each axis in a sorted list
+ * and the intersecting pairs in between calls. Objects only move a few pixels between ticks, so re-sorting the lists
+ * with an insertion sort costs little more than one pass, and a pair only has to be looked at when one of its
+ * endpoints passes the other's. Reports the same pairs as SpatialIndex::getIntersections.
+ */
+class SweepAndPrune {
+public:
+    /**
+     * @param bounds objects entirely outside of the bounds are ignored, like in the spatial index.
+     */
+    explicit SweepAndPrune(const SDL_FRect& bounds) : bounds(bounds) {}
+
+    void insert(const SpatialIndex::Object& object);
+    void remove(const SpatialIndex::Object& object);
+    void move(const SpatialIndex::Object& object);
+    /**
+     * Removes every object and moves the broadphase to new bounds.
+     */
+    void reset(const SDL_FRect& newBounds);
+
+    /**
+     * Sorts the endpoints of the objects that moved since the last call and returns every pair of intersecting objects once.
+     */
+    [[nodiscard]] std::vector<SpatialIndex::Intersection> getIntersections();
+    [[nodiscard]] size_t size() const {return proxyOf.size();}
+
+private:
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+    static constexpr size_t axisX = 0;
+    static constexpr size_t axisY = 1;
+
+    //the start or end of a proxy's interval on one axis, data holds the proxy index shifted left by one and the end flag
+    struct Endpoint {
+        float value;
+        uint32_t data;
+
+        [[nodiscard]] uint32_t getProxy() const {return data >> 1;}
+        [[nodiscard]] bool isMax() const {return data & 1;}
+        //starts come before ends at the same value, so touching intervals count as overlapping like in the spatial index
+        [[nodiscard]] bool isBefore(const Endpoint& other) const {
+            return value < other.value || (value == other.value && !isMax() && other.isMax());
+        }
+    };
+
+    struct Proxy {
+        uint64_t id;
+        EntityKind kind;
+        bool alive;
+        //the amount of pairs holding the proxy, most proxies have none and an end passing them needs no pair lookup
+        uint32_t pairCount;
+        //the positions of the proxy's min and max endpoint in each axis' list
+        std::array<std::array<uint32_t, 2>, 2> endpoints;
+    };
+
+    SDL_FRect bounds;
+    std::array<std::vector<Endpoint>, 2> axes;
+    std::vector<Proxy> proxies;
+    //the bounding box of every proxy, kept apart from the rest so the overlap tests during a sort stay in cache
+    std::vector<SDL_FRect> boxes;
+    std::vector<uint32_t> freeProxies;
+    std::unordered_map<uint64_t, uint32_t> proxyOf;
+    //both proxy indices of every intersecting pair packed into one key, and each key's position in pairs
+    std::vector<uint64_t> pairs;
+    std::unordered_map<uint64_t, uint32_t> pairIndex;
+    //proxies removed or inserted since the last sort, removed proxies are swept to the end of the lists and freed
+    std::vector<uint32_t> removedProxies;
+    size_t insertedProxies = 0;
+
+    [[nodiscard]] static uint64_t getPairKey(uint32_t proxy1, uint32_t proxy2);
+    [[nodiscard]] bool overlaps(uint32_t proxy1, uint32_t proxy2) const;
+    void setEndpointValues(uint32_t proxyIndex);
+    void addPair(uint32_t proxy1, uint32_t proxy2);
+    void removePair(uint32_t proxy1, uint32_t proxy2);
+    void updateEndpointPositions(size_t axis);
+    void sortAxis(size_t axis);
+    void rebuild();
+    void freeRemovedProxies();
+};
+
+#endif //SWEEPANDPRUNE_HPP
@@ -0,0 +1,143 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+//which worker of which pool the current thread is, so tasks it spawns go to its own queue
+static thread_local const ThreadPool* currentPoolPtr = nullptr;
+static thread_local size_t currentWorker = 0;
+
+void ThreadPool::TaskGroup::run(std::function<void()> task) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    poolPtr->push({std::move(task), this});
+}
+
+void ThreadPool::TaskGroup::wait() {
+    while(true) {
+        //read before pending, a task finishing in between changes it and the wait below returns right away
+        const uint64_t observedEvents = poolPtr->taskEvents.load(std::memory_order_acquire);
+        if(pending.load(std::memory_order_acquire) == 0) return;
+        if(poolPtr->tryRunTask(this)) continue;
+        poolPtr->taskEvents.wait(observedEvents, std::memory_order_acquire);
+    }
+}
+
+void ThreadPool::TaskGroup::finish() {
+    //the group may be destroyed as soon as pending reaches 0, so waiters are woken through the pool
+    ThreadPool* const pool = poolPtr;
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+    pool->signalTaskEvent();
+}
+
+ThreadPool::ThreadPool(const size_t workerCount) {
+    queues.reserve(workerCount + 1);
+    for(size_t i = 0; i < workerCount + 1; i++) queues.push_back(std::make_unique<Queue>());
+    workers.reserve(workerCount);
+    for(size_t i = 0; i < workerCount; i++) workers.emplace_back([this, i]() {workerLoop(i);});
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleepMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    //joins before the queues and the mutex the workers use are destroyed
+    workers.clear();
+}
+
+size_t ThreadPool::getDefaultWorkerCount() {
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return std::max(hardwareThreads, 2u) - 1;
+}
+
+void ThreadPool::parallelFor(const size_t count, const size_t chunkSize, const std::function<void(size_t begin, size_t end)>& func) {
+    if(count == 0) return;
+    const size_t size = std::max<size_t>(chunkSize, 1);
+    if(workers.empty() || count <= size) {
+        for(size_t begin = 0; begin < count; begin += size) func(begin, std::min(begin + size, count));
+        return;
+    }
+
+    TaskGroup group(this);
+    std::function<void(size_t, size_t)> split = [&](size_t begin, size_t end) {
+        //hands the upper half to the pool until one chunk is left, every boundary stays a multiple of size
+        while(end - begin > size) {
+            const size_t chunks = (end - begin + size - 1) / size;
+            const size_t middle = begin + chunks / 2 * size;
+            group.run([&split, middle, end]() {split(middle, end);});
+            end = middle;
+        }
+        func(begin, end);
+    };
+    split(0, count);
+    group.wait();
+}
+
+void ThreadPool::push(Task task) {
+    Queue& queue = *queues[getOwnQueue()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        //taken so a worker can't check queuedTasks and then miss the notify before it sleeps
+        std::lock_guard lock(sleepMutex);
+        queuedTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    taskAvailable.notify_one();
+    signalTaskEvent();
+}
+
+void ThreadPool::signalTaskEvent() {
+    taskEvents.fetch_add(1, std::memory_order_release);
+    taskEvents.notify_all();
+}
+
+bool ThreadPool::tryRunTask(const TaskGroup* groupPtr) {
+    const auto matches = [groupPtr](const Task& task) {return !groupPtr || task.groupPtr == groupPtr;};
+    Task task;
+    bool found = false;
+    const size_t ownQueue = getOwnQueue();
+    for(size_t i = 0; i < queues.size() && !found; i++) {
+        Queue& queue = *queues[(ownQueue + i) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if(i == 0) {
+            //newest first from the own queue, it's the smallest piece and still cached
+            const auto it = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), matches);
+            if(it == queue.tasks.rend()) continue;
+            task = std::move(*it);
+            queue.tasks.erase(std::next(it).base());
+        }else {
+            const auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(), matches);
+            if(it == queue.tasks.end()) continue;
+            task = std::move(*it);
+            queue.tasks.erase(it);
+        }
+        found = true;
+    }
+    if(!found) return false;
+
+    queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    task.func();
+    task.groupPtr->finish();
+    return true;
+}
+
+size_t ThreadPool::getOwnQueue() const {
+    return currentPoolPtr == this ? currentWorker : queues.size() - 1;
+}
+
+void ThreadPool::workerLoop(const size_t index) {
+    currentPoolPtr = this;
+    currentWorker = index;
+    while(true) {
+        if(tryRunTask(nullptr)) continue;
+        std::unique_lock lock(sleepMutex);
+        taskAvailable.wait(lock, [this]() {return stopping || queuedTasks.load(std::memory_order_relaxed) > 0;});
+        if(stopping) return;
+    }
+}
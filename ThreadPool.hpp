@@ -0,0 +1,107 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A work stealing job system shared by every parallel stage of the simulation.
+ * Every worker has its own queue: tasks spawned on a worker go to the back of its queue and it takes its newest task first,
+ * idle workers steal the oldest task of another queue, which is the biggest piece left of a split range.
+ * Threads outside the pool push into one more queue that only gets stolen from.
+ * Waiting on a task group runs the group's queued tasks instead of blocking, so groups can be waited on from inside a task.
+ */
+class ThreadPool {
+public:
+    /**
+     * Tasks that can be waited on together, spawned from any thread.
+     */
+    class TaskGroup {
+    public:
+        explicit TaskGroup(ThreadPool* poolPtr) : poolPtr(poolPtr) {}
+        ~TaskGroup() {wait();}
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+        void run(std::function<void()> task);
+        /**
+         * Returns once every task run in the group so far has finished, helping with the ones still queued.
+         * A waiting thread only runs tasks of this group, so it never gets stuck in a long task of another stage.
+         */
+        void wait();
+        [[nodiscard]] bool isDone() const {return pending.load(std::memory_order_acquire) == 0;}
+
+    private:
+        friend class ThreadPool;
+        ThreadPool* poolPtr;
+        std::atomic<size_t> pending = 0;
+
+        void finish();
+    };
+
+    /**
+     * @param workerCount threads started besides the ones calling into the pool, 0 runs every task on the thread waiting for it.
+     */
+    explicit ThreadPool(size_t workerCount = getDefaultWorkerCount());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Calls func(begin, end) for consecutive chunks of chunkSize indices from 0 to count, the last chunk may be shorter.
+     * Chunks run in no particular order and on any thread, func must only write what belongs to its own chunk.
+     * The range is split in halves on the way down so idle workers steal big pieces, the calling thread works on it too
+     * and returns once every chunk is done. Can be called from inside a task.
+     */
+    void parallelFor(size_t count, size_t chunkSize, const std::function<void(size_t begin, size_t end)>& func);
+
+    [[nodiscard]] size_t getWorkerCount() const {return workers.size();}
+    /**
+     * @return one thread less than the hardware runs at once, the calling thread makes up the difference,
+     * but at least one so tasks nobody waits on still make progress.
+     */
+    static size_t getDefaultWorkerCount();
+
+private:
+    struct Task {
+        std::function<void()> func;
+        TaskGroup* groupPtr;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    //one per worker, the last one for threads outside the pool
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::jthread> workers;
+    std::atomic<size_t> queuedTasks = 0;
+    //bumped whenever a task is queued or finishes, what waiting task groups sleep on
+    std::atomic<uint64_t> taskEvents = 0;
+    std::mutex sleepMutex;
+    std::condition_variable taskAvailable;
+    bool stopping = false;
+
+    void push(Task task);
+    void signalTaskEvent();
+    /**
+     * Takes one queued task of groupPtr, of any group if it's nullptr, and runs it.
+     * @return false if there was none.
+     */
+    bool tryRunTask(const TaskGroup* groupPtr);
+    /**
+     * @return the queue of the calling thread, the shared one for threads outside the pool.
+     */
+    [[nodiscard]] size_t getOwnQueue() const;
+    void workerLoop(size_t index);
+};
+
+#endif //THREADPOOL_HPP
@@ -31,6 +31,15 @@ struct SimData {
     std::string generationStr;
 };
 
+//the mouse and keys sampled on the thread handling window events, handed to the simulation every frame
+struct InputState {
+    float mouseX = 0.0f;
+    float mouseY = 0.0f;
+    bool leftMouseDown = false;
+    bool returnDown = false;
+    bool backspaceDown = false;
+};
+
 enum class UserActionType {
     NONE,
     CHANGE_FOOD_RANGE,
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "SDL3/SDL.h"
+#include "UniformGrid.hpp"
+#include "UtilityStructs.hpp"
+
+UniformGrid::UniformGrid(const SDL_FRect& bounds, const float cellSize) :
+    bounds(bounds),
+    cellSize(cellSize),
+    columns(std::max(1u, static_cast<uint32_t>(std::ceil(bounds.w / cellSize)))),
+    rows(std::max(1u, static_cast<uint32_t>(std::ceil(bounds.h / cellSize)))),
+    cells(static_cast<size_t>(columns) * rows, invalidIndex) {}
+
+UniformGrid::CellRange UniformGrid::getCellRange(const SDL_FRect& rect) const {
+    const auto toCell = [this](const float offset, const uint32_t count) -> uint32_t {
+        const float cell = std::floor(offset / cellSize);
+        if(cell <= 0.0f) return 0;
+        return std::min(static_cast<uint32_t>(cell), count - 1);
+    };
+    return {
+        toCell(rect.x - bounds.x, columns),
+        toCell(rect.y - bounds.y, rows),
+        toCell(rect.x + rect.w - bounds.x, columns),
+        toCell(rect.y + rect.h - bounds.y, rows)
+    };
+}
+
+bool UniformGrid::isFirstSharedCell(const CellRange& range1, const CellRange& range2, const uint32_t column, const uint32_t row) {
+    return column == std::max(range1.minColumn, range2.minColumn) && row == std::max(range1.minRow, range2.minRow);
+}
+
+bool UniformGrid::rangeContainsCell(const CellRange& range, const uint32_t column, const uint32_t row) {
+    return column >= range.minColumn && column <= range.maxColumn && row >= range.minRow && row <= range.maxRow;
+}
+
+void UniformGrid::insertIntoCell(const uint32_t column, const uint32_t row, const Object& object) {
+    uint32_t& cell = cells[row * columns + column];
+    for(uint32_t i = cell; i != invalidIndex; i = objectPool[i].next) {
+        if(objectPool[i].object.id == object.id) return;
+    }
+
+    //cells are unordered, so new entries are pushed to the front of the list
+    uint32_t entryIndex;
+    if(freeObject != invalidIndex) {
+        entryIndex = freeObject;
+        freeObject = objectPool[entryIndex].next;
+        objectPool[entryIndex] = {object, cell};
+    }else {
+        entryIndex = static_cast<uint32_t>(objectPool.size());
+        objectPool.push_back({object, cell});
+    }
+    cell = entryIndex;
+    entryCount++;
+}
+
+void UniformGrid::removeFromCell(const uint32_t column, const uint32_t row, const uint64_t id) {
+    uint32_t& cell = cells[row * columns + column];
+    uint32_t previous = invalidIndex;
+    for(uint32_t i = cell; i != invalidIndex; previous = i, i = objectPool[i].next) {
+        if(objectPool[i].object.id != id) continue;
+        if(previous == invalidIndex) cell = objectPool[i].next;
+        else objectPool[previous].next = objectPool[i].next;
+        objectPool[i].next = freeObject;
+        freeObject = i;
+        entryCount--;
+        return;
+    }
+}
+
+void UniformGrid::insert(const Object& object) {
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) return;
+
+    const CellRange range = getCellRange(object.boundingBox);
+    for(uint32_t row = range.minRow; row <= range.maxRow; row++) {
+        for(uint32_t column = range.minColumn; column <= range.maxColumn; column++) insertIntoCell(column, row, object);
+    }
+}
+
+void UniformGrid::remove(const Object& object) {
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) return;
+
+    const CellRange range = getCellRange(object.boundingBox);
+    for(uint32_t row = range.minRow; row <= range.maxRow; row++) {
+        for(uint32_t column = range.minColumn; column <= range.maxColumn; column++) removeFromCell(column, row, object.id);
+    }
+}
+
+/**
+ * Only the cells the object leaves or enters change, the entries in cells it stays in get the new bounding box in place.
+ */
+void UniformGrid::move(const Object& object, const SDL_FRect& oldBoundingBox) {
+    const bool wasInside = rangeIntersectsRect(bounds, oldBoundingBox);
+    const bool isInside = rangeIntersectsRect(bounds, object.boundingBox);
+    if(!wasInside || !isInside) {
+        if(wasInside) remove(Object(object.id, object.kind, oldBoundingBox));
+        if(isInside) insert(object);
+        return;
+    }
+
+    const CellRange oldRange = getCellRange(oldBoundingBox);
+    const CellRange newRange = getCellRange(object.boundingBox);
+    for(uint32_t row = oldRange.minRow; row <= oldRange.maxRow; row++) {
+        for(uint32_t column = oldRange.minColumn; column <= oldRange.maxColumn; column++) {
+            if(rangeContainsCell(newRange, column, row)) continue;
+            removeFromCell(column, row, object.id);
+        }
+    }
+    for(uint32_t row = newRange.minRow; row <= newRange.maxRow; row++) {
+        for(uint32_t column = newRange.minColumn; column <= newRange.maxColumn; column++) {
+            if(!rangeContainsCell(oldRange, column, row)) {
+                insertIntoCell(column, row, object);
+                continue;
+            }
+            bool found = false;
+            for(uint32_t i = cells[row * columns + column]; i != invalidIndex; i = objectPool[i].next) {
+                if(objectPool[i].object.id != object.id) continue;
+                objectPool[i].object = object;
+                found = true;
+                break;
+            }
+            if(!found) insertIntoCell(column, row, object);
+        }
+    }
+}
+
+template<typename Func>
+void UniformGrid::forEachObjectIn(const SDL_FRect& range, Func&& func) const {
+    if(!rangeIntersectsRect(bounds, range)) return;
+
+    const CellRange cellRange = getCellRange(range);
+    for(uint32_t row = cellRange.minRow; row <= cellRange.maxRow; row++) {
+        for(uint32_t column = cellRange.minColumn; column <= cellRange.maxColumn; column++) {
+            for(uint32_t i = cells[row * columns + column]; i != invalidIndex; i = objectPool[i].next) {
+                const Object& currObject = objectPool[i].object;
+                if(
+                    rangeIntersectsRect(currObject.boundingBox, range) &&
+                    isFirstSharedCell(getCellRange(currObject.boundingBox), cellRange, column, row)
+                ) {
+                    func(currObject);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Checks if the given object intersects any other objects present in the grid.
+ * @return a vector holding the id's of simulation objects the range is intersecting.
+ */
+void UniformGrid::findOverlapping(const Object& object, std::vector<uint64_t>* idsPtr) const {
+    idsPtr->clear();
+    forEachObjectIn(object.boundingBox, [&object, idsPtr](const Object& currObject) {
+        if(currObject.id != object.id) idsPtr->push_back(currObject.id);
+    });
+}
+
+uint8_t UniformGrid::findNearestNeighbors(const Object& object, const std::span<Neighbor> neighbors) const {
+    if(!rangeIntersectsRect(bounds, object.boundingBox)) return 0;
+
+    const SDL_FRect& box = object.boundingBox;
+    const SDL_FRect nearRange = {
+        box.x - isNearDistance,
+        box.y - isNearDistance,
+        box.w + isNearDistance * 2.0f,
+        box.h + isNearDistance * 2.0f
+    };
+    uint8_t count = 0;
+    const std::span<Neighbor> ranked = neighbors.first(maxNeighbors);
+    forEachObjectIn(nearRange, [&object, &ranked, &count](const Object& currObject) {
+        if(currObject.id == object.id || !rangeIsNearRect(object.boundingBox, currObject.boundingBox)) return;
+        const Vec2 distance = getMinDistanceBetweenRects(object.boundingBox, currObject.boundingBox);
+        if(distance == Vec2(0.0f, 0.0f)) return;
+        insertRanked(ranked, &count, Neighbor{currObject.id, currObject.kind, distance}, isCloserNeighbor);
+    });
+    return count;
+}
+
+/**
+ * Walks the ray one row or column of cells at a time, nearest first, and stops once the hits found so far can't be outranked.
+ * An object spanning several cells is reported from the first of them the walk reaches.
+ */
+void UniformGrid::rankRayHits(
+    const Object& object,
+    const Vec2& direction,
+    const SDL_FRect& ray,
+    const std::span<RayHit> hits,
+    uint8_t* countPtr
+) const {
+    if(direction.x == 0.0f && direction.y == 0.0f) {
+        forEachObjectIn(ray, [&object, &hits, countPtr](const Object& currObject) {
+            if(currObject.id != object.id) rankRayHit(object, currObject, hits, countPtr);
+        });
+        return;
+    }
+
+    const bool isHorizontal = direction.x != 0.0f;
+    const bool isReversed = std::signbit(isHorizontal ? direction.x : direction.y);
+    const CellRange rayRange = getCellRange(ray);
+    const uint32_t firstLine = isHorizontal ? rayRange.minColumn : rayRange.minRow;
+    const uint32_t lastLine = isHorizontal ? rayRange.maxColumn : rayRange.maxRow;
+    const uint32_t firstCell = isHorizontal ? rayRange.minRow : rayRange.minColumn;
+    const uint32_t lastCell = isHorizontal ? rayRange.maxRow : rayRange.maxColumn;
+    for(uint32_t step = 0; step <= lastLine - firstLine; step++) {
+        const uint32_t line = isReversed ? lastLine - step : firstLine + step;
+        const float lineStart = static_cast<float>(line) * cellSize;
+        const SDL_FRect lineBounds = isHorizontal ?
+            SDL_FRect{bounds.x + lineStart, ray.y, cellSize, ray.h} :
+            SDL_FRect{ray.x, bounds.y + lineStart, ray.w, cellSize};
+        if(areRayHitsFinal(hits, *countPtr, getRayGap(direction, object.boundingBox, lineBounds))) break;
+
+        for(uint32_t cell = firstCell; cell <= lastCell; cell++) {
+            const uint32_t column = isHorizontal ? line : cell;
+            const uint32_t row = isHorizontal ? cell : line;
+            for(uint32_t i = cells[row * columns + column]; i != invalidIndex; i = objectPool[i].next) {
+                const Object& currObject = objectPool[i].object;
+                if(currObject.id == object.id || !rangeIntersectsRect(currObject.boundingBox, ray)) continue;
+                const CellRange currRange = getCellRange(currObject.boundingBox);
+                const uint32_t currFirstLine = isHorizontal ?
+                    (isReversed ? std::min(rayRange.maxColumn, currRange.maxColumn) : std::max(rayRange.minColumn, currRange.minColumn)) :
+                    (isReversed ? std::min(rayRange.maxRow, currRange.maxRow) : std::max(rayRange.minRow, currRange.minRow));
+                const uint32_t currFirstCell = isHorizontal ?
+                    std::max(rayRange.minRow, currRange.minRow) :
+                    std::max(rayRange.minColumn, currRange.minColumn);
+                if(line == currFirstLine && cell == currFirstCell) rankRayHit(object, currObject, hits, countPtr);
+            }
+        }
+    }
+}
+
+std::vector<UniformGrid::Intersection> UniformGrid::getIntersections() const {
+    std::vector<Intersection> intersections;
+    for(uint32_t row = 0; row < rows; row++) {
+        for(uint32_t column = 0; column < columns; column++) {
+            for(uint32_t i = cells[row * columns + column]; i != invalidIndex; i = objectPool[i].next) {
+                const Object& currObject = objectPool[i].object;
+                const CellRange currRange = getCellRange(currObject.boundingBox);
+                for(uint32_t j = objectPool[i].next; j != invalidIndex; j = objectPool[j].next) {
+                    const Object& otherObject = objectPool[j].object;
+                    if(
+                        rangeIntersectsRect(otherObject.boundingBox, currObject.boundingBox) &&
+                        isFirstSharedCell(currRange, getCellRange(otherObject.boundingBox), column, row)
+                    ) {
+                        intersections.push_back({currObject.id, currObject.kind, otherObject.id, otherObject.kind});
+                    }
+                }
+            }
+        }
+    }
+    return intersections;
+}
+
+/**
+ * Outlines every occupied cell with the amount of entries it holds.
+ */
+void UniformGrid::show(SDL_Renderer* rendererPtr) const {
+    SDL_SetRenderDrawColor(rendererPtr, 255, 0, 0, 255);
+    SDL_RenderRect(rendererPtr, &bounds);
+    for(uint32_t row = 0; row < rows; row++) {
+        for(uint32_t column = 0; column < columns; column++) {
+            uint32_t count = 0;
+            for(uint32_t i = cells[row * columns + column]; i != invalidIndex; i = objectPool[i].next) count++;
+            if(count == 0) continue;
+
+            const SDL_FRect cellBounds = {
+                bounds.x + static_cast<float>(column) * cellSize,
+                bounds.y + static_cast<float>(row) * cellSize,
+                cellSize,
+                cellSize
+            };
+            SDL_RenderRect(rendererPtr, &cellBounds);
+            SDL_RenderDebugText(rendererPtr, cellBounds.x, cellBounds.y, std::to_string(count).c_str());
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef UNIFORMGRID_HPP
+#define UNIFORMGRID_HPP
+
+#include "SDL3/SDL.h"
+#include "SpatialIndex.hpp"
+#include "UtilityStructs.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * The spatial index backend that splits the bounds into equally sized cells, each holding a list of the objects overlapping it.
+ * Objects overlapping several cells are stored in each of them. Lookups only visit the cells a range covers, so their cost
+ * depends on the local density rather than the total object count, and moving an object never restructures anything.
+ */
+class UniformGrid : public SpatialIndex {
+public:
+    /**
+     * @param bounds an sdl float rectangle with the x,y members pointing to the top left point of the rectangle
+     * @param cellSize the width and height of every cell, best somewhat larger than the objects and the neighbor distance
+     */
+    UniformGrid(const SDL_FRect& bounds, float cellSize);
+
+    //cells and entries are plain values in two vectors, so copying a grid is two bulk copies
+
+    void insert(const Object& object) override;
+    void remove(const Object& object) override;
+    void move(const Object& object, const SDL_FRect& oldBoundingBox) override;
+    void reset(const SDL_FRect& bounds) override {*this = UniformGrid(bounds, cellSize);}
+    [[nodiscard]] std::unique_ptr<SpatialIndex> clone() const override {return std::make_unique<UniformGrid>(*this);}
+
+    void findOverlapping(const Object& object, std::vector<uint64_t>* idsPtr) const override;
+    uint8_t findNearestNeighbors(const Object& object, std::span<Neighbor> neighbors) const override;
+    [[nodiscard]] std::vector<Intersection> getIntersections() const override;
+    [[nodiscard]] SDL_FRect getBounds() const override {return bounds;}
+
+    void show(SDL_Renderer* rendererPtr) const override;
+    [[nodiscard]] size_t size() const override {return entryCount;}
+
+protected:
+    void rankRayHits(const Object& object, const Vec2& direction, const SDL_FRect& ray, std::span<RayHit> hits,
+        uint8_t* countPtr) const override;
+
+private:
+    static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+    struct CellRange {
+        uint32_t minColumn;
+        uint32_t minRow;
+        uint32_t maxColumn;
+        uint32_t maxRow;
+    };
+
+    struct ObjectEntry {
+        Object object;
+        uint32_t next;
+    };
+
+    SDL_FRect bounds;
+    float cellSize;
+    uint32_t columns;
+    uint32_t rows;
+    //the first entry of every cell's list, row major
+    std::vector<uint32_t> cells;
+    std::vector<ObjectEntry> objectPool;
+    //freed entries are chained through next
+    uint32_t freeObject = invalidIndex;
+    size_t entryCount = 0;
+
+    [[nodiscard]] CellRange getCellRange(const SDL_FRect& rect) const;
+    [[nodiscard]] static bool rangeContainsCell(const CellRange& range, uint32_t column, uint32_t row);
+    void insertIntoCell(uint32_t column, uint32_t row, const Object& object);
+    void removeFromCell(uint32_t column, uint32_t row, uint64_t id);
+    /**
+     * An object overlapping several cells of a range is seen once per cell, it is only reported from the first
+     * cell both share so lookups never need a set to remove duplicates.
+     * @return true if the cell at column, row is the top left cell shared by both ranges.
+     */
+    [[nodiscard]] static bool isFirstSharedCell(const CellRange& range1, const CellRange& range2, uint32_t column, uint32_t row);
+    /**
+     * Calls func with every object stored in a cell of range that intersects range, each object once.
+     */
+    template<typename Func>
+    void forEachObjectIn(const SDL_FRect& range, Func&& func) const;
+};
+
+#endif //UNIFORMGRID_HPP
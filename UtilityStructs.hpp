@@ -2,13 +2,29 @@
 #define UTILITYSTRUCTS_HPP
 
 #include <cmath>
+#include <cstdint>
 #include <functional>
 
+/**
+ * The type of a simulation object, carried by the object itself and by its quadtree entries
+ * so query results can be filtered by type without looking the object up.
+ */
+enum class EntityKind : uint8_t {
+    ORGANISM,
+    FOOD,
+    FOOD_SPAWN_RANGE,
+    FIRE,
+    PHEROMONE,
+    WATER,
+    SIZE
+};
+
 struct Vec2 {
     float x;
     float y;
     float gridSize = 10.0f;
 
+    constexpr Vec2() : x(0.0f), y(0.0f) {};
     constexpr Vec2(const float x, const float y) : x(x), y(y) {};
     constexpr Vec2(const float x, const float y, const float gridSize) : x(x), y(y), gridSize(gridSize) {};
 
@@ -58,10 +74,4 @@ struct Vec2PositionalHash {
     }
 };
 
-struct ThreadData {
-    std::function<void()> threadFunc;
-
-    explicit ThreadData(const std::function<void()>& newThreadFunc) : threadFunc(newThreadFunc) {}
-};
-
 #endif //UTILITYSTRUCTS_HPP
@@ -0,0 +1,66 @@
+#ifndef WORLDSNAPSHOT_HPP
+#define WORLDSNAPSHOT_HPP
+
+#include "SpatialIndex.hpp"
+#include "Profiler.hpp"
+#include "UtilityStructs.hpp"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * Everything the neighbor task reads for one fixed step, published by fixedUpdate and never modified afterwards.
+ * The task only touches snapshots, never the entity store, so the main thread doesn't wait on it to add or erase objects.
+ * The spatial indices are shared by consecutive snapshots until fixedUpdate refreshes them.
+ */
+struct WorldSnapshot {
+    uint64_t epoch = 0;
+    std::shared_ptr<const SpatialIndex> spatialIndexPtr;
+    //the objects that never move, only replaced when one is added or removed
+    std::shared_ptr<const SpatialIndex> staticSpatialIndexPtr;
+    //one entry per organism alive when the snapshot was taken
+    std::vector<uint64_t> organismIDs;
+    std::vector<SpatialIndex::Object> organismObjects;
+    std::vector<Vec2> organismVelocities;
+    std::shared_ptr<TickProfiler> profilerPtr;
+};
+
+/**
+ * The neighbors the neighbor task found for one snapshot, row i belongs to organismIDs[i].
+ * Every row is a fixed stride of maxNeighbors entries in one flat array, filled in place by SpatialIndex::findAllNeighbors,
+ * so organisms can point into the results instead of copying them. The simulation keeps the results alive for as long
+ * as organisms point into them, the task reuses them once nobody else holds them.
+ */
+struct NeighborResults {
+    static constexpr size_t rowSize = SpatialIndex::maxNeighbors;
+
+    uint64_t epoch = 0;
+    std::vector<uint64_t> organismIDs;
+    std::vector<SpatialIndex::Neighbor> neighbors;
+    std::vector<SpatialIndex::Neighbor> raycastNeighbors;
+    std::vector<uint8_t> neighborCounts;
+    std::vector<uint8_t> raycastCounts;
+
+    /**
+     * Sizes every buffer for rows organisms, only allocates when there are more rows than ever before.
+     */
+    void resize(const size_t rows) {
+        neighbors.resize(rows * rowSize);
+        raycastNeighbors.resize(rows * rowSize);
+        neighborCounts.resize(rows);
+        raycastCounts.resize(rows);
+    }
+    [[nodiscard]] SpatialIndex::NeighborRows getRows() {
+        return {neighbors, neighborCounts, raycastNeighbors, raycastCounts};
+    }
+
+    [[nodiscard]] std::span<const SpatialIndex::Neighbor> getNeighbors(const size_t row) const {
+        return {neighbors.data() + row * rowSize, neighborCounts[row]};
+    }
+    [[nodiscard]] std::span<const SpatialIndex::Neighbor> getRaycastNeighbors(const size_t row) const {
+        return {raycastNeighbors.data() + row * rowSize, raycastCounts[row]};
+    }
+};
+
+#endif //WORLDSNAPSHOT_HPP
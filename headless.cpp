@@ -0,0 +1,144 @@
+#include "SDL3/SDL.h"
+#include "Simulation.hpp"
+#include "SimRandom.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+struct HeadlessOptions {
+    uint64_t ticks = 36000; //ten simulated minutes at the default delta time
+    float fixedDeltaTime = 1.0f / 60.0f;
+    SDL_Rect simBounds{0, 0, 1080, 720};
+    uint32_t maxPopulation = 1000;
+    int genomeSize = 50;
+    float mutationFactor = 0.08f;
+    uint64_t reportEvery = 600;
+    uint64_t seed = SimRandom::randomSeed();
+    std::string profileCSVPath;
+    SpatialIndexType spatialIndexType = SpatialIndexType::QUADTREE;
+    size_t workerCount = ThreadPool::getDefaultWorkerCount();
+};
+
+static void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]" << std::endl <<
+        "  --ticks N            fixed steps to simulate (default 36000)" << std::endl <<
+        "  --dt SECONDS         simulated seconds per step (default 0.0166)" << std::endl <<
+        "  --width W            width of the simulation bounds (default 1080)" << std::endl <<
+        "  --height H           height of the simulation bounds (default 720)" << std::endl <<
+        "  --population N       maximum population (default 1000)" << std::endl <<
+        "  --genome-size N      connections in a randomly generated genome (default 50)" << std::endl <<
+        "  --mutation F         chance for an organism to mutate, between 0.0 and 1.0 (default 0.08)" << std::endl <<
+        "  --report-every N     steps between progress lines, 0 disables them (default 600)" << std::endl <<
+        "  --seed N             seed for every random decision, the same seed replays the same run (default random)" << std::endl <<
+        "  --profile-csv PATH   time each phase of every step, write one row per step to PATH and print a summary at the end" << std::endl <<
+        "  --spatial-index NAME quadtree, grid or linear, the backend answering collision, neighbor and raycast lookups (default quadtree)" << std::endl <<
+        "  --threads N          worker threads besides the main one, 0 runs everything on the main thread (default one less than the cpu's threads, at least 1)" << std::endl;
+}
+
+static bool parseOptions(const int argc, char* argv[], HeadlessOptions* optionsPtr) {
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+        if(i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if(strcmp(arg, "--ticks") == 0) optionsPtr->ticks = std::strtoull(value, nullptr, 10);
+        else if(strcmp(arg, "--dt") == 0) optionsPtr->fixedDeltaTime = std::strtof(value, nullptr);
+        else if(strcmp(arg, "--width") == 0) optionsPtr->simBounds.w = std::atoi(value);
+        else if(strcmp(arg, "--height") == 0) optionsPtr->simBounds.h = std::atoi(value);
+        else if(strcmp(arg, "--population") == 0) optionsPtr->maxPopulation = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if(strcmp(arg, "--genome-size") == 0) optionsPtr->genomeSize = std::atoi(value);
+        else if(strcmp(arg, "--mutation") == 0) optionsPtr->mutationFactor = std::strtof(value, nullptr);
+        else if(strcmp(arg, "--report-every") == 0) optionsPtr->reportEvery = std::strtoull(value, nullptr, 10);
+        else if(strcmp(arg, "--seed") == 0) optionsPtr->seed = std::strtoull(value, nullptr, 10);
+        else if(strcmp(arg, "--profile-csv") == 0) optionsPtr->profileCSVPath = value;
+        else if(strcmp(arg, "--spatial-index") == 0) {
+            optionsPtr->spatialIndexType = SpatialIndex::parseType(value);
+            if(optionsPtr->spatialIndexType == SpatialIndexType::SIZE) {
+                std::cerr << "Unknown spatial index " << value << std::endl;
+                return false;
+            }
+        }
+        else if(strcmp(arg, "--threads") == 0) optionsPtr->workerCount = std::strtoull(value, nullptr, 10);
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if(optionsPtr->fixedDeltaTime <= 0.0f || optionsPtr->simBounds.w <= 0 || optionsPtr->simBounds.h <= 0 ||
+       optionsPtr->maxPopulation == 0 || optionsPtr->genomeSize <= 0 || optionsPtr->genomeSize > 1000) {
+        std::cerr << "Invalid option value" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void printProgress(const Simulation& sim, const uint64_t tick, const float simSeconds, const double wallSeconds) {
+    std::cout << "tick " << tick <<
+        " sim_time " << std::fixed << std::setprecision(1) << simSeconds << "s" <<
+        " population " << sim.getCurrentPopulation() <<
+        " generation " << sim.getCurrentGeneration() <<
+        " ticks/s " << std::fixed << std::setprecision(1) << (wallSeconds > 0.0 ? static_cast<double>(tick) / wallSeconds : 0.0) <<
+        std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    HeadlessOptions options;
+    if(!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const auto simPtr = std::make_unique<Simulation>(
+        options.simBounds,
+        options.maxPopulation,
+        options.genomeSize,
+        options.mutationFactor,
+        options.seed,
+        options.spatialIndexType,
+        options.workerCount);
+    std::cout << "seed " << options.seed << " spatial index " << SpatialIndex::getTypeName(options.spatialIndexType) << std::endl;
+
+    const std::shared_ptr<TickProfiler>& profilerPtr = simPtr->getProfiler();
+    if(!options.profileCSVPath.empty()) {
+        if(!profilerPtr->openCSV(options.profileCSVPath)) return 1;
+        profilerPtr->setEnabled(true);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t tick = 0;
+    while(tick < options.ticks) {
+        simPtr->step(options.fixedDeltaTime);
+        profilerPtr->endFrame(simPtr->getCurrentPopulation());
+        tick++;
+
+        if(options.reportEvery != 0 && tick % options.reportEvery == 0) {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            printProgress(*simPtr, tick, static_cast<float>(tick) * options.fixedDeltaTime, elapsed.count());
+        }
+        if(simPtr->getCurrentPopulation() == 0) {
+            std::cout << "Population died out" << std::endl;
+            break;
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double simSeconds = static_cast<double>(tick) * options.fixedDeltaTime;
+    std::cout << "Simulated " << tick << " ticks (" << std::fixed << std::setprecision(1) << simSeconds << "s) in " <<
+        std::fixed << std::setprecision(2) << elapsed.count() << "s wall time, " <<
+        std::fixed << std::setprecision(1) << (elapsed.count() > 0.0 ? simSeconds / elapsed.count() : 0.0) <<
+        "x real time" << std::endl;
+    printProgress(*simPtr, tick, static_cast<float>(simSeconds), elapsed.count());
+    if(profilerPtr->isEnabled()) std::cout << profilerPtr->getSummary() << std::endl;
+
+    return 0;
+}
@@ -11,9 +11,16 @@
 #include <string>
 #include <sstream>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <array>
 #include <iomanip>
 #include "renderer/SDL3/clay_renderer_SDL3.c"
 #include "Simulation.hpp"
+#include "SimulationThread.hpp"
+#include "SnapshotRenderer.hpp"
+#include "FixedStepScheduler.hpp"
+#include "SimRandom.hpp"
 #include "UIStructs.hpp"
 
 static constexpr int WINDOW_WIDTH = 1280;
@@ -30,7 +37,7 @@ static constexpr Clay_Color COLOR_BLUE      = (Clay_Color) {50, 90, 162, 255};
 static constexpr Clay_Color COLOR_LIGHT     = (Clay_Color) {224, 215, 210, 255};
 
 struct ClayData {
-    std::shared_ptr<Simulation> simPtr;
+    SimulationThread* simThreadPtr;
     SimData simData;
     std::string fpsStr;
     int windowWidth;
@@ -44,16 +51,42 @@ struct ClayData {
     bool atmosphereMapIsShown = false;
     bool randomizingSpawn = true;
     bool shouldReset = false;
+    bool profilerIsShown = false;
+    std::string profilerStr;
+    std::string speedStr;
+    std::string renderIntervalStr;
 };
 
 struct AppState {
     SDL_Window* windowPtr;
     SDL_Renderer* rendererPtr;
     Clay_SDL3RendererData rendererData;
-    std::shared_ptr<Simulation> simPtr;
+    std::unique_ptr<SimulationThread> simThreadPtr;
+    std::unique_ptr<SnapshotRenderer> snapshotRendererPtr;
+    std::shared_ptr<TickProfiler> profilerPtr;
+    SpatialIndexType spatialIndexType = SpatialIndexType::QUADTREE;
+    size_t workerCount = ThreadPool::getDefaultWorkerCount();
+    SimulationSpeed speed = SimulationSpeed::X1;
+    uint32_t renderInterval = 1;
+    //from the last drawn snapshot, so the text doesn't have to wait for the simulation thread
+    uint32_t population = 0;
+    uint64_t generation = 0;
+    size_t quadSize = 0;
+    uint64_t ticksAtLastTextUpdate = 0;
     ClayData clayData;
 };
 
+//the render intervals the sidebar button cycles through
+static constexpr std::array<uint32_t, 4> RENDER_INTERVALS = {1, 10, 100, 1000};
+
+static void updateSchedulerStrs(ClayData* clayDataPtr) {
+    const SimulationThread* simThreadPtr = clayDataPtr->simThreadPtr;
+    clayDataPtr->speedStr = std::string("Speed: ") + FixedStepScheduler::getSpeedName(simThreadPtr->getSpeed());
+    const uint32_t renderInterval = simThreadPtr->getRenderInterval();
+    clayDataPtr->renderIntervalStr = renderInterval == 1 ?
+        std::string("Draw Every Tick") : "Draw Every " + std::to_string(renderInterval) + " Ticks";
+}
+
 static inline Clay_Dimensions SDL_MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config, void* userData) {
     auto** fonts = static_cast<TTF_Font**>(userData);
     TTF_Font* font = fonts[config->fontId];
@@ -73,7 +106,23 @@ static void handleButtonPress(Clay_ElementId elementID, Clay_PointerData pointer
 
     if(pointerData.state == CLAY_POINTER_DATA_PRESSED_THIS_FRAME || middleClicked) {
         const auto clayDataPtr = reinterpret_cast<ClayData*>(userData);
-        const auto& simPtr = clayDataPtr->simPtr;
+        SimulationThread* simThreadPtr = clayDataPtr->simThreadPtr;
+        //the scheduler settings are atomics read between ticks, they don't need the simulation
+        if(strcmp(elementID.stringId.chars, "Button_Speed") == 0) {
+            const auto nextSpeed = static_cast<uint8_t>(static_cast<uint8_t>(simThreadPtr->getSpeed()) + 1);
+            simThreadPtr->setSpeed(static_cast<SimulationSpeed>(nextSpeed % static_cast<uint8_t>(SimulationSpeed::SIZE)));
+            updateSchedulerStrs(clayDataPtr);
+            return;
+        }
+        if(strcmp(elementID.stringId.chars, "Button_Render_Interval") == 0) {
+            const auto intervalItr = std::find(RENDER_INTERVALS.begin(), RENDER_INTERVALS.end(), simThreadPtr->getRenderInterval());
+            const size_t next = intervalItr == RENDER_INTERVALS.end() ? 0 : (intervalItr - RENDER_INTERVALS.begin() + 1) % RENDER_INTERVALS.size();
+            simThreadPtr->setRenderInterval(RENDER_INTERVALS[next]);
+            updateSchedulerStrs(clayDataPtr);
+            return;
+        }
+        const auto simLock = simThreadPtr->lock();
+        const auto& simPtr = simThreadPtr->getSimulation();
         if(strcmp(elementID.stringId.chars, "Button_Change_Food_Range") == 0) {
             clayDataPtr->changingFoodSpawnRange = !clayDataPtr->changingFoodSpawnRange;
             if(clayDataPtr->changingFoodSpawnRange)
@@ -89,6 +138,8 @@ static void handleButtonPress(Clay_ElementId elementID, Clay_PointerData pointer
         }else if(strcmp(elementID.stringId.chars, "Button_Show_AtmosphereMap") == 0) {
             clayDataPtr->atmosphereMapIsShown = !clayDataPtr->atmosphereMapIsShown;
             simPtr->showAtmosphereMap(clayDataPtr->atmosphereMapIsShown);
+        }else if(strcmp(elementID.stringId.chars, "Button_Show_Profiler") == 0) {
+            clayDataPtr->profilerIsShown = !clayDataPtr->profilerIsShown;
         }else if(strcmp(elementID.stringId.chars, "Button_Reset_Simulation") == 0) {
             clayDataPtr->shouldReset = true;
         }else if(strcmp(elementID.stringId.chars, "Button_Pause") == 0) {
@@ -99,7 +150,7 @@ static void handleButtonPress(Clay_ElementId elementID, Clay_PointerData pointer
             else
                 simPtr->setUserAction(UserActionType::UNPAUSE, UIData{});
         }else if(strcmp(elementID.stringId.chars, "Button_Close_Organism_ToolTip") == 0) {
-            clayDataPtr->simPtr->setUserAction(UserActionType::UNFOCUS, {});
+            simPtr->setUserAction(UserActionType::UNFOCUS, {});
             clayDataPtr->changingFoodSpawnRange = false;
             clayDataPtr->simData = {};
         }else if(strcmp(elementID.stringId.chars, "Button_Randomize_Spawn") == 0) {
@@ -191,6 +242,23 @@ static Clay_RenderCommandArray Clay_CreateLayout(ClayData* dataPtr) {
                     })
                 );
             }
+            if(dataPtr->profilerIsShown)
+                CLAY({
+                    .id = CLAY_ID("Profiler_Container"),
+                    .layout = {
+                        .padding = {.left = 5, .right = 5, .top = 5, .bottom = 5},
+                        .childAlignment = {.x = CLAY_ALIGN_X_LEFT, .y = CLAY_ALIGN_Y_CENTER},
+                    },
+                    .backgroundColor = COLOR_LIGHT
+                }) {
+                    CLAY_TEXT(((Clay_String) {.length = static_cast<int32_t>(dataPtr->profilerStr.length()), .chars = dataPtr->profilerStr.c_str()}),
+                        CLAY_TEXT_CONFIG({
+                            .textColor = COLOR_BLACK,
+                            .fontId = FONT_SMALL,
+                            .fontSize = 0,
+                        })
+                    );
+                }
             CLAY({
                 .id = CLAY_ID("Population_Container"),
                 .layout = {
@@ -332,6 +400,26 @@ static Clay_RenderCommandArray Clay_CreateLayout(ClayData* dataPtr) {
                     .wrapMode = CLAY_TEXT_WRAP_NONE,
                 }));
             }
+            CLAY({
+                .id = CLAY_ID("Button_Show_Profiler"),
+                .layout = {
+                    .padding = {.left = 5, .right = 5, .top = 5, .bottom = 5},
+                    .childAlignment = {
+                        .x = CLAY_ALIGN_X_CENTER,
+                        .y = CLAY_ALIGN_Y_CENTER,
+                    }
+                },
+                .backgroundColor = Clay_Hovered() || dataPtr->profilerIsShown ?  COLOR_BLUE : COLOR_LIGHT,
+            }) {
+                Clay_OnHover(handleButtonPress, reinterpret_cast<intptr_t>(dataPtr));
+                CLAY_TEXT(CLAY_STRING("Show Profiler"),
+                    CLAY_TEXT_CONFIG({
+                        .textColor = COLOR_BLACK,
+                        .fontId = FONT_SMALL,
+                        .fontSize = 0,
+                        .wrapMode = CLAY_TEXT_WRAP_NONE,
+                }));
+            }
             CLAY({
                 .id = CLAY_ID("Button_Reset_Simulation"),
                 .layout = {
@@ -372,6 +460,46 @@ static Clay_RenderCommandArray Clay_CreateLayout(ClayData* dataPtr) {
                         .wrapMode = CLAY_TEXT_WRAP_NONE,
                 }));
             }
+            CLAY({
+                .id = CLAY_ID("Button_Speed"),
+                .layout = {
+                    .padding = {.left = 5, .right = 5, .top = 5, .bottom = 5},
+                    .childAlignment = {
+                        .x = CLAY_ALIGN_X_CENTER,
+                        .y = CLAY_ALIGN_Y_CENTER,
+                    }
+                },
+                .backgroundColor = Clay_Hovered() ?  COLOR_BLUE : COLOR_LIGHT,
+            }) {
+                Clay_OnHover(handleButtonPress, reinterpret_cast<intptr_t>(dataPtr));
+                CLAY_TEXT(((Clay_String) {.length = static_cast<int32_t>(dataPtr->speedStr.length()), .chars = dataPtr->speedStr.c_str()}),
+                    CLAY_TEXT_CONFIG({
+                        .textColor = COLOR_BLACK,
+                        .fontId = FONT_SMALL,
+                        .fontSize = 0,
+                        .wrapMode = CLAY_TEXT_WRAP_NONE,
+                }));
+            }
+            CLAY({
+                .id = CLAY_ID("Button_Render_Interval"),
+                .layout = {
+                    .padding = {.left = 5, .right = 5, .top = 5, .bottom = 5},
+                    .childAlignment = {
+                        .x = CLAY_ALIGN_X_CENTER,
+                        .y = CLAY_ALIGN_Y_CENTER,
+                    }
+                },
+                .backgroundColor = Clay_Hovered() ?  COLOR_BLUE : COLOR_LIGHT,
+            }) {
+                Clay_OnHover(handleButtonPress, reinterpret_cast<intptr_t>(dataPtr));
+                CLAY_TEXT(((Clay_String) {.length = static_cast<int32_t>(dataPtr->renderIntervalStr.length()), .chars = dataPtr->renderIntervalStr.c_str()}),
+                    CLAY_TEXT_CONFIG({
+                        .textColor = COLOR_BLACK,
+                        .fontId = FONT_SMALL,
+                        .fontSize = 0,
+                        .wrapMode = CLAY_TEXT_WRAP_NONE,
+                }));
+            }
     }
         if(!std::get<OrganismData>(dataPtr->simData.simObjectData).organismInfoStr.empty())
             CLAY({
@@ -493,6 +621,27 @@ void HandleClayErrors(Clay_ErrorData errorData) {
     }
 }
 
+static std::unique_ptr<SimulationThread> createSimulation(
+        const std::shared_ptr<TickProfiler>& profilerPtr,
+        const SpatialIndexType spatialIndexType,
+        const size_t workerCount,
+        const int width,
+        const int height) {
+    const uint64_t seed = SimRandom::randomSeed();
+    SDL_Log("Simulation seed: %llu", static_cast<unsigned long long>(seed));
+    const SDL_Rect simBounds{200, 0, width - 200, height - 0};
+    const auto simPtr = std::make_shared<Simulation>(
+            simBounds,
+            1000,
+            50,
+            0.08f,
+            seed,
+            spatialIndexType,
+            workerCount);
+    simPtr->setProfiler(profilerPtr);
+    return std::make_unique<SimulationThread>(simPtr, simBounds);
+}
+
 static float getDeltaTime() {
     static uint64_t NOW = SDL_GetPerformanceCounter();
     uint64_t LAST = NOW;
@@ -504,9 +653,6 @@ static float getDeltaTime() {
 
 
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char* argv[]) {
-    (void) argc;
-    (void) argv;
-
     if(!TTF_Init()) {
         return SDL_APP_FAILURE;
     }
@@ -517,6 +663,31 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char* argv[]) {
         return SDL_APP_FAILURE;
     }
 
+    statePtr->profilerPtr = std::make_shared<TickProfiler>();
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) {
+            if(!statePtr->profilerPtr->openCSV(argv[++i])) return SDL_APP_FAILURE;
+        }else if(strcmp(argv[i], "--spatial-index") == 0 && i + 1 < argc) {
+            statePtr->spatialIndexType = SpatialIndex::parseType(argv[++i]);
+            if(statePtr->spatialIndexType == SpatialIndexType::SIZE) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unknown spatial index %s", argv[i]);
+                return SDL_APP_FAILURE;
+            }
+        }else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            statePtr->workerCount = std::strtoull(argv[++i], nullptr, 10);
+        }else if(strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            statePtr->speed = FixedStepScheduler::parseSpeed(argv[++i]);
+            if(statePtr->speed == SimulationSpeed::SIZE) {
+                SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unknown speed %s", argv[i]);
+                return SDL_APP_FAILURE;
+            }
+        }else if(strcmp(argv[i], "--render-every") == 0 && i + 1 < argc) {
+            statePtr->renderInterval = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }else {
+            SDL_Log("Ignoring unknown argument %s", argv[i]);
+        }
+    }
+
     if(!SDL_CreateWindowAndRenderer("Evolution Simulation", WINDOW_WIDTH, WINDOW_HEIGHT, 0, &statePtr->windowPtr, &statePtr->rendererPtr)) {
         SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Failed to create window and renderer: %s", SDL_GetError());
         return SDL_APP_FAILURE;
@@ -577,14 +748,12 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char* argv[]) {
                 (Clay_ErrorHandler) {HandleClayErrors});
     Clay_SetMeasureTextFunction(SDL_MeasureText, statePtr->rendererData.fonts);
 
-    statePtr->simPtr = std::make_shared<Simulation>(
-            statePtr->rendererPtr,
-            SDL_Rect {200, 0, width - 200, height - 0},
-            1000,
-            50,
-            0.08f);
+    statePtr->snapshotRendererPtr = std::make_unique<SnapshotRenderer>(statePtr->rendererPtr);
+    statePtr->simThreadPtr = createSimulation(statePtr->profilerPtr, statePtr->spatialIndexType, statePtr->workerCount, width, height);
+    statePtr->simThreadPtr->setSpeed(statePtr->speed);
+    statePtr->simThreadPtr->setRenderInterval(statePtr->renderInterval);
     statePtr->clayData = ClayData{
-            statePtr->simPtr,
+            statePtr->simThreadPtr.get(),
             {
                 true,
                 {},
@@ -596,6 +765,7 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char* argv[]) {
             height,
             pauseImageSurface,
             playImageSurface};
+    updateSchedulerStrs(&statePtr->clayData);
     *appstate = statePtr;
 
     return SDL_APP_CONTINUE;
@@ -623,10 +793,12 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
         case SDL_EVENT_MOUSE_BUTTON_DOWN: {
             Clay_SetPointerState((Clay_Vector2) {event->button.x, event->button.y}, event->button.button == SDL_BUTTON_LEFT);
             if(event->button.button == SDL_BUTTON_RIGHT) {
-                if(statePtr->simPtr->getCurrentUserAction() == UserActionType::PAUSE) {
-                    statePtr->simPtr->setUserAction(UserActionType::UNPAUSE, UIData{});
+                const auto simLock = statePtr->simThreadPtr->lock();
+                const auto& simPtr = statePtr->simThreadPtr->getSimulation();
+                if(simPtr->getCurrentUserAction() == UserActionType::PAUSE) {
+                    simPtr->setUserAction(UserActionType::UNPAUSE, UIData{});
                 }else {
-                    statePtr->simPtr->setUserAction(UserActionType::NONE, UIData{});
+                    simPtr->setUserAction(UserActionType::NONE, UIData{});
                 }
             }
         }
@@ -644,32 +816,32 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
 SDL_AppResult SDL_AppIterate(void *appstate) {
     float deltaTime = getDeltaTime();
     auto *statePtr = static_cast<AppState*>(appstate);
-    static float timeAccumForFixedUpdate = 0.0f;
     static float timeAccumForTextUpdate = 0.0f;
     std::stringstream fpsStream;
     std::stringstream quadSizeStream;
     std::stringstream populationStream;
     std::stringstream generationStream;
 
-    if(timeAccumForFixedUpdate >= 0.016f) {
-        statePtr->simPtr->fixedUpdate();
-        timeAccumForFixedUpdate = 0.0f;
-    }else timeAccumForFixedUpdate += deltaTime;
+    //timing every phase costs a little, so only do it while someone is looking at the numbers
+    statePtr->profilerPtr->setEnabled(statePtr->clayData.profilerIsShown || statePtr->profilerPtr->isWritingCSV());
 
     int width, height;
     SDL_GetWindowSize(statePtr->windowPtr, &width, &height);
 
     if(statePtr->clayData.shouldReset) {
-        statePtr->simPtr = std::make_shared<Simulation>(
-            statePtr->rendererPtr,
-            SDL_Rect {200, 0, width - 200, height - 0},
-            1000,
-            50,
-            0.08f);
+        //the old thread is joined first so two simulations never step at once, the new one keeps its speed
+        const SimulationSpeed speed = statePtr->simThreadPtr->getSpeed();
+        const uint32_t renderInterval = statePtr->simThreadPtr->getRenderInterval();
+        statePtr->simThreadPtr.reset();
+        statePtr->simThreadPtr = createSimulation(statePtr->profilerPtr, statePtr->spatialIndexType, statePtr->workerCount, width, height);
+        statePtr->simThreadPtr->setSpeed(speed);
+        statePtr->simThreadPtr->setRenderInterval(renderInterval);
+        statePtr->ticksAtLastTextUpdate = 0;
         SDL_Surface* pauseImageSurface = statePtr->clayData.pauseImageDataPtr;
         SDL_Surface* playImageSurface = statePtr->clayData.playImageDataPtr;
+        const bool profilerIsShown = statePtr->clayData.profilerIsShown;
         statePtr->clayData = ClayData{
-                statePtr->simPtr,
+                statePtr->simThreadPtr.get(),
                 SimData {
                     true,
                     {},
@@ -681,18 +853,34 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
                 height,
                 pauseImageSurface,
                 playImageSurface};
+        statePtr->clayData.profilerIsShown = profilerIsShown;
+        updateSchedulerStrs(&statePtr->clayData);
         return SDL_APP_CONTINUE;
     }
 
-    statePtr->simPtr->update(SDL_Rect {200, 0, width - 200, height - 0}, deltaTime);
+    //the simulation thread steps on its own, it only picks up the window size and input sampled here
+    InputState inputState;
+    const SDL_MouseButtonFlags mouseState = SDL_GetMouseState(&inputState.mouseX, &inputState.mouseY);
+    inputState.leftMouseDown = mouseState & SDL_BUTTON_LMASK;
+    const bool* keyStates = SDL_GetKeyboardState(NULL);
+    inputState.returnDown = keyStates[SDL_SCANCODE_RETURN];
+    inputState.backspaceDown = keyStates[SDL_SCANCODE_BACKSPACE];
+    {
+        const auto simLock = statePtr->simThreadPtr->lock();
+        statePtr->simThreadPtr->getSimulation()->setInputState(inputState);
+        statePtr->simThreadPtr->setSimBounds(SDL_Rect {200, 0, width - 200, height - 0});
+    }
 
     if(timeAccumForTextUpdate >= 1.0f) {
         timeAccumForTextUpdate = 0.0f;
 
-        fpsStream << "FPS: " << std::fixed << std::setprecision(2) << (1.0f / deltaTime);
-        quadSizeStream << "QuadTree Size: " << statePtr->simPtr->getQuadSize();
-        populationStream << "Population: " << statePtr->simPtr->getCurrentPopulation();
-        generationStream << "Generation: " << statePtr->simPtr->getCurrentGeneration();
+        const uint64_t ticks = statePtr->simThreadPtr->getTicks();
+        fpsStream << "FPS: " << std::fixed << std::setprecision(2) << (1.0f / deltaTime) <<
+            " Ticks/s: " << (ticks - statePtr->ticksAtLastTextUpdate);
+        statePtr->ticksAtLastTextUpdate = ticks;
+        quadSizeStream << "QuadTree Size: " << statePtr->quadSize;
+        populationStream << "Population: " << statePtr->population;
+        generationStream << "Generation: " << statePtr->generation;
 
         statePtr->clayData.fpsStr =fpsStream.str();
         fpsStream.clear();
@@ -702,20 +890,37 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
         populationStream.clear();
         statePtr->clayData.simData.generationStr = generationStream.str();
         generationStream.clear();
-        statePtr->clayData.simData.simObjectData = statePtr->simPtr->getFocusedSimObjectData();
+        {
+            const auto simLock = statePtr->simThreadPtr->lock();
+            statePtr->clayData.simData.simObjectData = statePtr->simThreadPtr->getSimulation()->getFocusedSimObjectData();
+        }
+        if(statePtr->clayData.profilerIsShown) statePtr->clayData.profilerStr = statePtr->profilerPtr->getSummary();
     }else timeAccumForTextUpdate += deltaTime;
 
     statePtr->clayData.windowWidth = width;
     statePtr->clayData.windowHeight = height;
-    Clay_RenderCommandArray renderCommands = Clay_CreateLayout(&statePtr->clayData);
-
-    SDL_SetRenderDrawColor(statePtr->rendererPtr, 255, 255, 255, 255);
-    SDL_RenderClear(statePtr->rendererPtr);
+    Clay_RenderCommandArray renderCommands;
+    {
+        TickProfiler::ScopedTimer timer(statePtr->profilerPtr.get(), ProfilerPhase::LAYOUT);
+        renderCommands = Clay_CreateLayout(&statePtr->clayData);
+    }
 
-    statePtr->simPtr->render();
-    SDL_Clay_RenderClayCommands(&statePtr->rendererData, &renderCommands);
+    {
+        TickProfiler::ScopedTimer timer(statePtr->profilerPtr.get(), ProfilerPhase::RENDER);
+        SDL_SetRenderDrawColor(statePtr->rendererPtr, 255, 255, 255, 255);
+        SDL_RenderClear(statePtr->rendererPtr);
+
+        statePtr->simThreadPtr->getRenderBuffer().read([statePtr](const RenderSnapshot& snapshot) {
+            statePtr->snapshotRendererPtr->draw(snapshot);
+            statePtr->population = snapshot.population;
+            statePtr->generation = snapshot.generation;
+            statePtr->quadSize = snapshot.quadSize;
+        });
+        SDL_Clay_RenderClayCommands(&statePtr->rendererData, &renderCommands);
+    }
 
     SDL_RenderPresent(statePtr->rendererPtr);
+    statePtr->profilerPtr->endFrame(statePtr->population);
 
     return SDL_APP_CONTINUE;
 }
@@ -728,6 +933,9 @@ void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     auto *statePtr = static_cast<AppState*>(appstate);
 
     if(statePtr) {
+        //stopped before the renderer goes away, the snapshot renderer's textures with it
+        statePtr->simThreadPtr.reset();
+        statePtr->snapshotRendererPtr.reset();
         if(statePtr->rendererPtr)
             SDL_DestroyRenderer(statePtr->rendererPtr);
 